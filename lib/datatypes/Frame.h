@@ -94,6 +94,24 @@ public:
         // Nothing
     }
 
+    // Copies of a Frame that owns its sample information get their own
+    // copy of it. Copies of a Frame whose sample lives elsewhere (e.g. in
+    // shmem) continue to refer to it.
+    Frame(const Frame &f) :
+      cv::Mat(f)
+    , sample_(f.sample_)
+    , sample_ptr_(f.owns_sample() ? &sample_ : f.sample_ptr_)
+    {
+        // Nothing
+    }
+
+    Frame & operator=(const Frame &f) {
+        cv::Mat::operator=(f);
+        sample_ = f.sample_;
+        sample_ptr_ = f.owns_sample() ? &sample_ : f.sample_ptr_;
+        return *this;
+    }
+
     Frame clone() const {
         Frame f(cv::Mat::clone());
         *(f.sample_ptr_) = *sample_ptr_;
@@ -116,6 +134,9 @@ public:
     // Provide copy of sample_
     oat::Sample sample_copy() const { return *sample_ptr_; };
 
+    // True if sample information is held by this Frame rather than shmem
+    bool owns_sample() const { return sample_ptr_ == &sample_; }
+
 private:
 
     // Internal Sample
@@ -0,0 +1,169 @@
+//******************************************************************************
+//* File:   FrameIndex.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_FRAMEINDEX_H
+#define	OAT_FRAMEINDEX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace oat {
+namespace frameidx {
+
+/**
+ * Per-frame index of a recorded frame stream. An index file consists of a
+ * FileHeader followed by one fixed-size Entry per recorded frame, in
+ * recording order. Values are stored in host byte order.
+ */
+
+static constexpr char MAGIC[8] {'O', 'A', 'T', 'F', 'I', 'D', 'X', '\0'};
+static constexpr uint32_t VERSION {1};
+static constexpr size_t NAME_SIZE {100};
+
+/**
+ * Bits of Entry::flags.
+ */
+enum Flag : uint32_t {
+    KEYFRAME = 1 << 0,    //!< Frame can be decoded without preceding frames
+    FRAME_NUMBER = 1 << 1 //!< Entry::offset is a frame number, not a byte offset
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    double sample_rate_hz;
+    char source[NAME_SIZE];
+    char padding[4];
+};
+
+struct Entry {
+    uint64_t tick;           //!< Sample number
+    int64_t usec;            //!< Sample time, microseconds
+    int64_t monotonic_usec;  //!< Acquisition time on the monotonic clock
+    uint64_t offset;         //!< Byte offset or frame number in recording
+                             //!< (see FRAME_NUMBER)
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(FileHeader) % 8 == 0, "Misaligned FileHeader.");
+static_assert(sizeof(Entry) == 40, "Unexpected Entry size.");
+
+/**
+ * @brief Fill an index file header.
+ */
+inline FileHeader makeHeader(const std::string &source,
+                             const double sample_rate_hz) {
+
+    FileHeader hdr;
+    std::memset(&hdr, 0, sizeof(hdr));
+    std::memcpy(hdr.magic, MAGIC, sizeof(hdr.magic));
+    hdr.version = VERSION;
+    hdr.sample_rate_hz = sample_rate_hz;
+    std::strncpy(hdr.source, source.c_str(), sizeof(hdr.source) - 1);
+
+    return hdr;
+}
+
+/**
+ * Memory-mapped frame index reader.
+ */
+class Reader {
+
+public:
+
+    /**
+     * @brief Map a frame index.
+     * @param path Path to index file
+     */
+    explicit Reader(const std::string &path) :
+      file_(path.c_str(), boost::interprocess::read_only)
+    , region_(file_, boost::interprocess::read_only)
+    {
+        const char *data = static_cast<const char *>(region_.get_address());
+        const size_t bytes = region_.get_size();
+
+        if (bytes < sizeof(FileHeader))
+            throw std::runtime_error(path + " is not an Oat frame index.\n");
+
+        std::memcpy(&header_, data, sizeof(header_));
+        if (std::memcmp(header_.magic, MAGIC, sizeof(MAGIC)) != 0)
+            throw std::runtime_error(path + " is not an Oat frame index.\n");
+
+        if (header_.version != VERSION)
+            throw std::runtime_error(path + " has unsupported frame index "
+                                     "version " + std::to_string(header_.version)
+                                     + ".\n");
+
+        // A partially written trailing entry is ignored
+        entries_ = reinterpret_cast<const Entry *>(data + sizeof(FileHeader));
+        size_ = (bytes - sizeof(FileHeader)) / sizeof(Entry);
+    }
+
+    // Accessors
+    size_t size() const { return size_; }
+    double sample_rate_hz() const { return header_.sample_rate_hz; }
+    std::string source() const {
+        return std::string(header_.source, strnlen(header_.source, NAME_SIZE));
+    }
+
+    const Entry & operator[](const size_t i) const { return entries_[i]; }
+    const Entry * begin() const { return entries_; }
+    const Entry * end() const { return entries_ + size_; }
+
+    /**
+     * @brief Find the first entry at or after a sample number.
+     * @param tick Sample number
+     * @return Pointer to entry, or end() if there is none.
+     */
+    const Entry * findTick(const uint64_t tick) const {
+        return std::lower_bound(begin(), end(), tick,
+            [](const Entry &e, const uint64_t t) { return e.tick < t; });
+    }
+
+    /**
+     * @brief Find the first entry at or after a sample time.
+     * @param usec Sample time, microseconds
+     * @return Pointer to entry, or end() if there is none.
+     */
+    const Entry * findTime(const int64_t usec) const {
+        return std::lower_bound(begin(), end(), usec,
+            [](const Entry &e, const int64_t t) { return e.usec < t; });
+    }
+
+private:
+
+    boost::interprocess::file_mapping file_;
+    boost::interprocess::mapped_region region_;
+    FileHeader header_;
+    const Entry *entries_ {nullptr};
+    size_t size_ {0};
+};
+
+}      /* namespace frameidx */
+}      /* namespace oat */
+#endif /* OAT_FRAMEINDEX_H */
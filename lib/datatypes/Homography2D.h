@@ -0,0 +1,134 @@
+//******************************************************************************
+//* File:   Homography2D.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#ifndef OAT_HOMOGRAPHY2D_H
+#define	OAT_HOMOGRAPHY2D_H
+
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <opencv2/core/matx.hpp>
+
+#include "Position2D.h"
+
+namespace oat {
+
+/**
+ * Projective transformation of 2D positions. The matrix applied to
+ * velocities and headings, which excludes translation, is computed once on
+ * construction and all transforms are performed directly without temporary
+ * containers. Independent of shared memory so that it can be used to
+ * reprocess recorded positions offline. Components that publish transformed
+ * positions should register the homography (see
+ * oat::PositionRegistry::homographyID) and supply its ID.
+ */
+class Homography2D {
+public:
+
+    /**
+     * Projective transformation of 2D positions.
+     * @param homography 3x3 homography matrix
+     * @param homography_id Registered ID of homography, which is assigned to
+     * transformed positions.
+     */
+    explicit Homography2D(const cv::Matx33d &homography = cv::Matx33d::eye(),
+                          const oat::HomographyID homography_id = 0) :
+      homography_(homography)
+    , vector_homography_(homography)
+    , homography_id_(homography_id)
+    {
+        // Offsets do not apply to velocity or heading
+        vector_homography_(0, 2) = 0.0;
+        vector_homography_(1, 2) = 0.0;
+    }
+
+    /**
+     * Transform a single position, including its velocity and heading if
+     * they are valid. The position's coordinate system is updated.
+     * @param position Position to transform
+     */
+    void apply(oat::Position2D &position) const {
+
+        if (position.position_valid)
+            position.position = project(homography_, position.position);
+
+        if (position.velocity_valid)
+            position.velocity = project(vector_homography_, position.velocity);
+
+        if (position.heading_valid) {
+            const oat::UnitVector2D h = project(vector_homography_, position.heading);
+            const double norm = std::sqrt(h.x * h.x + h.y * h.y);
+            position.heading = norm > 0 ? h * (1.0 / norm) : h;
+        }
+
+        position.setCoordSystem(oat::DistanceUnit::WORLD, homography_id_);
+    }
+
+    /**
+     * Transform a batch of positions, e.g. for offline reprocessing of
+     * recorded data.
+     * @param positions Positions to transform
+     * @param n Number of positions
+     */
+    void apply(oat::Position2D *positions, const size_t n) const {
+        for (size_t i = 0; i < n; i++)
+            apply(positions[i]);
+    }
+
+    void apply(std::vector<oat::Position2D> &positions) const {
+        apply(positions.data(), positions.size());
+    }
+
+    /**
+     * Transform a batch of points.
+     * @param in Input points
+     * @param out Output points. May be the same as in.
+     * @param n Number of points
+     */
+    void applyPoints(const oat::Point2D *in, oat::Point2D *out, const size_t n) const {
+        for (size_t i = 0; i < n; i++)
+            out[i] = project(homography_, in[i]);
+    }
+
+    const cv::Matx33d &matrix(void) const { return homography_; }
+    oat::HomographyID homography_id(void) const { return homography_id_; }
+
+private:
+
+    cv::Matx33d homography_;
+    cv::Matx33d vector_homography_;
+
+    // Registered ID of homography_
+    oat::HomographyID homography_id_ {0};
+
+    /**
+     * Equivalent to cv::perspectiveTransform for a single point.
+     */
+    static cv::Point2d project(const cv::Matx33d &m, const cv::Point2d &p) {
+
+        const double w = m(2, 0) * p.x + m(2, 1) * p.y + m(2, 2);
+        const double s = std::fabs(w) > FLT_EPSILON ? 1.0 / w : 0.0;
+        return cv::Point2d((m(0, 0) * p.x + m(0, 1) * p.y + m(0, 2)) * s,
+                           (m(1, 0) * p.x + m(1, 1) * p.y + m(1, 2)) * s);
+    }
+};
+
+}      /* namespace oat */
+#endif	/* OAT_HOMOGRAPHY2D_H */
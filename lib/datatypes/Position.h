@@ -21,74 +21,19 @@
 #define	OAT_POSITION_H
 
 
-#include "Sample.h"
+#include <cstdint>
 
 namespace oat {
 
 /**
  * Unit of length used to specify position.
  */
-enum class DistanceUnit
+enum class DistanceUnit : uint8_t
 {
     PIXELS = 0,   //!< Position measured in pixels. Origin is upper left.
     WORLD = 1     //!< Position measured in units specified via homography
 };
 
-class Position {
-
-public:
-
-    explicit Position(const std::string &label) 
-    {
-        strncpy(label_, label.c_str(), sizeof(label_));
-        label_[sizeof(label_) - 1] = '\0';
-    }
-
-    virtual ~Position() { };
-
-    Position & operator = (const Position &p) {
-
-        // Check for self assignment
-        if (this == &p)
-            return *this;
-
-        // Copy all except label_
-        unit_of_length_ = p.unit_of_length_;
-        sample_ = p.sample_;
-        position_valid = p.position_valid;
-        velocity_valid = p.velocity_valid;
-        heading_valid = p.heading_valid;
-        region_valid = p.region_valid;
-        strncpy(region, p.region, sizeof(region));
-        region[sizeof(region) - 1] = '\0';
-
-        return *this;
-    }
-
-    // Expose sample information for potential modification
-    oat::Sample & sample() { return sample_; };
-
-    // Accessors
-    char * label() {return label_; }
-    DistanceUnit unit_of_length(void) const { return unit_of_length_; }
-    
-    // Categorical position
-    bool region_valid {false};
-    char region[100] {0}; //!< Categorical position label (e.g. "North West")
-
-    // Validity booleans
-    bool position_valid {false};
-    bool velocity_valid {false};
-    bool heading_valid {false};
-
-protected:
-    
-    char label_[100] {0}; //!< Position label (e.g. "anterior")
-    DistanceUnit unit_of_length_ {DistanceUnit::PIXELS};
-    
-    oat::Sample sample_;
-};
-
 }      /* namespace oat */
 #endif /* OAT_POSITION_H */
 
@@ -20,12 +20,15 @@
 #ifndef OAT_POSITION2D_H
 #define	OAT_POSITION2D_H
 
+#include <string>
 #include <opencv2/core/mat.hpp>
 #include <opencv2/imgproc.hpp>
 
 #include <rapidjson/prettywriter.h>
 
 #include "Position.h"
+#include "PositionRegistry.h"
+#include "Sample.h"
 
 namespace oat {
 
@@ -33,20 +36,33 @@ using Point2D = cv::Point2d;
 using Velocity2D = cv::Point2d;
 using UnitVector2D = cv::Point2d;
 
-class Position2D : public Position {
+/**
+ * 2D position sample. This is the record that is copied at each hop
+ * through shared memory, buffers, and writers, so it is kept compact and
+ * free of indirection: it has no virtual functions or inline strings and
+ * region names and homographies are referred to by ID (see
+ * oat::PositionRegistry). Copying is a plain member-wise copy.
+ */
+class Position2D {
 
 public:
-    explicit Position2D(const std::string &label) :
-      Position(label)
-    {
-        // Nothing
-    }
+
+    Position2D() = default;
 
     // 2D position primatives
     Point2D position;
     Velocity2D velocity;
     UnitVector2D heading;
 
+    // Validity booleans
+    bool position_valid {false};
+    bool velocity_valid {false};
+    bool heading_valid {false};
+
+    // Categorical position
+    bool region_valid {false};
+    RegionID region_id {0}; //!< Registered categorical position label (e.g. "North West")
+
     /**
      * @brief JSON Serializer
      *
@@ -114,23 +130,54 @@ public:
 
         if (region_valid || verbose) {
             writer.String("reg");
-            writer.String(region);
+            writer.String(region_valid ? region().c_str() : "");
         }
     }
 
     void setCoordSystem(const DistanceUnit value,
                         const cv::Matx33d homography) {
         unit_of_length_ = value;
-        homography_ = homography;
+        homography_id_ = oat::PositionRegistry::homographyID(homography);
     }
 
-    cv::Matx33d homography() const { return homography_; }
+    void setCoordSystem(const DistanceUnit value,
+                        const HomographyID homography_id) {
+        unit_of_length_ = value;
+        homography_id_ = homography_id;
+    }
 
-private:
+    /**
+     * @brief Set the region label, registering it if required.
+     * @param name Region name
+     */
+    void set_region(const std::string &name) {
+        region_id = oat::PositionRegistry::regionID(name);
+        region_valid = true;
+    }
+
+    // Accessors
+    std::string region() const {
+        return oat::PositionRegistry::regionName(region_id);
+    }
+    cv::Matx33d homography() const {
+        return oat::PositionRegistry::homography(homography_id_);
+    }
+    HomographyID homography_id() const { return homography_id_; }
+    DistanceUnit unit_of_length(void) const { return unit_of_length_; }
+
+    // Expose sample information for potential modification
+    oat::Sample & sample() { return sample_; };
+    const oat::Sample & sample() const { return sample_; };
 
-    cv::Matx33d homography_ {1.0, 0, 0, 0, 1.0, 0, 0, 0, 1.0};
+private:
 
+    HomographyID homography_id_ {0};
+    DistanceUnit unit_of_length_ {DistanceUnit::PIXELS};
+    oat::Sample sample_;
 };
 
+// Position2D is copied on every hop, so keep it within two cache lines
+static_assert(sizeof(Position2D) <= 128, "Position2D is larger than expected.");
+
 }      /* namespace oat */
 #endif /* OAT_POSITION2D_H */
@@ -1,5 +1,8 @@
 //******************************************************************************
-//* Copyright (c) Jon Newman (jpnewman at mit snail edu)
+//* File:   Position3D.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
 //* All right reserved.
 //* This file is part of the Oat project.
 //* This is free software: you can redistribute it and/or modify
@@ -18,73 +21,113 @@
 #define	OAT_POSITION3D_H
 
 #include <opencv2/core/mat.hpp>
-#include <opencv2/imgproc.hpp>
 
 #include "Position.h"
+#include "Sample.h"
 
 namespace oat {
 
-typedef cv::Point3d Point3D;
-typedef cv::Point3d Velocity3D;
-typedef cv::Point3d UnitVector3D;
+using Point3D = cv::Point3d;
+using Velocity3D = cv::Point3d;
+using UnitVector3D = cv::Point3d;
 
-class Position3D : public Position {
+/**
+ * 3D position sample, e.g. triangulated from several calibrated cameras.
+ * Like oat::Position2D, this is a compact record that is copied at each hop
+ * through shared memory. Coordinates are in the units of the projection
+ * matrices used to produce it.
+ */
+class Position3D {
 
 public:
-    // Unless manually changed, we are using pixels as our unit of measure
-    int coord_system = PIXELS;
 
-    // Used to get world coordinates from image
-    bool homography_valid = false;
-    cv::Matx44d homography;
+    Position3D() = default;
 
-    bool position_valid = false;
+    // 3D position primatives
     Point3D position;
-
-    bool velocity_valid = false;
     Velocity3D velocity;
+    UnitVector3D heading;
+
+    // Validity booleans
+    bool position_valid {false};
+    bool velocity_valid {false};
+    bool heading_valid {false};
+
+    /**
+     * @brief JSON Serializer
+     *
+     * @param writer Writer to use for serialization
+     * @param verbose If true, specifies that fields be serialized even though
+     * they contain indeterminate data.
+     */
+    template <typename Writer>
+    void Serialize(Writer &writer, bool verbose = false) const {
+
+        // Sample number
+        writer.String("tick");
+        writer.Int(sample_.count());
+
+        writer.String("usec");
+        writer.Int64(sample_.microseconds().count());
+
+        // Coordinate system
+        writer.String("unit");
+        writer.Int(static_cast<int>(unit_of_length_));
+
+        // Position
+        writer.String("pos_ok");
+        writer.Bool(position_valid || verbose);
+
+        if (position_valid || verbose) {
+            writer.String("pos_xyz");
+            writer.StartArray();
+            writer.Double(position.x);
+            writer.Double(position.y);
+            writer.Double(position.z);
+            writer.EndArray(3);
+        }
 
-    bool head_direction_valid = false;
-    UnitVector3D head_direction;
-
-    Position3D convertToWorldCoordinates() {
-
-        if (coord_system == PIXELS && homography_valid) {
-            Position2D world_position = *this;
-
-            // Position transforms
-            std::vector<Point3D> in_positions;
-            std::vector<Point3D> out_positions;
-            in_positions.push_back(position);
-            // TODO: 3D Transform??
-            //cv::perspectiveTransform(in_positions, out_positions, homography);
-            //world_position.position = out_positions[0];
+        // Velocity
+        writer.String("vel_ok");
+        writer.Bool(velocity_valid || verbose);
+
+        if (velocity_valid || verbose) {
+            writer.String("vel_xyz");
+            writer.StartArray();
+            writer.Double(velocity.x);
+            writer.Double(velocity.y);
+            writer.Double(velocity.z);
+            writer.EndArray(3);
+        }
 
-            // Velocity transform
-            std::vector<Velocity3D> in_velocities;
-            std::vector<Velocity3D> out_velocities;
-            cv::Matx44d vel_homo = homography;
-            vel_homo(0,2) = 0.0; // offsets to not apply to velocity
-            vel_homo(1,2) = 0.0; // offsets to not apply to velocity
-            in_velocities.push_back(velocity);
+        // Head direction
+        writer.String("head_ok");
+        writer.Bool(heading_valid);
+
+        if (heading_valid || verbose) {
+            writer.String("head_xyz");
+            writer.StartArray();
+            writer.Double(heading.x);
+            writer.Double(heading.y);
+            writer.Double(heading.z);
+            writer.EndArray(3);
+        }
+    }
 
-            // TODO: 3D Transform??
-            //cv::perspectiveTransform(in_velocities, out_velocities, vel_homo);
-            //world_position.velocity = out_velocities[0];
+    void set_unit_of_length(const DistanceUnit value) { unit_of_length_ = value; }
 
-            // Head direction is normalized and unit-free, and therefore
-            // does not require conversion
+    // Accessors
+    DistanceUnit unit_of_length(void) const { return unit_of_length_; }
 
-            // Return value uses world coordinates
-            world_position.coord_system = WORLD;
+    // Expose sample information for potential modification
+    oat::Sample & sample() { return sample_; };
+    const oat::Sample & sample() const { return sample_; };
 
-            return world_position;
+private:
 
-        } else {
-            return *this;
-        }
-    }
+    DistanceUnit unit_of_length_ {DistanceUnit::PIXELS};
+    oat::Sample sample_;
 };
 
-}      /* namespace datatypes */
+}      /* namespace oat */
 #endif /* OAT_POSITION3D_H */
@@ -0,0 +1,327 @@
+//******************************************************************************
+//* File:   PositionLog.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_POSITIONLOG_H
+#define	OAT_POSITIONLOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace oat {
+namespace poslog {
+
+/**
+ * Binary position log format. A log holds the positions recorded from a
+ * single SOURCE and consists of:
+ *
+ *  1. A FileHeader.
+ *  2. Zero or more chunks. Each chunk is a ChunkHeader followed by the
+ *     columns listed below, in order, each holding ChunkHeader::num_records
+ *     elements. All chunks except the last hold exactly
+ *     FileHeader::chunk_size records, so a record can be located without
+ *     scanning the file.
+ *  3. A region dictionary, starting at FileHeader::dictionary_offset: a
+ *     uint32_t entry count followed by (uint16_t id, char[NAME_SIZE] name)
+ *     pairs, which map the region IDs stored with each record to names.
+ *
+ * Columns: tick (uint64_t), usec (int64_t), monotonic_usec (int64_t),
+ * position (2 x double), velocity (2 x double), heading (2 x double),
+ * region (uint16_t), flags (uint8_t).
+ *
+ * Values are stored in host byte order. The header, full chunks and 8-byte
+ * columns are 8-byte aligned, so a memory-mapped log can be read in place.
+ */
+
+static constexpr char MAGIC[8] {'O', 'A', 'T', 'P', 'L', 'O', 'G', '\0'};
+static constexpr uint32_t VERSION {1};
+static constexpr uint32_t CHUNK_SIZE {4096};
+static constexpr size_t NAME_SIZE {100};
+
+/**
+ * Bits of the flags column.
+ */
+enum Flag : uint8_t {
+    POSITION_VALID = 1 << 0,
+    VELOCITY_VALID = 1 << 1,
+    HEADING_VALID  = 1 << 2,
+    REGION_VALID   = 1 << 3,
+    UNIT_WORLD     = 1 << 4  //!< Set if position is in world units
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t chunk_size;
+    double sample_rate_hz;
+    uint64_t dictionary_offset; //!< 0 if the log was not closed cleanly
+    uint64_t reserved;
+    char oat_version[64];
+    char date[32];
+    char source[NAME_SIZE];
+    char padding[4];
+};
+
+struct ChunkHeader {
+    uint32_t num_records;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(FileHeader) % 8 == 0, "Misaligned FileHeader.");
+static_assert(sizeof(ChunkHeader) == 8, "Misaligned ChunkHeader.");
+static_assert(CHUNK_SIZE % 8 == 0, "Chunks must be 8-byte aligned.");
+
+/**
+ * Size of a single record, summed over all columns.
+ */
+static constexpr size_t RECORD_BYTES {3 * sizeof(uint64_t)
+                                      + 6 * sizeof(double)
+                                      + sizeof(uint16_t)
+                                      + sizeof(uint8_t)};
+
+/**
+ * @brief Size of a chunk holding n records.
+ */
+inline size_t chunkBytes(const size_t n) {
+    return sizeof(ChunkHeader) + n * RECORD_BYTES;
+}
+
+/**
+ * A single decoded record.
+ */
+struct Record {
+    uint64_t tick;
+    int64_t usec;
+    int64_t monotonic_usec;
+    double position[2];
+    double velocity[2];
+    double heading[2];
+    uint16_t region;
+    uint8_t flags;
+
+    bool position_valid() const { return flags & POSITION_VALID; }
+    bool velocity_valid() const { return flags & VELOCITY_VALID; }
+    bool heading_valid() const { return flags & HEADING_VALID; }
+    bool region_valid() const { return flags & REGION_VALID; }
+    int unit() const { return (flags & UNIT_WORLD) ? 1 : 0; }
+};
+
+/**
+ * Column pointers into a single chunk of a mapped log.
+ */
+struct Chunk {
+    size_t size {0};
+    const uint64_t *tick {nullptr};
+    const int64_t *usec {nullptr};
+    const int64_t *monotonic_usec {nullptr};
+    const double *position {nullptr}; //!< Interleaved x, y
+    const double *velocity {nullptr}; //!< Interleaved x, y
+    const double *heading {nullptr};  //!< Interleaved x, y
+    const uint16_t *region {nullptr};
+    const uint8_t *flags {nullptr};
+};
+
+/**
+ * @brief Column pointers of a chunk starting at the given address.
+ */
+inline Chunk mapChunk(const char *data) {
+
+    ChunkHeader hdr;
+    std::memcpy(&hdr, data, sizeof(hdr));
+
+    Chunk c;
+    c.size = hdr.num_records;
+
+    const char *p = data + sizeof(ChunkHeader);
+    c.tick = reinterpret_cast<const uint64_t *>(p);
+    p += c.size * sizeof(uint64_t);
+    c.usec = reinterpret_cast<const int64_t *>(p);
+    p += c.size * sizeof(int64_t);
+    c.monotonic_usec = reinterpret_cast<const int64_t *>(p);
+    p += c.size * sizeof(int64_t);
+    c.position = reinterpret_cast<const double *>(p);
+    p += 2 * c.size * sizeof(double);
+    c.velocity = reinterpret_cast<const double *>(p);
+    p += 2 * c.size * sizeof(double);
+    c.heading = reinterpret_cast<const double *>(p);
+    p += 2 * c.size * sizeof(double);
+    c.region = reinterpret_cast<const uint16_t *>(p);
+    p += c.size * sizeof(uint16_t);
+    c.flags = reinterpret_cast<const uint8_t *>(p);
+
+    return c;
+}
+
+/**
+ * Memory-mapped, random access position log reader.
+ */
+class Reader {
+
+public:
+
+    /**
+     * @brief Map a position log.
+     * @param path Path to log file
+     */
+    explicit Reader(const std::string &path) :
+      file_(path.c_str(), boost::interprocess::read_only)
+    , region_(file_, boost::interprocess::read_only)
+    {
+        data_ = static_cast<const char *>(region_.get_address());
+        bytes_ = region_.get_size();
+
+        if (bytes_ < sizeof(FileHeader))
+            throw std::runtime_error(path + " is not an Oat position log.\n");
+
+        std::memcpy(&header_, data_, sizeof(header_));
+        if (std::memcmp(header_.magic, MAGIC, sizeof(MAGIC)) != 0)
+            throw std::runtime_error(path + " is not an Oat position log.\n");
+
+        if (header_.version != VERSION)
+            throw std::runtime_error(path + " has unsupported position log "
+                                     "version " + std::to_string(header_.version)
+                                     + ".\n");
+
+        // If the log was not closed cleanly, chunks extend to the end of
+        // the file and there is no region dictionary
+        size_t end = bytes_;
+        if (header_.dictionary_offset != 0 && header_.dictionary_offset <= bytes_) {
+            end = header_.dictionary_offset;
+            readDictionary(header_.dictionary_offset);
+        }
+
+        // Index chunks. Only the last chunk can be partially filled.
+        size_t off = sizeof(FileHeader);
+        while (off + sizeof(ChunkHeader) <= end) {
+
+            ChunkHeader hdr;
+            std::memcpy(&hdr, data_ + off, sizeof(hdr));
+            if (hdr.num_records == 0 || off + chunkBytes(hdr.num_records) > end)
+                break;
+
+            chunk_offsets_.push_back(off);
+            size_ += hdr.num_records;
+            off += chunkBytes(hdr.num_records);
+        }
+    }
+
+    // Accessors
+    size_t size() const { return size_; }
+    size_t num_chunks() const { return chunk_offsets_.size(); }
+    double sample_rate_hz() const { return header_.sample_rate_hz; }
+    std::string source() const { return terminated(header_.source); }
+    std::string date() const { return terminated(header_.date); }
+    std::string oat_version() const { return terminated(header_.oat_version); }
+
+    /**
+     * @brief Column pointers of the kth chunk.
+     */
+    Chunk chunk(const size_t k) const {
+        return mapChunk(data_ + chunk_offsets_.at(k));
+    }
+
+    /**
+     * @brief Decode the ith record.
+     */
+    Record record(const size_t i) const {
+
+        if (i >= size_)
+            throw std::out_of_range("Position log record index out of range.");
+
+        const Chunk c = chunk(i / header_.chunk_size);
+        const size_t j = i % header_.chunk_size;
+
+        Record r;
+        r.tick = c.tick[j];
+        r.usec = c.usec[j];
+        r.monotonic_usec = c.monotonic_usec[j];
+        for (int k = 0; k < 2; k++) {
+            r.position[k] = c.position[2 * j + k];
+            r.velocity[k] = c.velocity[2 * j + k];
+            r.heading[k] = c.heading[2 * j + k];
+        }
+        r.region = c.region[j];
+        r.flags = c.flags[j];
+
+        return r;
+    }
+
+    /**
+     * @brief Name of a region ID, or an empty string if it is unknown.
+     */
+    std::string regionName(const uint16_t id) const {
+        auto it = regions_.find(id);
+        return it == regions_.end() ? std::string() : it->second;
+    }
+
+private:
+
+    boost::interprocess::file_mapping file_;
+    boost::interprocess::mapped_region region_;
+    const char *data_ {nullptr};
+    size_t bytes_ {0};
+
+    FileHeader header_;
+    std::vector<size_t> chunk_offsets_;
+    size_t size_ {0};
+    std::unordered_map<uint16_t, std::string> regions_;
+
+    void readDictionary(size_t off) {
+
+        uint32_t n = 0;
+        if (off + sizeof(n) > bytes_)
+            return;
+
+        std::memcpy(&n, data_ + off, sizeof(n));
+        off += sizeof(n);
+
+        for (uint32_t i = 0; i < n; i++) {
+
+            if (off + sizeof(uint16_t) + NAME_SIZE > bytes_)
+                return;
+
+            uint16_t id;
+            std::memcpy(&id, data_ + off, sizeof(id));
+            off += sizeof(id);
+
+            regions_[id] = terminated(data_ + off, NAME_SIZE);
+            off += NAME_SIZE;
+        }
+    }
+
+    template <size_t N>
+    static std::string terminated(const char (&s)[N]) {
+        return terminated(s, N);
+    }
+
+    static std::string terminated(const char *s, const size_t n) {
+        return std::string(s, strnlen(s, n));
+    }
+};
+
+}      /* namespace poslog */
+}      /* namespace oat */
+#endif /* OAT_POSITIONLOG_H */
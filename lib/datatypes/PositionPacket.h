@@ -0,0 +1,331 @@
+//******************************************************************************
+//* File:   PositionPacket.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_POSITIONPACKET_H
+#define	OAT_POSITIONPACKET_H
+
+/*
+ * Binary UDP position protocol used by `oat posisock udp --binary`. This
+ * header is self-contained C99 that is also valid C++, so that it can be
+ * copied into the code of devices that receive positions, e.g. stimulus
+ * controllers.
+ *
+ * Each datagram holds a header followed by header.count entries, which are
+ * position records or, in region dictionary datagrams, region names. All
+ * fields are little-endian, regardless of the host byte order of either end.
+ *
+ * Header (OAT_PACKET_HEADER_SIZE bytes)
+ *   0  uint32  magic, OAT_PACKET_MAGIC ("OATP")
+ *   4  uint8   version, OAT_PACKET_VERSION
+ *   5  uint8   count, number of entries that follow
+ *   6  uint8   type, OAT_PACKET_POSITIONS or OAT_PACKET_REGIONS
+ *   7  uint8   reserved
+ *   8  uint32  sequence, incremented by one for each datagram
+ *  12  uint32  reserved
+ *  16  int64   send_usec, sender's monotonic clock at send time
+ *
+ * Record (OAT_PACKET_RECORD_SIZE bytes)
+ *   0  uint64  tick, sample number
+ *   8  int64   usec, sample time since the start of the stream
+ *  16  int64   monotonic_usec, sender's monotonic clock at acquisition
+ *  24  double  position x, y
+ *  40  double  velocity x, y
+ *  56  double  heading x, y
+ *  72  uint16  region ID
+ *  74  uint8   flags (OAT_PACKET_* bits)
+ *  75  uint8   reserved
+ *  76  uint32  reserved
+ *
+ * Region entry (3 + length bytes, packed one after the other)
+ *   0  uint16  region ID
+ *   2  uint8   length, of the name in bytes
+ *   3  char[]  name, not NUL-terminated
+ *
+ * Region IDs are assigned by the sending host and have no meaning elsewhere.
+ * Senders send a region dictionary datagram naming every region ID they
+ * have used before the first record that uses a new ID, and repeat it
+ * periodically, so receivers should keep the most recent name for each ID.
+ *
+ * Gaps in the sequence number, which counts datagrams of both types,
+ * indicate lost datagrams. The monotonic timestamps are only comparable to
+ * clock readings taken on the sending host.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define OAT_PACKET_MAGIC        0x5054414Fu  /* "OATP" */
+#define OAT_PACKET_VERSION      1
+#define OAT_PACKET_HEADER_SIZE  24
+#define OAT_PACKET_RECORD_SIZE  80
+#define OAT_PACKET_MAX_RECORDS  255
+
+/* Values of oat_packet_header.type */
+#define OAT_PACKET_POSITIONS  0  /* Position records */
+#define OAT_PACKET_REGIONS    1  /* Region dictionary entries */
+
+/* Bits of oat_packet_record.flags. Identical to those of oat::poslog::Flag. */
+#define OAT_PACKET_POSITION_VALID  (1u << 0)
+#define OAT_PACKET_VELOCITY_VALID  (1u << 1)
+#define OAT_PACKET_HEADING_VALID   (1u << 2)
+#define OAT_PACKET_REGION_VALID    (1u << 3)
+#define OAT_PACKET_UNIT_WORLD      (1u << 4)
+
+/* Errors returned by oat_packet_decode_header */
+#define OAT_PACKET_ETRUNC    -1  /* Datagram shorter than its header says */
+#define OAT_PACKET_EMAGIC    -2  /* Not an Oat position datagram */
+#define OAT_PACKET_EVERSION  -3  /* Unsupported protocol version */
+#define OAT_PACKET_ETYPE     -4  /* Unknown datagram type */
+
+typedef struct {
+    uint8_t type;
+    uint8_t count;
+    uint32_t sequence;
+    int64_t send_usec;
+} oat_packet_header;
+
+typedef struct {
+    uint64_t tick;
+    int64_t usec;
+    int64_t monotonic_usec;
+    double position[2];
+    double velocity[2];
+    double heading[2];
+    uint16_t region;
+    uint8_t flags;
+} oat_packet_record;
+
+typedef struct {
+    uint16_t id;
+    uint8_t length;
+    const char *name;  /* length bytes, not NUL-terminated */
+} oat_packet_region;
+
+/* Little-endian field access */
+
+static inline void oat_packet_put_u16(unsigned char *p, uint16_t v)
+{
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+}
+
+static inline void oat_packet_put_u32(unsigned char *p, uint32_t v)
+{
+    int i;
+    for (i = 0; i < 4; i++)
+        p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static inline void oat_packet_put_u64(unsigned char *p, uint64_t v)
+{
+    int i;
+    for (i = 0; i < 8; i++)
+        p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static inline void oat_packet_put_f64(unsigned char *p, double v)
+{
+    uint64_t u;
+    memcpy(&u, &v, sizeof(u));
+    oat_packet_put_u64(p, u);
+}
+
+static inline uint16_t oat_packet_get_u16(const unsigned char *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t oat_packet_get_u32(const unsigned char *p)
+{
+    uint32_t v = 0;
+    int i;
+    for (i = 3; i >= 0; i--)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+static inline uint64_t oat_packet_get_u64(const unsigned char *p)
+{
+    uint64_t v = 0;
+    int i;
+    for (i = 7; i >= 0; i--)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+static inline double oat_packet_get_f64(const unsigned char *p)
+{
+    uint64_t u = oat_packet_get_u64(p);
+    double v;
+    memcpy(&v, &u, sizeof(v));
+    return v;
+}
+
+/* Encoding */
+
+/**
+ * Write a datagram header to the start of buf, which must hold at least
+ * OAT_PACKET_HEADER_SIZE bytes.
+ */
+static inline void oat_packet_encode_header(void *buf,
+                                            const oat_packet_header *h)
+{
+    unsigned char *p = (unsigned char *)buf;
+
+    memset(p, 0, OAT_PACKET_HEADER_SIZE);
+    oat_packet_put_u32(p, OAT_PACKET_MAGIC);
+    p[4] = OAT_PACKET_VERSION;
+    p[5] = h->count;
+    p[6] = h->type;
+    oat_packet_put_u32(p + 8, h->sequence);
+    oat_packet_put_u64(p + 16, (uint64_t)h->send_usec);
+}
+
+/**
+ * Write the i'th record of the datagram in buf.
+ */
+static inline void oat_packet_encode_record(void *buf, size_t i,
+                                            const oat_packet_record *r)
+{
+    unsigned char *p = (unsigned char *)buf + OAT_PACKET_HEADER_SIZE
+                       + i * OAT_PACKET_RECORD_SIZE;
+
+    memset(p, 0, OAT_PACKET_RECORD_SIZE);
+    oat_packet_put_u64(p, r->tick);
+    oat_packet_put_u64(p + 8, (uint64_t)r->usec);
+    oat_packet_put_u64(p + 16, (uint64_t)r->monotonic_usec);
+    oat_packet_put_f64(p + 24, r->position[0]);
+    oat_packet_put_f64(p + 32, r->position[1]);
+    oat_packet_put_f64(p + 40, r->velocity[0]);
+    oat_packet_put_f64(p + 48, r->velocity[1]);
+    oat_packet_put_f64(p + 56, r->heading[0]);
+    oat_packet_put_f64(p + 64, r->heading[1]);
+    oat_packet_put_u16(p + 72, r->region);
+    p[74] = r->flags;
+}
+
+/**
+ * Write a region entry at offset bytes into the datagram in buf, which must
+ * hold at least offset + 3 + r->length bytes. The first entry is at offset
+ * OAT_PACKET_HEADER_SIZE. Returns the offset of the next entry.
+ */
+static inline size_t oat_packet_encode_region(void *buf, size_t offset,
+                                              const oat_packet_region *r)
+{
+    unsigned char *p = (unsigned char *)buf + offset;
+
+    oat_packet_put_u16(p, r->id);
+    p[2] = r->length;
+    memcpy(p + 3, r->name, r->length);
+
+    return offset + 3 + r->length;
+}
+
+/**
+ * Size of a datagram holding count position records.
+ */
+static inline size_t oat_packet_size(size_t count)
+{
+    return OAT_PACKET_HEADER_SIZE + count * OAT_PACKET_RECORD_SIZE;
+}
+
+/* Decoding */
+
+/**
+ * Decode and validate the header of a received datagram of len bytes.
+ * Returns 0 on success or a negative OAT_PACKET_E* code. On success, the
+ * h->count entries of an OAT_PACKET_POSITIONS datagram can be decoded using
+ * oat_packet_decode_record, and those of an OAT_PACKET_REGIONS datagram
+ * using oat_packet_decode_region.
+ */
+static inline int oat_packet_decode_header(const void *buf, size_t len,
+                                           oat_packet_header *h)
+{
+    const unsigned char *p = (const unsigned char *)buf;
+
+    if (len < OAT_PACKET_HEADER_SIZE)
+        return OAT_PACKET_ETRUNC;
+    if (oat_packet_get_u32(p) != OAT_PACKET_MAGIC)
+        return OAT_PACKET_EMAGIC;
+    if (p[4] != OAT_PACKET_VERSION)
+        return OAT_PACKET_EVERSION;
+
+    h->count = p[5];
+    h->type = p[6];
+    h->sequence = oat_packet_get_u32(p + 8);
+    h->send_usec = (int64_t)oat_packet_get_u64(p + 16);
+
+    if (h->type == OAT_PACKET_REGIONS)
+        return 0;
+    if (h->type != OAT_PACKET_POSITIONS)
+        return OAT_PACKET_ETYPE;
+    if (len < oat_packet_size(h->count))
+        return OAT_PACKET_ETRUNC;
+
+    return 0;
+}
+
+/**
+ * Decode the i'th record of a datagram whose header has been validated.
+ */
+static inline void oat_packet_decode_record(const void *buf, size_t i,
+                                            oat_packet_record *r)
+{
+    const unsigned char *p = (const unsigned char *)buf
+                             + OAT_PACKET_HEADER_SIZE
+                             + i * OAT_PACKET_RECORD_SIZE;
+
+    r->tick = oat_packet_get_u64(p);
+    r->usec = (int64_t)oat_packet_get_u64(p + 8);
+    r->monotonic_usec = (int64_t)oat_packet_get_u64(p + 16);
+    r->position[0] = oat_packet_get_f64(p + 24);
+    r->position[1] = oat_packet_get_f64(p + 32);
+    r->velocity[0] = oat_packet_get_f64(p + 40);
+    r->velocity[1] = oat_packet_get_f64(p + 48);
+    r->heading[0] = oat_packet_get_f64(p + 56);
+    r->heading[1] = oat_packet_get_f64(p + 64);
+    r->region = oat_packet_get_u16(p + 72);
+    r->flags = p[74];
+}
+
+/**
+ * Decode the region entry at *offset bytes into a region dictionary datagram
+ * of len bytes, and advance *offset to the next entry. The first entry is at
+ * offset OAT_PACKET_HEADER_SIZE. r->name points into buf. Returns 0 on
+ * success or OAT_PACKET_ETRUNC.
+ */
+static inline int oat_packet_decode_region(const void *buf, size_t len,
+                                           size_t *offset,
+                                           oat_packet_region *r)
+{
+    const unsigned char *p = (const unsigned char *)buf + *offset;
+
+    if (len < *offset + 3 || len < *offset + 3 + p[2])
+        return OAT_PACKET_ETRUNC;
+
+    r->id = oat_packet_get_u16(p);
+    r->length = p[2];
+    r->name = (const char *)(p + 3);
+    *offset += 3 + r->length;
+
+    return 0;
+}
+
+#endif /* OAT_POSITIONPACKET_H */
@@ -0,0 +1,258 @@
+//******************************************************************************
+//* File:   PositionRegistry.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_POSITIONREGISTRY_H
+#define	OAT_POSITIONREGISTRY_H
+
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <opencv2/core/matx.hpp>
+
+namespace oat {
+
+using RegionID = uint16_t;
+using HomographyID = uint16_t;
+
+/**
+ * Host-wide registry of position metadata that is too large to be carried by
+ * each position sample: region names and homographies. Positions refer to
+ * these by integer ID. Entries are interned by value in a shared memory
+ * segment, so IDs are consistent across processes, and are never removed, so
+ * each process can cache the entries it has seen. The segment persists
+ * between runs and can be reset using `oat clean oat_position_registry`.
+ * The table's mutex is not robust, so it is acquired with a timeout and
+ * reset if a process was killed while holding it.
+ */
+class PositionRegistry {
+
+public:
+
+    static constexpr size_t MAX_REGIONS {256};
+    static constexpr size_t REGION_NAME_SIZE {100};
+    static constexpr size_t MAX_HOMOGRAPHIES {64};
+
+    /**
+     * @brief Get the ID of a region name, registering it if required.
+     * @param name Region name. Truncated to REGION_NAME_SIZE - 1 characters.
+     * @return Region ID
+     */
+    static RegionID regionID(const std::string &name) {
+        return instance().internRegion(name);
+    }
+
+    /**
+     * @brief Get the name of a registered region.
+     * @param id Region ID
+     * @return Region name, or an empty string if the ID is not registered.
+     */
+    static std::string regionName(const RegionID id) {
+        return instance().lookupRegion(id);
+    }
+
+    /**
+     * @brief Get the ID of a homography, registering it if required. The
+     * identity homography always has ID 0.
+     * @param homography Homography
+     * @return Homography ID
+     */
+    static HomographyID homographyID(const cv::Matx33d &homography) {
+        if (homography == cv::Matx33d::eye())
+            return 0;
+        return instance().internHomography(homography);
+    }
+
+    /**
+     * @brief Get a registered homography.
+     * @param id Homography ID
+     * @return Homography, or identity if the ID is not registered.
+     */
+    static cv::Matx33d homography(const HomographyID id) {
+        if (id == 0)
+            return cv::Matx33d::eye();
+        return instance().lookupHomography(id);
+    }
+
+private:
+
+    using shared_mutex = boost::interprocess::interprocess_mutex;
+    using shared_lock = boost::interprocess::scoped_lock<shared_mutex>;
+
+    struct Table {
+
+        Table()
+        {
+            cv::Matx33d eye = cv::Matx33d::eye();
+            std::memcpy(homographies[0], eye.val, sizeof(homographies[0]));
+        }
+
+        shared_mutex mutex;
+        size_t num_regions {0};
+        char regions[MAX_REGIONS][REGION_NAME_SIZE] {};
+        size_t num_homographies {1}; // ID 0 is the identity
+        double homographies[MAX_HOMOGRAPHIES][9] {};
+    };
+
+    PositionRegistry() :
+      shmem_(boost::interprocess::open_or_create,
+             "oat_position_registry_obj",
+             sizeof(Table) + 4096)
+    {
+        table_ = shmem_.find_or_construct<Table>("table")();
+    }
+
+    static PositionRegistry &instance() {
+        static PositionRegistry registry;
+        return registry;
+    }
+
+    /**
+     * @brief Lock the shared table. Critical sections are short, so failing
+     * to get the lock within a second almost always means that its holder
+     * was killed. The mutex is not robust and cannot be safely taken over
+     * from another process, so this is reported rather than recovered from.
+     */
+    void lockTable() {
+
+        namespace pt = boost::posix_time;
+        const auto deadline =
+            pt::microsec_clock::universal_time() + pt::milliseconds(1000);
+
+        if (!table_->mutex.timed_lock(deadline))
+            throw std::runtime_error("Position registry is locked. If a "
+                                     "component was killed while using it, "
+                                     "stop all components and run `oat clean "
+                                     "oat_position_registry` to reset it.");
+    }
+
+    // Must be called with both mutexes held
+    void refresh() {
+
+        for (size_t i = regions_.size(); i < table_->num_regions; i++)
+            regions_.emplace_back(table_->regions[i]);
+
+        for (size_t i = homographies_.size(); i < table_->num_homographies; i++)
+            homographies_.emplace_back(table_->homographies[i]);
+    }
+
+    RegionID internRegion(const std::string &name) {
+
+        const std::string n = name.substr(0, REGION_NAME_SIZE - 1);
+        std::lock_guard<std::mutex> lk(mutex_);
+
+        for (size_t i = 0; i < regions_.size(); i++)
+            if (regions_[i] == n)
+                return i;
+
+        lockTable();
+        shared_lock slk(table_->mutex, boost::interprocess::accept_ownership);
+        refresh();
+
+        for (size_t i = 0; i < regions_.size(); i++)
+            if (regions_[i] == n)
+                return i;
+
+        if (table_->num_regions == MAX_REGIONS)
+            throw std::runtime_error(
+                "Position region registry is full ("
+                + std::to_string(MAX_REGIONS) + " names). Stop all components "
+                "and run `oat clean oat_position_registry` to reset it.");
+
+        std::strncpy(table_->regions[table_->num_regions], n.c_str(), REGION_NAME_SIZE);
+        table_->num_regions++;
+        refresh();
+
+        return regions_.size() - 1;
+    }
+
+    std::string lookupRegion(const RegionID id) {
+
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (id >= regions_.size()) {
+            lockTable();
+            shared_lock slk(table_->mutex, boost::interprocess::accept_ownership);
+            refresh();
+        }
+
+        return id < regions_.size() ? regions_[id] : std::string();
+    }
+
+    HomographyID internHomography(const cv::Matx33d &homography) {
+
+        std::lock_guard<std::mutex> lk(mutex_);
+
+        for (size_t i = 0; i < homographies_.size(); i++)
+            if (homographies_[i] == homography)
+                return i;
+
+        lockTable();
+        shared_lock slk(table_->mutex, boost::interprocess::accept_ownership);
+        refresh();
+
+        for (size_t i = 0; i < homographies_.size(); i++)
+            if (homographies_[i] == homography)
+                return i;
+
+        if (table_->num_homographies == MAX_HOMOGRAPHIES)
+            throw std::runtime_error(
+                "Position homography registry is full ("
+                + std::to_string(MAX_HOMOGRAPHIES) + " homographies). Stop "
+                "all components and run `oat clean oat_position_registry` to "
+                "reset it.");
+
+        std::memcpy(table_->homographies[table_->num_homographies],
+                    homography.val,
+                    sizeof(table_->homographies[0]));
+        table_->num_homographies++;
+        refresh();
+
+        return homographies_.size() - 1;
+    }
+
+    cv::Matx33d lookupHomography(const HomographyID id) {
+
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (id >= homographies_.size()) {
+            lockTable();
+            shared_lock slk(table_->mutex, boost::interprocess::accept_ownership);
+            refresh();
+        }
+
+        return id < homographies_.size() ? homographies_[id] : cv::Matx33d::eye();
+    }
+
+    // Shared table
+    boost::interprocess::managed_shared_memory shmem_;
+    Table *table_ {nullptr};
+
+    // Process-local copy of the entries seen so far
+    std::mutex mutex_;
+    std::vector<std::string> regions_;
+    std::vector<cv::Matx33d> homographies_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_POSITIONREGISTRY_H */
@@ -54,7 +54,6 @@ public:
       period_sec_(period_sec)
     {
         assert(period_sec_.count() > 0.0);
-        rate_hz_ = 1.0 / period_sec;
     }
 
     /**
@@ -66,7 +65,6 @@ public:
       period_sec_(period_sec)
     {
         assert(period_sec_.count() > 0.0);
-        rate_hz_ = 1.0 / period_sec.count();
     }
 
     /**
@@ -76,7 +74,7 @@ public:
      * @return Current sample count
      */
     uint64_t incrementCount() {
-        microseconds_ += period_microseconds_;
+        microseconds_ += period_microseconds();
         return ++count_;
     }
 
@@ -93,6 +91,15 @@ public:
         return ++count_;
     }
 
+    /**
+     * @brief Record the current monotonic clock reading as the time this
+     * sample was acquired. Only pure SINKs should stamp samples, as close to
+     * acquisition as possible.
+     */
+    void stampMonotonic() {
+        monotonic_microseconds_ = monotonicNow();
+    }
+
     /** 
      * @brief Set the sample rate.
      * 
@@ -101,25 +108,47 @@ public:
     void set_rate_hz(const double value) {
 
         assert(value > 0.0);
-        rate_hz_ = value;
         period_sec_ = Seconds(1.0 / value);
-        period_microseconds_ = 
-            std::chrono::duration_cast<Microseconds>(period_sec_);
     }
 
     uint64_t count() const { return count_; }
     Microseconds microseconds() const { return microseconds_; }
     Seconds period_sec() const { return period_sec_; }
-    Microseconds period_microseconds() const { return period_microseconds_; }
-    double rate_hz() const { return rate_hz_; }
+    Microseconds period_microseconds() const {
+        return std::chrono::duration_cast<Microseconds>(period_sec_);
+    }
+    double rate_hz() const {
+        return period_sec_.count() > 0.0 ? 1.0 / period_sec_.count() : 0.0;
+    }
+
+    /**
+     * @brief Time at which this sample was acquired by its pure SINK, on the
+     * system-wide monotonic clock. Unlike microseconds(), which is relative
+     * to the start of the stream, this can be compared against
+     * monotonicNow() in any process on the same host to measure latency.
+     *
+     * @return Monotonic stamp in microseconds, or 0 if never stamped.
+     */
+    Microseconds monotonic_microseconds() const {
+        return monotonic_microseconds_;
+    }
+
+    /**
+     * @brief Current reading of the monotonic clock used to stamp samples.
+     *
+     * @return Microseconds since the (arbitrary) monotonic clock epoch.
+     */
+    static Microseconds monotonicNow() {
+        return std::chrono::duration_cast<Microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch());
+    }
 
 private:
 
     uint64_t count_ {0};
     Microseconds microseconds_ {0};
+    Microseconds monotonic_microseconds_ {0};
     Seconds period_sec_ {0.0};
-    Microseconds period_microseconds_ {0};
-    double rate_hz_ {0.0};
 };
 
 }      /* namespace oat */
@@ -72,6 +72,8 @@ public:
 
     // Sychronization
     NodeState wait();
+    bool tryWait(NodeState &state);
+    bool tryWait(NodeState &state, const msec_t timeout);
     void post();
 
     uint64_t write_number() const {
@@ -221,6 +223,63 @@ inline NodeState SourceBase<T>::wait() {
     return node_->sink_state();
 }
 
+/**
+ * @brief Non-blocking version of wait(). Allows a component to service
+ * several SOURCEs in the order in which they become ready.
+ * @param state Node state, set if the wait succeeded
+ * @return True if the wait succeeded, in which case post() is required.
+ */
+template<typename T>
+inline bool SourceBase<T>::tryWait(NodeState &state) {
+
+#ifndef NDEBUG
+    // Don't use Asserts because it does not clean shmem
+    if(state_ < SourceState::TOUCHED)
+        throw std::runtime_error("Source must have touched node before calling tryWait()");
+    if (did_wait_need_post_)
+        throw std::runtime_error("tryWait() called when post() was required.");
+#endif
+
+    // If the sink has left the room, we should too
+    if (!node_->read_barrier(slot_index_).try_wait()
+        && node_->sink_state() != NodeState::END)
+        return false;
+
+    did_wait_need_post_ = true;
+    state = node_->sink_state();
+
+    return true;
+}
+
+/**
+ * @brief Timed version of wait(). Allows a component to block on a SOURCE
+ * while periodically checking whether it should stop or service others.
+ * @param state Node state, set if the wait succeeded
+ * @param timeout Maximum time to wait
+ * @return True if the wait succeeded, in which case post() is required.
+ */
+template<typename T>
+inline bool SourceBase<T>::tryWait(NodeState &state, const msec_t timeout) {
+
+#ifndef NDEBUG
+    // Don't use Asserts because it does not clean shmem
+    if(state_ < SourceState::TOUCHED)
+        throw std::runtime_error("Source must have touched node before calling tryWait()");
+    if (did_wait_need_post_)
+        throw std::runtime_error("tryWait() called when post() was required.");
+#endif
+
+    // If the sink has left the room, we should too
+    if (!node_->read_barrier(slot_index_).timed_wait(boost::get_system_time() + timeout)
+        && node_->sink_state() != NodeState::END)
+        return false;
+
+    did_wait_need_post_ = true;
+    state = node_->sink_state();
+
+    return true;
+}
+
 template<typename T>
 inline void SourceBase<T>::post() {
 
@@ -41,7 +41,7 @@ void TokenBuffer<T>::connectToNode() {
     // Wait for sychronous start with sink when it binds the node
     source_.connect();
 
-    sink_.bind(sink_address_, sink_address_);
+    sink_.bind(sink_address_);
     shared_token_ = sink_.retrieve();
 
     // Start consumer thread
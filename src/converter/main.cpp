@@ -0,0 +1,307 @@
+//******************************************************************************
+//* File:   main.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/exceptions.hpp>
+#include <boost/program_options.hpp>
+#include <rapidjson/filewritestream.h>
+#include <rapidjson/prettywriter.h>
+
+#include "../../lib/datatypes/PositionLog.h"
+#include "../../lib/utility/IOFormat.h"
+
+namespace bfs = boost::filesystem;
+namespace po = boost::program_options;
+
+void printUsage(po::options_description options) {
+    std::cout << "Usage: convert [INFO]\n"
+              << "   or: convert TYPE FILE [OUTPUT] [CONFIGURATION]\n"
+              << "Convert a binary position log, recorded using oat-record's\n"
+              << "--binary-file option, to another format.\n\n"
+              << "TYPE\n"
+              << "  json: JSON, in the same layout as files written by oat-record.\n"
+              << "  csv: Comma separated values with one row per sample.\n\n"
+              << "FILE:\n"
+              << "  Path to binary position log (e.g. pos.oatpos).\n\n"
+              << "OUTPUT:\n"
+              << "  Output file path. Defaults to FILE with its extension\n"
+              << "  replaced by TYPE.\n\n"
+              << options << "\n";
+}
+
+void writeJSON(const oat::poslog::Reader &log, FILE *fd, const bool verbose) {
+
+    char buffer[65536];
+    rapidjson::FileWriteStream stream(fd, buffer, sizeof(buffer));
+    rapidjson::PrettyWriter<rapidjson::FileWriteStream> w(stream);
+
+    w.StartObject();
+
+    w.String("oat_version");
+    w.String(log.oat_version().c_str());
+
+    // Header object
+    w.String("header");
+    w.StartObject();
+    w.String("date");
+    w.String(log.date().c_str());
+    w.String("sample_rate_hz");
+    w.Double(log.sample_rate_hz());
+    w.String("source");
+    w.String(log.source().c_str());
+    w.EndObject();
+
+    // Data
+    w.String("positions");
+    w.StartArray();
+
+    for (size_t i = 0; i < log.size(); i++) {
+
+        const auto r = log.record(i);
+
+        w.StartObject();
+
+        w.String("tick");
+        w.Int(r.tick);
+
+        w.String("usec");
+        w.Int64(r.usec);
+
+        w.String("unit");
+        w.Int(r.unit());
+
+        w.String("pos_ok");
+        w.Bool(r.position_valid() || verbose);
+
+        if (r.position_valid() || verbose) {
+            w.String("pos_xy");
+            w.StartArray();
+            w.Double(r.position[0]);
+            w.Double(r.position[1]);
+            w.EndArray(2);
+        }
+
+        w.String("vel_ok");
+        w.Bool(r.velocity_valid() || verbose);
+
+        if (r.velocity_valid() || verbose) {
+            w.String("vel_xy");
+            w.StartArray();
+            w.Double(r.velocity[0]);
+            w.Double(r.velocity[1]);
+            w.EndArray(2);
+        }
+
+        w.String("head_ok");
+        w.Bool(r.heading_valid());
+
+        if (r.heading_valid() || verbose) {
+            w.String("head_xy");
+            w.StartArray();
+            w.Double(r.heading[0]);
+            w.Double(r.heading[1]);
+            w.EndArray(2);
+        }
+
+        w.String("reg_ok");
+        w.Bool(r.region_valid());
+
+        if (r.region_valid() || verbose) {
+            w.String("reg");
+            w.String(r.region_valid() ? log.regionName(r.region).c_str() : "");
+        }
+
+        w.EndObject();
+    }
+
+    w.EndArray();
+    w.EndObject();
+    stream.Flush();
+}
+
+void writeCSV(const oat::poslog::Reader &log, FILE *fd) {
+
+    fprintf(fd, "tick,usec,unit,pos_ok,pos_x,pos_y,vel_ok,vel_x,vel_y,"
+                "head_ok,head_x,head_y,reg_ok,reg\n");
+
+    for (size_t i = 0; i < log.size(); i++) {
+
+        const auto r = log.record(i);
+
+        fprintf(fd, "%llu,%lld,%d,%d,%.17g,%.17g,%d,%.17g,%.17g,%d,%.17g,%.17g,%d,\"%s\"\n",
+                static_cast<unsigned long long>(r.tick),
+                static_cast<long long>(r.usec),
+                r.unit(),
+                r.position_valid(), r.position[0], r.position[1],
+                r.velocity_valid(), r.velocity[0], r.velocity[1],
+                r.heading_valid(), r.heading[0], r.heading[1],
+                r.region_valid(),
+                r.region_valid() ? log.regionName(r.region).c_str() : "");
+    }
+}
+
+int main(int argc, char *argv[]) {
+
+    std::string type;
+    std::string file;
+    std::string output;
+    bool concise = false;
+    po::options_description visible_options("OPTIONS");
+
+    std::unordered_map<std::string, char> type_hash;
+    type_hash["json"] = 'a';
+    type_hash["csv"] = 'b';
+
+    try {
+
+        po::options_description options("INFO");
+        options.add_options()
+                ("help", "Produce help message.")
+                ("version,v", "Print version information.")
+                ;
+
+        po::options_description config("CONFIGURATION");
+        config.add_options()
+                ("concise-file,c",
+                 "If set, indeterminate position data fields will not be "
+                 "written to JSON output, e.g. pos_xy will not be written when "
+                 "pos_ok = false.")
+                ;
+
+        po::options_description hidden("HIDDEN OPTIONS");
+        hidden.add_options()
+                ("type", po::value<std::string>(&type),
+                "Output format.")
+                ("file", po::value<std::string>(&file),
+                "Binary position log to convert.")
+                ("output", po::value<std::string>(&output),
+                "Output file path.")
+                ;
+
+        po::positional_options_description positional_options;
+        positional_options.add("type", 1);
+        positional_options.add("file", 1);
+        positional_options.add("output", 1);
+
+        po::options_description all_options("OPTIONS");
+        all_options.add(options).add(config).add(hidden);
+
+        visible_options.add(options).add(config);
+
+        po::variables_map variable_map;
+        po::store(po::command_line_parser(argc, argv)
+                .options(all_options)
+                .positional(positional_options)
+                .run(),
+                variable_map);
+        po::notify(variable_map);
+
+        // Use the parsed options
+        if (variable_map.count("help")) {
+            printUsage(visible_options);
+            return 0;
+        }
+
+        if (variable_map.count("version")) {
+            std::cout << "Oat Position Log Converter version "
+                      << Oat_VERSION_MAJOR
+                      << "."
+                      << Oat_VERSION_MINOR
+                      << "\n";
+            std::cout << "Written by Jonathan P. Newman in the MWL@MIT.\n";
+            std::cout << "Licensed under the GPL3.0.\n";
+            return 0;
+        }
+
+        if (!variable_map.count("type")) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("A TYPE must be specified.\n");
+            return -1;
+        }
+
+        if (!variable_map.count("file")) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("A FILE must be specified.\n");
+            return -1;
+        }
+
+        if (!variable_map.count("output"))
+            output = bfs::path(file).replace_extension(type).string();
+
+        if (variable_map.count("concise-file"))
+            concise = true;
+
+    } catch (std::exception& e) {
+        std::cerr << oat::Error(e.what()) << "\n";
+        return -1;
+    } catch (...) {
+        std::cerr << oat::Error("Exception of unknown type.\n");
+        return -1;
+    }
+
+    if (type_hash[type] == 0) {
+        printUsage(visible_options);
+        std::cerr << oat::Error("Invalid TYPE specified.\n");
+        return -1;
+    }
+
+    const std::string name = "convert[" + file + "->" + output + "]";
+
+    try {
+
+        oat::poslog::Reader log(file);
+
+        FILE *fd = fopen(output.c_str(), "wb");
+        if (fd == nullptr)
+            throw (std::runtime_error("Could not open " + output + " for writing.\n"));
+
+        switch (type_hash[type]) {
+            case 'a':
+                writeJSON(log, fd, !concise);
+                break;
+            case 'b':
+                writeCSV(log, fd);
+                break;
+        }
+
+        fclose(fd);
+
+        std::cout << oat::whoMessage(name,
+                     "Converted " + std::to_string(log.size()) + " positions.\n");
+
+        return 0;
+
+    } catch (const std::runtime_error &ex) {
+        std::cerr << oat::whoError(name, ex.what()) << "\n";
+    } catch (const boost::interprocess::interprocess_exception &ex) {
+        std::cerr << oat::whoError(name, ex.what()) << "\n";
+    } catch (...) {
+        std::cerr << oat::whoError(name, "Unknown exception.\n");
+    }
+
+    // Exit failure
+    return -1;
+}
@@ -45,8 +45,7 @@ Decorator::Decorator(const std::vector<std::string> &position_source_addresses,
     if (!position_source_addresses.empty()) {
         for (auto &addr : position_source_addresses) {
 
-            oat::Position2D pos(addr);
-            positions_.push_back(std::move(pos));
+            positions_.push_back(oat::Position2D());
             position_sources_.push_back(
                 oat::NamedSource<oat::Position2D>(
                     addr,
@@ -328,7 +327,7 @@ void Decorator::printRegion() {
     size_t i = 0;
     for (auto &ps : position_sources_) {
         if (positions_[i].region_valid)
-            reg_text = ps.name + ": " + std::string(positions_[i].region);
+            reg_text = ps.name + ": " + positions_[i].region();
         else
             reg_text = ps.name + ": ?";
 
@@ -18,11 +18,14 @@
 //******************************************************************************
 
 #include <chrono>
+#include <memory>
 #include <string>
 #include <thread>
 #include <opencv2/videoio.hpp>
 
 #include <cpptoml.h>
+#include <boost/interprocess/exceptions.hpp>
+#include "../../lib/datatypes/FrameIndex.h"
 #include "../../lib/utility/TOMLSanitize.h"
 #include "../../lib/utility/IOFormat.h"
 
@@ -37,6 +40,7 @@ FileReader::FileReader(const std::string &image_sink_address,
 , file_name_(file_name)
 , file_reader_(file_name)
 , frames_per_second_(frames_per_second)
+, index_path_(file_name + ".idx")
 {
 
     // Default config
@@ -61,6 +65,9 @@ void FileReader::connectToNode() {
     // Reset the video to the start
     file_reader_.set(CV_CAP_PROP_POS_AVI_RATIO, 0);
 
+    if (seek_sample_ >= 0 || seek_sec_ >= 0)
+        seek();
+
     // Put the sample rate in the shared frame
     internal_sample_.set_rate_hz(1.0 / frame_period_in_sec_.count());
 }
@@ -88,6 +95,9 @@ bool FileReader::serveFrame() {
         to_crop.copyTo(shared_frame_);
     }
 
+    // Stamp acquisition time on the shared monotonic clock
+    internal_sample_.stampMonotonic();
+
     // Update sample count
     shared_frame_.sample() = internal_sample_;
 
@@ -112,7 +122,11 @@ void FileReader::configure(const std::string& config_file,
                            const std::string& config_key) {
 
     // Available options
-    std::vector<std::string> options {"fps", "roi"};
+    std::vector<std::string> options {"fps",
+                                      "roi",
+                                      "index",
+                                      "seek_sample",
+                                      "seek_time"};
 
     // This will throw cpptoml::parse_exception if a file
     // with invalid TOML is provided
@@ -147,11 +161,52 @@ void FileReader::configure(const std::string& config_file,
             use_roi_ = true;
         }
 
+        // Starting point
+        oat::config::getValue(this_config, "index", index_path_);
+        oat::config::getValue(this_config, "seek_sample", seek_sample_,
+                              static_cast<int64_t>(0));
+        oat::config::getValue(this_config, "seek_time", seek_sec_, 0.0);
+
+        if (seek_sample_ >= 0 && seek_sec_ >= 0)
+            throw (std::runtime_error(oat::configValueError(
+                "seek_time", config_key, config_file,
+                "cannot be specified along with seek_sample.")));
+
     } else {
         throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
     }
 }
 
+void FileReader::seek() {
+
+    std::unique_ptr<oat::frameidx::Reader> index;
+    try {
+        index.reset(new oat::frameidx::Reader(index_path_));
+    } catch (const boost::interprocess::interprocess_exception &ex) {
+        throw (std::runtime_error("Seeking requires the frame index "
+                                  + index_path_ + " written by oat-record: "
+                                  + ex.what()));
+    }
+
+    auto e = seek_sample_ >= 0
+           ? index->findTick(static_cast<uint64_t>(seek_sample_))
+           : index->findTime(static_cast<int64_t>(seek_sec_ * 1e6));
+
+    if (e == index->end())
+        throw (std::runtime_error("Seek position is past the end of " + file_name_));
+
+    if (!(e->flags & oat::frameidx::FRAME_NUMBER))
+        throw (std::runtime_error(index_path_ + " does not index a video file."));
+
+    // The decoder seeks to the nearest preceding keyframe and decodes from
+    // there, rather than from the start of the file
+    file_reader_.set(CV_CAP_PROP_POS_FRAMES, static_cast<double>(e->offset));
+
+    std::cout << oat::whoMessage(name_,
+                 "Starting at sample " + std::to_string(e->tick)
+                 + " (frame " + std::to_string(e->offset) + ").\n");
+}
+
 void FileReader::calculateFramePeriod() {
 
     std::chrono::duration<double> frame_period {1.0 / frames_per_second_};
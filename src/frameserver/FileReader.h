@@ -21,6 +21,7 @@
 #define	OAT_FILEREADER_H
 
 #include <chrono>
+#include <cstdint>
 #include <limits>
 #include <string>
 #include <opencv2/videoio.hpp>
@@ -53,6 +54,13 @@ private:
     double frames_per_second_;
     void calculateFramePeriod(void);
 
+    // Per-frame index written by the recorder, used to seek to a sample
+    // number or time without decoding the preceding frames
+    std::string index_path_;
+    int64_t seek_sample_ {-1};
+    double seek_sec_ {-1.0};
+    void seek(void);
+
     // frame generation clock
     std::chrono::high_resolution_clock clock_;
     std::chrono::duration<double> frame_period_in_sec_;
@@ -1011,6 +1011,9 @@ bool PGGigECam::serveFrame() {
     if (rc == -1)
         return false;
 
+    // Stamp acquisition time on the shared monotonic clock
+    internal_sample_.stampMonotonic();
+
 //#ifndef NDEBUG
     if (rc > 0) {
         std::cerr << oat::Warn("Frame re-transmission due to " +
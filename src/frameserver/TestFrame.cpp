@@ -103,6 +103,9 @@ bool TestFrame::serveFrame() {
         // Wait for sources to read
         frame_sink_.wait();
 
+        // Stamp acquisition time on the shared monotonic clock
+        internal_sample_.stampMonotonic();
+
         // Zero frame copy
         shared_frame_.sample() = internal_sample_;
 
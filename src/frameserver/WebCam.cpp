@@ -88,6 +88,9 @@ bool WebCam::serveFrame() {
         to_crop.copyTo(shared_frame_);
     }
 
+    // Stamp acquisition time on the shared monotonic clock
+    internal_sample_.stampMonotonic();
+
     // Update sample count
     shared_frame_.sample() = internal_sample_;
 
@@ -39,7 +39,8 @@ MeanPosition::MeanPosition(const std::vector<std::string> &position_source_addre
 void MeanPosition::configure(const std::string& config_file, const std::string& config_key) {
 
     // Available options
-    const std::vector<std::string> options {"heading_anchor"};
+    std::vector<std::string> options {"heading_anchor"};
+    options.insert(options.end(), matching_options.begin(), matching_options.end());
 
     // This will throw cpptoml::parse_exception if a file
     // with invalid TOML is provided
@@ -63,6 +64,9 @@ void MeanPosition::configure(const std::string& config_file, const std::string&
             generate_heading_ = true;
         }
 
+        // Sample matching
+        configureMatching(this_config, config_key, config_file);
+
     } else {
         throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
     }
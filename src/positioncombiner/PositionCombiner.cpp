@@ -17,23 +17,33 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //******************************************************************************
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
 #include <utility>
 #include <thread>
 #include <future>
+#include <cpptoml.h>
 
 #include "../../lib/shmemdf/Source.h"
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/datatypes/Position2D.h"
 #include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/TOMLSanitize.h"
 #include "../../lib/utility/make_unique.h"
 
 #include "PositionCombiner.h"
 
 namespace oat {
 
+const std::vector<std::string> PositionCombiner::matching_options {
+    "match",
+    "tolerance",
+    "buffer"
+};
+
 PositionCombiner::PositionCombiner(
                         const std::vector<std::string> &position_source_addresses,
                         const std::string &position_sink_address) :
@@ -43,8 +53,7 @@ PositionCombiner::PositionCombiner(
 
     for (auto &addr : position_source_addresses) {
 
-        oat::Position2D pos(addr);
-        positions_.push_back(std::move(pos));
+        positions_.push_back(oat::Position2D());
         position_sources_.push_back(
             oat::NamedSource<oat::Position2D>(
                 addr,
@@ -52,6 +61,44 @@ PositionCombiner::PositionCombiner(
             )
         );
     }
+
+    queues_.resize(position_sources_.size());
+}
+
+PositionCombiner::~PositionCombiner() {
+
+    // Join SOURCE reader threads
+    running_ = false;
+    for (auto &t : source_threads_)
+        t.join();
+}
+
+void PositionCombiner::configureMatching(const std::shared_ptr<cpptoml::table> &table,
+                                         const std::string &config_key,
+                                         const std::string &config_file) {
+
+    // Matching method
+    std::string match;
+    if (oat::config::getValue(table, "match", match)) {
+        if (match == "count")
+            match_ = Match::COUNT;
+        else if (match == "time")
+            match_ = Match::TIME;
+        else
+            throw (std::runtime_error(oat::configValueError(
+                "match", config_key, config_file,
+                "must be 'count' or 'time'.")));
+    }
+
+    // Timestamp matching tolerance
+    double tolerance_sec;
+    if (oat::config::getValue(table, "tolerance", tolerance_sec, 0.0))
+        tolerance_usec_ = static_cast<int64_t>(tolerance_sec * 1e6);
+
+    // Number of samples buffered per SOURCE
+    int64_t depth;
+    if (oat::config::getValue(table, "buffer", depth, (int64_t)1))
+        queue_depth_ = depth;
 }
 
 void PositionCombiner::connectToNodes() {
@@ -75,28 +122,162 @@ void PositionCombiner::connectToNodes() {
     }
 
     // Bind to sink node and create a shared position
-    position_sink_.bind(position_sink_address_, position_sink_address_);
+    position_sink_.bind(position_sink_address_);
     shared_position_ = position_sink_.retrieve();
+
+    // Start SOURCE reader threads
+    last_drop_report_ = std::chrono::steady_clock::now();
+    for (pvec_size_t i = 0; i != position_sources_.size(); i++)
+        source_threads_.emplace_back([this, i] { readSource(i); });
 }
 
-bool PositionCombiner::process() {
+void PositionCombiner::readSource(const pvec_size_t idx) {
+
+    auto &source = position_sources_[idx].source;
+
+    try {
+
+        while (running_) {
+
+            // START CRITICAL SECTION //
+            ////////////////////////////
+
+            // Wait with a timeout so that the destructor can stop this
+            // thread even if the SOURCE never produces another sample
+            oat::NodeState state;
+            if (!source->tryWait(state, oat::msec_t(10)))
+                continue;
+
+            if (state == oat::NodeState::END)
+                break;
+
+            oat::Position2D pos = source->clone();
+
+            source->post();
+            ////////////////////////////
+            //  END CRITICAL SECTION  //
+
+            {
+                std::lock_guard<std::mutex> lk(queue_mutex_);
+                auto &q = queues_[idx];
+                if (q.size() >= queue_depth_) {
+                    q.pop_front();
+                    dropped_++;
+                }
+                q.push_back(std::move(pos));
+            }
+
+            queue_cv_.notify_one();
+        }
+
+    } catch (...) {
+        std::lock_guard<std::mutex> lk(queue_mutex_);
+        source_error_ = std::current_exception();
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(queue_mutex_);
+        source_eof_ = true;
+    }
+
+    queue_cv_.notify_one();
+}
+
+int64_t PositionCombiner::matchKey(oat::Position2D &position) const {
+
+    if (match_ == Match::COUNT)
+        return static_cast<int64_t>(position.sample().count());
+
+    // Prefer acquisition time on the shared monotonic clock, which is
+    // comparable across SOURCES that originate from different frame servers
+    const auto &sample = position.sample();
+    return sample.monotonic_microseconds().count() > 0 ?
+           sample.monotonic_microseconds().count() :
+           sample.microseconds().count();
+}
+
+bool PositionCombiner::alignQueues() {
+
+    for (const auto &q : queues_)
+        if (q.empty())
+            return false;
+
+    const int64_t tol = match_ == Match::TIME ? tolerance_usec_ : 0;
+
+    // Repeatedly discard samples that are older than the newest queue front
+    // (by more than the tolerance) until the fronts match or a queue empties
+    for (;;) {
+
+        int64_t newest = matchKey(queues_[0].front());
+        for (auto &q : queues_)
+            newest = std::max(newest, matchKey(q.front()));
+
+        bool aligned = true;
+        for (auto &q : queues_) {
 
-    for (pvec_size_t i = 0; i !=  position_sources_.size(); i++) {
+            while (!q.empty() && matchKey(q.front()) < newest - tol) {
+                q.pop_front();
+                dropped_++;
+            }
 
-        // START CRITICAL SECTION //
-        ////////////////////////////
-        if (position_sources_[i].source->wait() == oat::NodeState::END)
+            if (q.empty())
+                return false;
+
+            if (matchKey(q.front()) > newest + tol)
+                aligned = false;
+        }
+
+        if (aligned)
             return true;
+    }
+}
+
+bool PositionCombiner::process() {
+
+    uint64_t dropped = 0;
 
-        positions_[i] = position_sources_[i].source->clone();
+    {
+        // Wait, with a timeout so that the caller can respond to
+        // interrupts, until a matched set of samples is available
+        std::unique_lock<std::mutex> lk(queue_mutex_);
+        bool matched = false;
+        queue_cv_.wait_for(lk, std::chrono::milliseconds(10),
+                           [this, &matched] {
+                               matched = alignQueues();
+                               return matched || source_eof_;
+                           });
 
-        position_sources_[i].source->post();
-        ////////////////////////////
-        //  END CRITICAL SECTION  //
+        if (source_error_)
+            std::rethrow_exception(source_error_);
+
+        if (!matched)
+            return source_eof_;
+
+        for (pvec_size_t i = 0; i != queues_.size(); i++) {
+            positions_[i] = queues_[i].front();
+            queues_[i].pop_front();
+        }
+
+        dropped = dropped_;
+    }
+
+    // Report samples that could not be matched, at most once per second
+    const auto now = std::chrono::steady_clock::now();
+    if (dropped > dropped_reported_
+        && now - last_drop_report_ > std::chrono::seconds(1)) {
+        std::cerr << oat::whoWarn(name_,
+                     std::to_string(dropped - dropped_reported_)
+                     + " unmatched SOURCE samples dropped.\n");
+        dropped_reported_ = dropped;
+        last_drop_report_ = now;
     }
 
     combine(positions_, internal_position_);
 
+    // The combined position inherits the sample of the matched set, using the
+    // reference (first) SOURCE
+    internal_position_.sample() = positions_[0].sample();
+
     // START CRITICAL SECTION //
     ////////////////////////////
 
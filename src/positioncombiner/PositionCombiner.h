@@ -20,8 +20,16 @@
 #ifndef OAT_POSITIONCOMBINER_H
 #define	OAT_POSITIONCOMBINER_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <utility>
 
@@ -30,6 +38,8 @@
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/datatypes/Position2D.h"
 
+namespace cpptoml { class table; }
+
 namespace oat {
 
 /**
@@ -51,6 +61,8 @@ public:
     PositionCombiner(const std::vector<std::string> &position_source_addresses,
                      const std::string &position_sink_address);
 
+    virtual ~PositionCombiner();
+
     /**
      * Position combiner SOURCEs must be able to connect to a NODEs from
      * which to receive positions and a SINK to send combined positions.
@@ -58,8 +70,10 @@ public:
     virtual void connectToNodes(void);
 
     /**
-     * Obtain positions from all SOURCES. Combine positions. Publish combined position
-     * to SINK.
+     * Obtain a matched set of positions from all SOURCES. Combine positions.
+     * Publish combined position to SINK. SOURCES are read concurrently and
+     * positions are matched by sample number or timestamp, so a late SOURCE
+     * does not delay reading of the others.
      * @return SOURCE end-of-stream signal. If true, this component should exit.
      * TODO: check that position length units are the same before combination
      */
@@ -91,8 +105,46 @@ protected:
      */
     int num_sources(void) const {return position_sources_.size(); };
 
+    /**
+     * Configure sample matching from a combiner's configuration table.
+     * @param table Configuration table
+     * @param config_key configuration key, for error reporting
+     * @param config_file configuration file path, for error reporting
+     */
+    void configureMatching(const std::shared_ptr<cpptoml::table> &table,
+                           const std::string &config_key,
+                           const std::string &config_file);
+
+    // Sample matching configuration keys
+    static const std::vector<std::string> matching_options;
+
 private:
 
+    enum class Match {
+        COUNT = 0, //!< Match samples with equal sample numbers
+        TIME       //!< Match samples with timestamps within a tolerance
+    };
+
+    /**
+     * Read positions from a SOURCE into its queue until the SOURCE ends or
+     * the combiner is destroyed.
+     * @param idx SOURCE index
+     */
+    void readSource(const pvec_size_t idx);
+
+    /**
+     * Drop queued samples that cannot be part of a matched set. Must be
+     * called with queue_mutex_ held.
+     * @return True if the front of every queue is part of a matched set.
+     */
+    bool alignQueues(void);
+
+    /**
+     * Matching key of a position, either its sample number or its timestamp
+     * in microseconds.
+     */
+    int64_t matchKey(oat::Position2D &position) const;
+
     // Combiner name
     std::string name_;
 
@@ -100,8 +152,27 @@ private:
     std::vector<oat::Position2D> positions_;
     oat::NamedSourceList<oat::Position2D> position_sources_;
 
+    // Sample matching
+    Match match_ {Match::COUNT};
+    int64_t tolerance_usec_ {0};
+    size_t queue_depth_ {4};
+
+    // Per-SOURCE queues of received positions, filled by reader threads
+    std::vector<std::thread> source_threads_;
+    std::vector<std::deque<oat::Position2D>> queues_;
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::atomic<bool> running_ {true};
+    bool source_eof_ {false};
+    std::exception_ptr source_error_;
+
+    // Unmatched sample drop reporting
+    uint64_t dropped_ {0};
+    uint64_t dropped_reported_ {0};
+    std::chrono::steady_clock::time_point last_drop_report_;
+
     // Combined position
-    oat::Position2D internal_position_ {"internal"};
+    oat::Position2D internal_position_;
 
     // Position SINK object for publishing combined position
     oat::Position2D * shared_position_ {nullptr};
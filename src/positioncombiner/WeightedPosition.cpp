@@ -0,0 +1,247 @@
+//******************************************************************************
+//* File:   WeightedPosition.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cpptoml.h>
+
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/TOMLSanitize.h"
+
+#include "WeightedPosition.h"
+
+namespace oat {
+
+WeightedPosition::WeightedPosition(const std::vector<std::string> &position_source_addresses,
+                                   const std::string &position_sink_address) :
+  PositionCombiner(position_source_addresses, position_sink_address)
+, weights_(position_source_addresses.size(), 1.0)
+, inlier_(position_source_addresses.size(), true)
+{
+    // Nothing
+}
+
+void WeightedPosition::configure(const std::string& config_file, const std::string& config_key) {
+
+    // Available options
+    std::vector<std::string> options {"mode",
+                                      "weights",
+                                      "max_distance",
+                                      "min_sources"};
+    options.insert(options.end(), matching_options.begin(), matching_options.end());
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Combination mode
+        std::string mode;
+        if (oat::config::getValue(this_config, "mode", mode)) {
+            if (mode == "mean")
+                mode_ = Mode::MEAN;
+            else if (mode == "median")
+                mode_ = Mode::MEDIAN;
+            else if (mode == "reject")
+                mode_ = Mode::REJECT;
+            else
+                throw (std::runtime_error(oat::configValueError(
+                    "mode", config_key, config_file,
+                    "must be 'mean', 'median', or 'reject'.")));
+        }
+
+        // Per-SOURCE weights
+        oat::config::Array weight_array;
+        if (oat::config::getArray(this_config, "weights", weight_array, num_sources())) {
+
+            auto weight_vec = weight_array->array_of<double>();
+            for (int i = 0; i < num_sources(); i++) {
+                weights_[i] = weight_vec[i]->get();
+                if (weights_[i] < 0.0)
+                    throw (std::runtime_error(oat::configValueError(
+                        "weights", config_key, config_file,
+                        "must be non-negative.")));
+            }
+        }
+
+        // Outlier rejection distance
+        if (!oat::config::getValue(this_config, "max_distance", max_distance_, 0.0)
+            && mode_ == Mode::REJECT) {
+            throw (std::runtime_error(oat::configValueError(
+                "max_distance", config_key, config_file,
+                "must be specified when mode is 'reject'.")));
+        }
+
+        // Minimum number of valid SOURCES
+        oat::config::getValue(this_config, "min_sources", min_sources_,
+                              static_cast<int64_t>(1),
+                              static_cast<int64_t>(num_sources()));
+
+        // Sample matching
+        configureMatching(this_config, config_key, config_file);
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+void WeightedPosition::combine(const std::vector<oat::Position2D> &sources,
+                               oat::Position2D &combined_position) {
+
+    // Weighted mean of valid positions
+    oat::Point2D mean(0, 0);
+    double weight_sum = 0.0;
+    int64_t num_valid = 0;
+    for (size_t i = 0; i < sources.size(); i++) {
+        if (sources[i].position_valid && weights_[i] > 0.0) {
+            mean += weights_[i] * sources[i].position;
+            weight_sum += weights_[i];
+            num_valid++;
+        }
+    }
+
+    combined_position.position_valid = num_valid >= min_sources_;
+    combined_position.velocity_valid = false;
+    combined_position.heading_valid = false;
+    if (!combined_position.position_valid)
+        return;
+
+    mean *= 1.0 / weight_sum;
+
+    // Sources that contribute to velocity and heading
+    std::fill(inlier_.begin(), inlier_.end(), true);
+
+    switch (mode_) {
+        case Mode::MEAN:
+        {
+            combined_position.position = mean;
+            break;
+        }
+        case Mode::MEDIAN:
+        {
+            combined_position.position = median(sources, mean);
+            break;
+        }
+        case Mode::REJECT:
+        {
+            // Weighted mean of the positions near the median
+            const oat::Point2D med = median(sources, mean);
+            oat::Point2D inlier_mean(0, 0);
+            double inlier_weight_sum = 0.0;
+            num_valid = 0;
+            for (size_t i = 0; i < sources.size(); i++) {
+                inlier_[i] = cv::norm(sources[i].position - med) <= max_distance_;
+                if (inlier_[i] && sources[i].position_valid && weights_[i] > 0.0) {
+                    inlier_mean += weights_[i] * sources[i].position;
+                    inlier_weight_sum += weights_[i];
+                    num_valid++;
+                }
+            }
+
+            combined_position.position_valid = num_valid >= min_sources_;
+            if (!combined_position.position_valid)
+                return;
+
+            combined_position.position = inlier_mean * (1.0 / inlier_weight_sum);
+            break;
+        }
+    }
+
+    // Weighted mean of valid velocities and headings from contributing
+    // sources
+    oat::Velocity2D velocity(0, 0);
+    oat::UnitVector2D heading(0, 0);
+    double velocity_weight_sum = 0.0;
+    double heading_weight_sum = 0.0;
+    for (size_t i = 0; i < sources.size(); i++) {
+
+        if (!inlier_[i] || !sources[i].position_valid || weights_[i] <= 0.0)
+            continue;
+
+        if (sources[i].velocity_valid) {
+            velocity += weights_[i] * sources[i].velocity;
+            velocity_weight_sum += weights_[i];
+        }
+
+        if (sources[i].heading_valid) {
+            heading += weights_[i] * sources[i].heading;
+            heading_weight_sum += weights_[i];
+        }
+    }
+
+    if (velocity_weight_sum > 0.0) {
+        combined_position.velocity = velocity * (1.0 / velocity_weight_sum);
+        combined_position.velocity_valid = true;
+    }
+
+    // Renormalize head-direction unit vector
+    const double mag = cv::norm(heading);
+    if (heading_weight_sum > 0.0 && mag > 0.0) {
+        combined_position.heading = heading * (1.0 / mag);
+        combined_position.heading_valid = true;
+    }
+}
+
+oat::Point2D WeightedPosition::median(const std::vector<oat::Position2D> &sources,
+                                      const oat::Point2D &mean) const {
+
+    static constexpr int MAX_ITER {50};
+    static constexpr double EPSILON {1e-6};
+
+    oat::Point2D med = mean;
+    for (int it = 0; it < MAX_ITER; it++) {
+
+        oat::Point2D num(0, 0);
+        double denom = 0.0;
+        for (size_t i = 0; i < sources.size(); i++) {
+
+            if (!sources[i].position_valid || weights_[i] <= 0.0)
+                continue;
+
+            // The iteration is undefined at a source position, so stop
+            // if the estimate lands on one
+            const double d = cv::norm(sources[i].position - med);
+            if (d < EPSILON)
+                return sources[i].position;
+
+            num += (weights_[i] / d) * sources[i].position;
+            denom += weights_[i] / d;
+        }
+
+        const oat::Point2D next = num * (1.0 / denom);
+        const bool converged = cv::norm(next - med) < EPSILON;
+        med = next;
+        if (converged)
+            break;
+    }
+
+    return med;
+}
+
+} /* namespace oat */
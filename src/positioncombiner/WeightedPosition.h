@@ -0,0 +1,97 @@
+//******************************************************************************
+//* File:   WeightedPosition.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_WEIGHTEDPOSITION_H
+#define	OAT_WEIGHTEDPOSITION_H
+
+#include <string>
+#include <vector>
+
+#include "PositionCombiner.h"
+
+namespace oat {
+
+/**
+ * A robust, weighted position combiner.
+ */
+class WeightedPosition : public PositionCombiner {
+public:
+
+    /**
+     * A robust, weighted position combiner.
+     * Combines the valid SOURCE positions using per-SOURCE weights. Invalid
+     * SOURCE positions are excluded rather than invalidating the combined
+     * position, so the output remains valid while any SOURCE is occluded. The
+     * combination can be a weighted mean, a weighted geometric median, or a
+     * weighted mean of the SOURCE positions that lie within a maximum
+     * distance of the median.
+     * @param position_source_addresses A vector of position SOURCE addresses
+     * @param position_sink_address Combined position SINK address
+     */
+    WeightedPosition(const std::vector<std::string> &position_source_addresses,
+                     const std::string &position_sink_address);
+
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+
+private:
+
+    enum class Mode {
+        MEAN = 0, //!< Weighted mean
+        MEDIAN,   //!< Weighted geometric median
+        REJECT    //!< Weighted mean of positions near the median
+    };
+
+    /**
+     * Calculate the weighted combination of valid SOURCE positions.
+     * @param sources SOURCE positions to combine
+     * @param combined_position Combined position output
+     */
+    void combine(const std::vector<oat::Position2D>& source_positions,
+                 oat::Position2D &combined_position) override;
+
+    /**
+     * Weighted geometric median of the valid SOURCE positions (Weiszfeld's
+     * algorithm), starting from their weighted mean.
+     * @param sources SOURCE positions
+     * @param mean Weighted mean of valid SOURCE positions
+     * @return Weighted geometric median
+     */
+    oat::Point2D median(const std::vector<oat::Position2D> &sources,
+                        const oat::Point2D &mean) const;
+
+    // Combination mode
+    Mode mode_ {Mode::MEAN};
+
+    // Per-SOURCE weights
+    std::vector<double> weights_;
+
+    // Per-SOURCE flags marking positions that contribute to the combined
+    // velocity and heading. Sized once so that combine() does not allocate.
+    std::vector<bool> inlier_;
+
+    // Maximum distance from the median for REJECT mode (position units)
+    double max_distance_ {0.0};
+
+    // Minimum number of valid SOURCE positions for a valid output
+    int64_t min_sources_ {1};
+};
+
+}      /* namespace oat */
+#endif /* OAT_WEIGHTEDPOSITION_H */
@@ -33,6 +33,7 @@
 
 #include "PositionCombiner.h"
 #include "MeanPosition.h"
+#include "WeightedPosition.h"
 
 namespace po = boost::program_options;
 
@@ -46,7 +47,8 @@ void printUsage(po::options_description options) {
               << "Publish combined position to SINK.\n\n"
               << "TYPE\n"
 
-              << "  mean: Geometric mean of SOURCE positions\n\n"
+              << "  mean: Geometric mean of SOURCE positions\n"
+              << "  weighted: Robust, weighted combination of valid SOURCE positions\n\n"
               << "SOURCES:\n"
               << "  User-supplied position source names (e.g. pos1 pos2).\n\n"
               << "SINK:\n"
@@ -93,6 +95,7 @@ int main(int argc, char *argv[]) {
 
     std::unordered_map<std::string, char> type_hash;
     type_hash["mean"] = 'a';
+    type_hash["weighted"] = 'b';
 
     try {
 
@@ -208,6 +211,11 @@ int main(int argc, char *argv[]) {
             combiner = std::make_shared<oat::MeanPosition>(sources, sink);
             break;
         }
+        case 'b':
+        {
+            combiner = std::make_shared<oat::WeightedPosition>(sources, sink);
+            break;
+        }
         default:
         {
             printUsage(visible_options);
@@ -17,6 +17,8 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //****************************************************************************
 
+#include <algorithm>
+#include <numeric>
 #include <string>
 #include <vector>
 #include <opencv2/core/mat.hpp>
@@ -29,37 +31,205 @@
 
 namespace oat {
 
-void siftContours(cv::Mat &frame, Position2D &position, 
-                  double &area, double min_area, double max_area) {
+namespace {
+
+/**
+ * Indices of the candidates with the largest areas within [min_area,
+ * max_area), in order of decreasing area. Ties keep their original order.
+ */
+void largest(const std::vector<double> &areas, std::vector<size_t> &order,
+             size_t max_blobs, double min_area, double max_area) {
+
+    order.clear();
+    for (size_t i = 0; i < areas.size(); i++)
+        if (areas[i] >= min_area && areas[i] < max_area && areas[i] > 0)
+            order.push_back(i);
+
+    std::stable_sort(order.begin(), order.end(),
+                     [&areas](size_t a, size_t b) { return areas[a] > areas[b]; });
+
+    if (order.size() > max_blobs)
+        order.resize(max_blobs);
+}
+
+void toPosition(const std::vector<Blob> &blobs, Position2D &position,
+                double &area, cv::Rect *bounding_box) {
+
+    position.position_valid = !blobs.empty();
+    area = 0;
+
+    if (blobs.empty())
+        return;
+
+    position.position = blobs[0].centroid;
+    area = blobs[0].area;
+
+    if (bounding_box != nullptr)
+        *bounding_box = blobs[0].bounding_box;
+}
+
+} // namespace
+
+void findBlobs(cv::Mat &frame, std::vector<Blob> &blobs, size_t max_blobs,
+               double min_area, double max_area) {
 
     std::vector<std::vector <cv::Point> > contours;
 
     // NOTE: This function will modify the frame
-    cv::findContours(frame, contours, 
-                     cv::RETR_EXTERNAL, 
+    cv::findContours(frame, contours,
+                     cv::RETR_EXTERNAL,
                      cv::CHAIN_APPROX_SIMPLE);
 
-    double object_area = 0;
-    position.position_valid = false;
-
+    std::vector<cv::Moments> moments;
+    std::vector<double> areas;
     for (auto &c : contours) {
+        moments.push_back(cv::moments(static_cast<cv::Mat>(c)));
+        areas.push_back(moments.back().m00);
+    }
 
-        cv::Moments moment = cv::moments(static_cast<cv::Mat>(c));
-        double countour_area = moment.m00;
+    std::vector<size_t> order;
+    largest(areas, order, max_blobs, min_area, max_area);
 
-        // Isolate the largest contour within the min/max range.
-        if (countour_area >= min_area &&
-            countour_area < max_area &&
-            countour_area > object_area) {
+    blobs.resize(order.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        const cv::Moments &m = moments[order[i]];
+        blobs[i].centroid = cv::Point2d(m.m10 / m.m00, m.m01 / m.m00);
+        blobs[i].area = m.m00;
+        blobs[i].bounding_box = cv::boundingRect(contours[order[i]]);
+    }
+}
+
+void siftContours(cv::Mat &frame, Position2D &position,
+                  double &area, double min_area, double max_area,
+                  cv::Rect *bounding_box) {
+
+    // Isolate the largest contour within the min/max range.
+    std::vector<Blob> blobs;
+    findBlobs(frame, blobs, 1, min_area, max_area);
+    toPosition(blobs, position, area, bounding_box);
+}
 
-            position.position.x = moment.m10 / countour_area;
-            position.position.y = moment.m01 / countour_area;
-            position.position_valid = true;
-            object_area = countour_area;
+void findComponentBlobs(const std::vector<ComponentTile> &tiles,
+                        std::vector<Blob> &blobs, size_t max_blobs,
+                        double min_area, double max_area) {
+
+    // Global label of the first component in each tile
+    std::vector<int> offsets(tiles.size() + 1, 0);
+    for (size_t t = 0; t < tiles.size(); t++)
+        offsets[t + 1] = offsets[t] + tiles[t].stats.rows;
+
+    // Union-find over global labels
+    std::vector<int> parent(offsets.back());
+    std::iota(parent.begin(), parent.end(), 0);
+
+    auto root = [&parent](int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+
+    // Join components that touch across tile boundaries
+    for (size_t t = 0; t + 1 < tiles.size(); t++) {
+
+        const cv::Mat &upper = tiles[t].labels;
+        const cv::Mat &lower = tiles[t + 1].labels;
+        if (upper.empty() || lower.empty())
+            continue;
+
+        const int * above = upper.ptr<int>(upper.rows - 1);
+        const int * below = lower.ptr<int>(0);
+        const int cols = upper.cols;
+
+        for (int j = 0; j < cols; j++) {
+
+            if (above[j] == 0)
+                continue;
+
+            const int a = root(offsets[t] + above[j]);
+            for (int k = std::max(j - 1, 0); k <= std::min(j + 1, cols - 1); k++) {
+                if (below[k] != 0) {
+                    const int b = root(offsets[t + 1] + below[k]);
+                    if (a != b)
+                        parent[b] = a;
+                }
+            }
         }
     }
 
-    area = object_area;
+    // Combine moments of joined components
+    std::vector<double> m00(parent.size(), 0.0);
+    std::vector<double> m10(parent.size(), 0.0);
+    std::vector<double> m01(parent.size(), 0.0);
+    std::vector<cv::Rect> boxes(parent.size());
+
+    for (size_t t = 0; t < tiles.size(); t++) {
+
+        const ComponentTile &tile = tiles[t];
+
+        for (int l = 1; l < tile.stats.rows; l++) {
+
+            const int r = root(offsets[t] + l);
+            const double a = tile.stats.at<int>(l, cv::CC_STAT_AREA);
+            m00[r] += a;
+            m10[r] += a * tile.centroids.at<double>(l, 0);
+            m01[r] += a * (tile.centroids.at<double>(l, 1) + tile.row_offset);
+
+            cv::Rect box(tile.stats.at<int>(l, cv::CC_STAT_LEFT),
+                         tile.stats.at<int>(l, cv::CC_STAT_TOP) + tile.row_offset,
+                         tile.stats.at<int>(l, cv::CC_STAT_WIDTH),
+                         tile.stats.at<int>(l, cv::CC_STAT_HEIGHT));
+            boxes[r] = boxes[r].area() > 0 ? (boxes[r] | box) : box;
+        }
+    }
+
+    // Only roots represent whole components
+    std::vector<double> areas(parent.size(), 0.0);
+    for (size_t i = 0; i < parent.size(); i++)
+        if (parent[i] == static_cast<int>(i))
+            areas[i] = m00[i];
+
+    std::vector<size_t> order;
+    largest(areas, order, max_blobs, min_area, max_area);
+
+    blobs.resize(order.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        const size_t c = order[i];
+        blobs[i].centroid = cv::Point2d(m10[c] / m00[c], m01[c] / m00[c]);
+        blobs[i].area = m00[c];
+        blobs[i].bounding_box = boxes[c];
+    }
+}
+
+void siftComponentTiles(const std::vector<ComponentTile> &tiles,
+                        Position2D &position, double &area,
+                        double min_area, double max_area,
+                        cv::Rect *bounding_box) {
+
+    // Isolate the largest component within the min/max range.
+    std::vector<Blob> blobs;
+    findComponentBlobs(tiles, blobs, 1, min_area, max_area);
+    toPosition(blobs, position, area, bounding_box);
+}
+
+cv::Point2d upsamplePoint(const cv::Point2d &point, int factor) {
+
+    // Each downsampled pixel is the mean of a factor x factor block of full
+    // resolution pixels, so its center lies in the middle of that block
+    const double offset = 0.5 * (factor - 1);
+    return cv::Point2d(point.x * factor + offset, point.y * factor + offset);
+}
+
+cv::Rect refinementWindow(const cv::Rect &coarse_box, int factor, int padding,
+                          const cv::Size &frame_size) {
+
+    cv::Rect window(coarse_box.x * factor - padding,
+                    coarse_box.y * factor - padding,
+                    coarse_box.width * factor + 2 * padding,
+                    coarse_box.height * factor + 2 * padding);
+
+    return window & cv::Rect(cv::Point(0, 0), frame_size);
 }
 
 } /* namespace oat */
@@ -20,8 +20,9 @@
 #ifndef OAT_DETECTORFUNC
 #define	OAT_DETECTORFUNC
 
-// Forward decl.
-namespace cv { class Mat; }
+#include <vector>
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
 
 namespace oat {
 
@@ -31,6 +32,26 @@ static constexpr double PI {3.14159265358979323846};
 // Forward decl.
 class Position2D;
 
+/**
+ * Candidate object found in a binary frame.
+ */
+struct Blob {
+    cv::Point2d centroid;
+    double area {0.0};
+    cv::Rect bounding_box;
+};
+
+/**
+ * Given a binary frame, find all contours and return the largest ones.
+ * @param frame_in Frame to look for objects in. Modified.
+ * @param blobs Output. Candidates, in order of decreasing area.
+ * @param max_blobs Maximum number of candidates returned
+ * @param min_area Minimum contour area to be considered a candidate
+ * @param max_area Maximum contour area to be considered a candidate
+ */
+void findBlobs(cv::Mat &frame, std::vector<Blob> &blobs, size_t max_blobs,
+               double min_area, double max_area);
+
 /**
  * Given a binary frame, find all contours and return a position corresponding
  * to the centroid of the largest one.
@@ -38,10 +59,92 @@ class Position2D;
  * @param position Position output
  * @param min_area Minimum contour area to be considered candidate for position
  * @param max_area Maximum contour area to be considered candidate for position
+ * @param bounding_box If not null, bounding rectangle of the selected contour
  * @return Position corresponding the centroid of the largest contour in the frame.
  */
 void siftContours(cv::Mat &frame, Position2D &position, 
-                  double &object_area, double min_area, double max_area);
+                  double &object_area, double min_area, double max_area,
+                  cv::Rect *bounding_box = nullptr);
+
+/**
+ * Map a point found in a frame that was downsampled by an integer factor
+ * (area interpolation) back to full resolution pixel coordinates.
+ * @param point Point in downsampled frame coordinates
+ * @param factor Downsampling factor
+ * @return Point in full resolution frame coordinates
+ */
+cv::Point2d upsamplePoint(const cv::Point2d &point, int factor);
+
+/**
+ * Get the full resolution window in which to refine a detection made in a
+ * downsampled frame.
+ * @param coarse_box Bounding box of the detected object in the downsampled frame
+ * @param factor Downsampling factor
+ * @param padding Pixels (full resolution) to pad the window on each side
+ * @param frame_size Full resolution frame size used to clip the window
+ * @return Refinement window in full resolution frame coordinates
+ */
+cv::Rect refinementWindow(const cv::Rect &coarse_box, int factor, int padding,
+                          const cv::Size &frame_size);
+
+/**
+ * Connected components of one horizontal tile of a binary frame, as produced
+ * by cv::connectedComponentsWithStats().
+ */
+struct ComponentTile {
+
+    // First frame row covered by this tile
+    int row_offset {0};
+
+    // CV_32S label image, statistics (cv::CC_STAT_*) and centroids of each
+    // label. Label 0 is background.
+    cv::Mat labels, stats, centroids;
+};
+
+/**
+ * Merge connected components found independently within horizontal tiles of
+ * a binary frame and return the largest ones. Components that touch across
+ * tile boundaries (8-connectivity) are joined and their moments combined.
+ * Unlike findBlobs(), which uses the area enclosed by each contour, the area
+ * of a component is its pixel count, so holes are excluded and single pixels
+ * count.
+ * @param tiles Component tiles, ordered from top to bottom of the frame.
+ * @param blobs Output. Candidates, in order of decreasing area.
+ * @param max_blobs Maximum number of candidates returned
+ * @param min_area Minimum component area to be considered a candidate
+ * @param max_area Maximum component area to be considered a candidate
+ */
+void findComponentBlobs(const std::vector<ComponentTile> &tiles,
+                        std::vector<Blob> &blobs, size_t max_blobs,
+                        double min_area, double max_area);
+
+/**
+ * Merge connected components found independently within horizontal tiles of
+ * a binary frame and return a position corresponding to the centroid of the
+ * largest one. Components that touch across tile boundaries (8-connectivity)
+ * are joined and their moments combined.
+ * @param tiles Component tiles, ordered from top to bottom of the frame.
+ * @param position Position output
+ * @param object_area Area of the selected component (pixels)
+ * @param min_area Minimum component area to be considered candidate for position
+ * @param max_area Maximum component area to be considered candidate for position
+ * @param bounding_box If not null, bounding rectangle of the selected component
+ */
+void siftComponentTiles(const std::vector<ComponentTile> &tiles,
+                        Position2D &position, double &object_area,
+                        double min_area, double max_area,
+                        cv::Rect *bounding_box = nullptr);
+
+/**
+ * Get the rows spanned by a single horizontal tile of a frame.
+ * @param tile Tile index
+ * @param num_tiles Number of tiles the frame is split into
+ * @param rows Number of frame rows
+ * @return Row range covered by the tile
+ */
+inline cv::Range tileRowRange(int tile, int num_tiles, int rows) {
+    return cv::Range(tile * rows / num_tiles, (tile + 1) * rows / num_tiles);
+}
 
 }       /* namespace oat */
 #endif	/* OAT_DETECTORFUNC */
@@ -19,6 +19,8 @@
 
 #include "OatConfig.h" // Generated by CMake
 
+#include <algorithm>
+#include <cstdlib>
 #include <string>
 #include <opencv2/cvconfig.h>
 #include <opencv2/opencv.hpp>
@@ -45,24 +47,35 @@ DifferenceDetector::DifferenceDetector(const std::string &frame_source_address,
 
 void DifferenceDetector::detectPosition(cv::Mat &frame, oat::Position2D &position) {
 
-    if (tuning_on_)
-        tune_frame_ = frame.clone();
+    if (frame.depth() != CV_8U)
+        throw std::runtime_error("Difference detector requires 8-bit frames.");
 
-    applyThreshold(frame);
+    if (downsample_ > 1) {
 
-    // Threshold frame will be destroyed by the transform below, so we need to use
-    // it to form the frame that will be shown in the tuning window here
-    if (tuning_on_)
-         tune_frame_.setTo(0, threshold_frame_ == 0);
+        detectCoarseToFine(frame, position);
 
-    siftContours(threshold_frame_,
-                 position,
-                 object_area_,
-                 min_object_area_,
-                 max_object_area_);
+    } else if (num_tiles_ > 1) {
+
+        detectTiled(frame, position);
+
+    } else {
+
+        applyThreshold(frame, blur_size_);
+
+        // Threshold frame will be destroyed by the transform below, so we need to use
+        // it to form the frame that will be shown in the tuning window here. The
+        // frame is not modified by applyThreshold() so it can be masked in place.
+        if (tuning_on_)
+            maskTuningFrame(frame, threshold_frame_);
+
+        // Find the largest contours in the threshold image
+        findBlobs(threshold_frame_, blobs_, max_candidates_,
+                  min_object_area_, max_object_area_);
+        selectLargest(position, object_area_);
+    }
 
     if (tuning_on_)
-        tune(tune_frame_, position);
+        tune(frame, position);
 }
 
 void DifferenceDetector::configure(const std::string& config_file,
@@ -73,7 +86,11 @@ void DifferenceDetector::configure(const std::string& config_file,
                                       "diff_threshold",
                                       "min_area",
                                       "max_area",
+                                      "downsample",
+                                      "tiles",
                                       "tune"};
+    options.insert(options.end(), keyframe_options.begin(), keyframe_options.end());
+    options.insert(options.end(), candidate_options.begin(), candidate_options.end());
 
     // This will throw cpptoml::parse_exception if a file
     // with invalid TOML is provided
@@ -108,6 +125,36 @@ void DifferenceDetector::configure(const std::string& config_file,
         // Maximum object area
         oat::config::getValue(this_config, "max_area", max_object_area_, 0.0);
 
+        // Downsampling factor for coarse-to-fine detection
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "downsample", val, (int64_t)1)) {
+                if (val != 1 && val != 2 && val != 4 && val != 8)
+                    throw (std::runtime_error(oat::configValueError(
+                        "downsample", config_key, config_file, "must be 1, 2, 4, or 8.")));
+                set_downsample(val);
+            }
+        }
+
+        // Number of horizontal tiles for parallel detection
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "tiles", val, (int64_t)1))
+                set_num_tiles(val);
+        }
+
+        // Keyframe detection and tracking
+        configureKeyframes(this_config);
+
+        // Number of candidate positions to publish
+        configureCandidates(this_config, config_key, config_file);
+
+        // Candidates are not found by coarse-to-fine detection
+        if (max_candidates_ > 1 && downsample_ > 1)
+            throw (std::runtime_error(oat::configValueError(
+                "max_candidates", config_key, config_file,
+                "must be 1 when downsample is greater than 1.")));
+
         // Tuning
         oat::config::getValue(this_config, "tune", tuning_on_);
 
@@ -124,6 +171,10 @@ void DifferenceDetector::tune(cv::Mat &frame, const oat::Position2D &position) {
     
     std::string msg = cv::format("Object not found");
 
+    // Plot the full resolution refinement window
+    if (refine_window_.area() > 0)
+        cv::rectangle(frame, refine_window_, cv::Scalar(255, 0, 0), 2);
+
     // Plot a circle representing found object
     if (position.position_valid) {
 
@@ -150,24 +201,358 @@ void DifferenceDetector::tune(cv::Mat &frame, const oat::Position2D &position) {
     cv::waitKey(1);
 }
 
-void DifferenceDetector::applyThreshold(cv::Mat &frame) {
+void DifferenceDetector::applyThreshold(const cv::Mat &frame,
+                                        const cv::Size &blur_size) {
+
+    allocateBuffers(frame);
 
     if (last_image_set_) {
-        cv::cvtColor(frame, frame, cv::COLOR_BGR2GRAY);
-        cv::absdiff(frame, last_image_, threshold_frame_);
-        cv::threshold(threshold_frame_, threshold_frame_, difference_intensity_threshold_, 255, cv::THRESH_BINARY);
+
+        // If blurring, the difference mask holds counts which are later summed
+        // over the blur kernel. Otherwise, it is the final binary threshold frame.
         if (blur_on_) {
-            cv::blur(threshold_frame_, threshold_frame_, blur_size_);
+            differenceThreshold(frame, *last_image_, *this_image_, diff_frame_, 1);
+            blurThreshold(diff_frame_, threshold_frame_, blur_size,
+                          column_sums_, cv::Range(0, frame.rows));
+        } else {
+            differenceThreshold(frame, *last_image_, *this_image_, threshold_frame_, 255);
         }
-        cv::threshold(threshold_frame_, threshold_frame_, difference_intensity_threshold_, 255, cv::THRESH_BINARY);
-        last_image_ = frame.clone(); // Get a copy of the last image
+
     } else {
-        threshold_frame_ = frame.clone();
-        cv::cvtColor(threshold_frame_, threshold_frame_, cv::COLOR_BGR2GRAY);
-        last_image_ = frame.clone();
-        cv::cvtColor(last_image_, last_image_, cv::COLOR_BGR2GRAY);
+
+        // Nothing to difference against, so just prime the grey-scale buffer
+        convertToGrey(frame, *this_image_);
+        threshold_frame_.setTo(0);
         last_image_set_ = true;
     }
+
+    // The current image becomes the last image
+    std::swap(this_image_, last_image_);
+}
+
+void DifferenceDetector::detectCoarseToFine(cv::Mat &frame, oat::Position2D &position) {
+
+    // Frame geometry changed, so the last image is meaningless
+    if (frame.size() != fine_last_->size())
+        fine_last_set_ = false;
+
+    // The full resolution frame is converted to grey-scale once. This is
+    // downsampled for coarse detection and kept to difference against when
+    // refining the next frame.
+    convertToGrey(frame, *fine_this_);
+
+    // Coarse detection on downsampled frame. Areas scale with the square of
+    // the downsampling factor.
+    const double scale = 1.0 / downsample_;
+    const double area_scale = downsample_ * downsample_;
+    cv::resize(*fine_this_, coarse_frame_, cv::Size(), scale, scale, cv::INTER_AREA);
+    applyThreshold(coarse_frame_,
+                   cv::Size(std::max(blur_size_.width / downsample_, 1),
+                            std::max(blur_size_.height / downsample_, 1)));
+
+    cv::Rect coarse_box;
+    siftContours(threshold_frame_,
+                 position,
+                 object_area_,
+                 min_object_area_ / area_scale,
+                 max_object_area_ / area_scale,
+                 &coarse_box);
+
+    // Refine at full resolution within a window around the coarse hit. The
+    // window is padded to account for downsampling error and for the blur
+    // kernel. The previous full resolution frame is required for this.
+    refine_window_ = cv::Rect();
+    if (position.position_valid && fine_last_set_) {
+
+        const cv::Point2d coarse_position = upsamplePoint(position.position, downsample_);
+        const double coarse_area = object_area_ * area_scale;
+
+        int padding = downsample_ + (blur_on_ ? blur_size_.width : 0);
+        refine_window_ = refinementWindow(coarse_box, downsample_, padding, frame.size());
+
+        const cv::Mat grey_window = (*fine_this_)(refine_window_);
+        const cv::Mat last_window = (*fine_last_)(refine_window_);
+        refine_grey_.create(refine_window_.size(), CV_8UC1);
+        refine_threshold_frame_.create(refine_window_.size(), CV_8UC1);
+
+        if (blur_on_) {
+            refine_diff_frame_.create(refine_window_.size(), CV_8UC1);
+            differenceThreshold(grey_window, last_window, refine_grey_,
+                                refine_diff_frame_, 1);
+            blurThreshold(refine_diff_frame_, refine_threshold_frame_, blur_size_,
+                          column_sums_, cv::Range(0, refine_window_.height));
+        } else {
+            differenceThreshold(grey_window, last_window, refine_grey_,
+                                refine_threshold_frame_, 255);
+        }
+
+        if (tuning_on_) {
+            cv::Mat tune_window = frame(refine_window_);
+            maskTuningFrame(tune_window, refine_threshold_frame_);
+        }
+
+        siftContours(refine_threshold_frame_,
+                     position,
+                     object_area_,
+                     min_object_area_,
+                     max_object_area_);
+
+        if (position.position_valid) {
+            position.position.x += refine_window_.x;
+            position.position.y += refine_window_.y;
+        } else {
+            // Fall back to the coarse estimate
+            position.position = coarse_position;
+            position.position_valid = true;
+            object_area_ = coarse_area;
+        }
+    }
+
+    // The current image becomes the last image
+    std::swap(fine_this_, fine_last_);
+    fine_last_set_ = true;
+}
+
+void DifferenceDetector::detectTiled(cv::Mat &frame, oat::Position2D &position) {
+
+    allocateBuffers(frame);
+
+    // Nothing to difference against yet
+    if (!last_image_set_) {
+        applyThreshold(frame, blur_size_);
+        blobs_.clear();
+        position.position_valid = false;
+        object_area_ = 0.0;
+        return;
+    }
+
+    const int rows = frame.rows;
+    const int num_tiles = std::min(num_tiles_, rows);
+    tile_column_sums_.resize(num_tiles);
+    component_tiles_.resize(num_tiles);
+
+    // Difference and threshold. This is row-local, so tiles need no halo.
+    tile_pool_->parallelFor(num_tiles, [&](int t) {
+
+        const cv::Range tile = tileRowRange(t, num_tiles, rows);
+        cv::Mat grey = this_image_->rowRange(tile);
+        cv::Mat mask = blur_on_ ? diff_frame_.rowRange(tile)
+                                : threshold_frame_.rowRange(tile);
+
+        differenceThreshold(frame.rowRange(tile),
+                            last_image_->rowRange(tile),
+                            grey,
+                            mask,
+                            blur_on_ ? 1 : 255);
+    });
+
+    // Blur and find components. Blurring reads halo rows from the complete
+    // difference mask produced above.
+    tile_pool_->parallelFor(num_tiles, [&](int t) {
+
+        const cv::Range tile = tileRowRange(t, num_tiles, rows);
+
+        if (blur_on_)
+            blurThreshold(diff_frame_, threshold_frame_, blur_size_,
+                          tile_column_sums_[t], tile);
+
+        // Per-tile component moments, merged below
+        ComponentTile &components = component_tiles_[t];
+        components.row_offset = tile.start;
+        cv::connectedComponentsWithStats(threshold_frame_.rowRange(tile),
+                                         components.labels,
+                                         components.stats,
+                                         components.centroids,
+                                         8,
+                                         CV_32S);
+    });
+
+    // The current image becomes the last image
+    std::swap(this_image_, last_image_);
+
+    // Unlike siftContours(), the threshold frame is not modified by the
+    // component search
+    if (tuning_on_)
+        maskTuningFrame(frame, threshold_frame_);
+
+    findComponentBlobs(component_tiles_, blobs_, max_candidates_,
+                       min_object_area_, max_object_area_);
+    selectLargest(position, object_area_);
+}
+
+void DifferenceDetector::allocateBuffers(const cv::Mat &frame) {
+
+    // Frame geometry changed, so the last image is meaningless
+    if (frame.size() != last_image_->size())
+        last_image_set_ = false;
+
+    // These are no-ops unless the frame geometry has changed
+    grey_buffer_[0].create(frame.size(), CV_8UC1);
+    grey_buffer_[1].create(frame.size(), CV_8UC1);
+    diff_frame_.create(frame.size(), CV_8UC1);
+    threshold_frame_.create(frame.size(), CV_8UC1);
+}
+
+void DifferenceDetector::convertToGrey(const cv::Mat &frame, cv::Mat &grey) {
+
+    switch (frame.channels()) {
+        case 1:
+            frame.copyTo(grey);
+            break;
+        case 4:
+            cv::cvtColor(frame, grey, cv::COLOR_BGRA2GRAY);
+            break;
+        default:
+            cv::cvtColor(frame, grey, cv::COLOR_BGR2GRAY);
+            break;
+    }
+}
+
+void DifferenceDetector::differenceThreshold(const cv::Mat &frame,
+                                             const cv::Mat &last_grey,
+                                             cv::Mat &grey,
+                                             cv::Mat &mask,
+                                             const uchar on) {
+
+    // Fixed point BGR -> grey coefficients (same as those used by cv::cvtColor)
+    static constexpr int GREY_SHIFT {14};
+    static constexpr int B2Y {1868}, G2Y {9617}, R2Y {4899};
+    static constexpr int GREY_ROUND {1 << (GREY_SHIFT - 1)};
+
+    const int thresh = difference_intensity_threshold_;
+    const int channels = frame.channels();
+
+    // Process continuous matrices as a single long row
+    cv::Size size = frame.size();
+    if (frame.isContinuous() && last_grey.isContinuous()
+        && grey.isContinuous() && mask.isContinuous()) {
+        size.width *= size.height;
+        size.height = 1;
+    }
+
+    // Single pass: grey-scale conversion, absolute difference, threshold
+    for (int i = 0; i < size.height; i++) {
+
+        const uchar * src = frame.ptr<uchar>(i);
+        const uchar * last = last_grey.ptr<uchar>(i);
+        uchar * gry = grey.ptr<uchar>(i);
+        uchar * dst = mask.ptr<uchar>(i);
+
+        if (channels == 1) {
+
+            for (int j = 0; j < size.width; j++) {
+                const int y = src[j];
+                gry[j] = static_cast<uchar>(y);
+                dst[j] = std::abs(y - last[j]) > thresh ? on : 0;
+            }
+
+        } else {
+
+            for (int j = 0; j < size.width; j++) {
+                const uchar * px = src + j * channels;
+                const int y = (px[0] * B2Y + px[1] * G2Y + px[2] * R2Y
+                               + GREY_ROUND) >> GREY_SHIFT;
+                gry[j] = static_cast<uchar>(y);
+                dst[j] = std::abs(y - last[j]) > thresh ? on : 0;
+            }
+        }
+    }
+}
+
+void DifferenceDetector::blurThreshold(const cv::Mat &mask,
+                                       cv::Mat &threshold_frame,
+                                       const cv::Size &blur_size,
+                                       std::vector<int> &column_sums,
+                                       const cv::Range &rows_out) {
+
+    // This is equivalent to normalized box filtering of the binary difference
+    // mask followed by a second threshold, but is performed using running
+    // sums over the box so the cost is independent of the blur size. Only
+    // rows_out of the threshold frame are produced, but the mask is read
+    // beyond them so that row ranges can be processed independently.
+    const int rows = mask.rows;
+    const int cols = mask.cols;
+    const int kw = blur_size.width;
+    const int kh = blur_size.height;
+    const int ax = kw / 2;
+    const int ay = kh / 2;
+
+    // The blurred 0/255 mask, rounded to nearest, exceeds the threshold when
+    // 255 * count / (kw * kh) >= thresh + 0.5, i.e. 510 * count >= min_weight.
+    // Compared exactly since min_weight need not be a multiple of 510.
+    const int64_t min_weight =
+        (2 * static_cast<int64_t>(difference_intensity_threshold_) + 1) * kw * kh;
+
+    // Column sums are padded on either side by the blur kernel's anchor
+    const size_t sums_size = cols + kw - 1;
+    if (column_sums.size() < sums_size)
+        column_sums.resize(sums_size);
+
+    int * sums = column_sums.data();
+    std::fill(sums, sums + sums_size, 0);
+
+    auto accumulateRow = [&](int r, int sign) {
+        const uchar * src =
+            mask.ptr<uchar>(cv::borderInterpolate(r, rows, cv::BORDER_REFLECT_101));
+        int * dst = sums + ax;
+        for (int j = 0; j < cols; j++)
+            dst[j] += sign * src[j];
+    };
+
+    // Prime the vertical sums using the first kernel's worth of rows
+    for (int r = rows_out.start - ay; r < rows_out.start + kh - ay; r++)
+        accumulateRow(r, 1);
+
+    for (int i = rows_out.start; i < rows_out.end; i++) {
+
+        // Slide the vertical window down one row
+        if (i > rows_out.start) {
+            accumulateRow(i - ay + kh - 1, 1);
+            accumulateRow(i - ay - 1, -1);
+        }
+
+        // Pad column sums with reflected borders
+        for (int p = 0; p < ax; p++)
+            sums[p] = sums[ax + cv::borderInterpolate(p - ax, cols, cv::BORDER_REFLECT_101)];
+        for (int p = ax + cols; p < cols + kw - 1; p++)
+            sums[p] = sums[ax + cv::borderInterpolate(p - ax, cols, cv::BORDER_REFLECT_101)];
+
+        // Slide the horizontal window across the row
+        uchar * dst = threshold_frame.ptr<uchar>(i);
+        int64_t count = 0;
+        for (int p = 0; p < kw; p++)
+            count += sums[p];
+
+        dst[0] = 510 * count >= min_weight ? 255 : 0;
+        for (int j = 1; j < cols; j++) {
+            count += sums[j + kw - 1] - sums[j - 1];
+            dst[j] = 510 * count >= min_weight ? 255 : 0;
+        }
+    }
+}
+
+void DifferenceDetector::maskTuningFrame(cv::Mat &frame,
+                                         const cv::Mat &threshold_frame) {
+
+    const size_t elem_size = frame.elemSize();
+
+    for (int i = 0; i < frame.rows; i++) {
+
+        uchar * px = frame.ptr<uchar>(i);
+        const uchar * mask = threshold_frame.ptr<uchar>(i);
+
+        for (int j = 0; j < frame.cols; j++, px += elem_size)
+            if (!mask[j])
+                std::fill(px, px + elem_size, 0);
+    }
+}
+
+void DifferenceDetector::set_downsample(int factor) {
+
+    // Change of resolution invalidates the last image
+    downsample_ = factor;
+    last_image_set_ = false;
+    fine_last_set_ = false;
 }
 
 void DifferenceDetector::createTuningWindows() {
@@ -22,8 +22,10 @@
 
 #include <string>
 #include <limits>
+#include <vector>
 #include <opencv2/core/mat.hpp>
 
+#include "DetectorFunc.h"
 #include "PositionDetector.h"
 
 namespace oat {
@@ -59,14 +61,39 @@ public:
     void set_min_object_area(double value) { min_object_area_ = value; }
     void set_max_object_area(double value) { max_object_area_ = value; }
     void set_blur_size(int value);
+    void set_downsample(int factor);
 
 private:
 
-    // Intermediate variables
-    cv::Mat this_image_, last_image_;
-    cv::Mat threshold_frame_;
+    // Double-buffered grey-scale frames. Pointers are swapped after each
+    // frame so that no copies of the previous frame are required.
+    cv::Mat grey_buffer_[2];
+    cv::Mat * this_image_ {&grey_buffer_[0]};
+    cv::Mat * last_image_ {&grey_buffer_[1]};
     bool last_image_set_ {false};
 
+    // Intermediate variables
+    cv::Mat diff_frame_, threshold_frame_;
+    std::vector<int> column_sums_;
+
+    // Coarse-to-fine detection. If downsample_ > 1, detection is performed
+    // on a downsampled frame and then refined at full resolution within a
+    // window surrounding the coarse detection. Full resolution grey-scale
+    // frames are double-buffered in the same way as those above.
+    int downsample_ {1};
+    cv::Mat coarse_frame_;
+    cv::Mat fine_buffer_[2];
+    cv::Mat * fine_this_ {&fine_buffer_[0]};
+    cv::Mat * fine_last_ {&fine_buffer_[1]};
+    bool fine_last_set_ {false};
+    cv::Mat refine_grey_;
+    cv::Mat refine_diff_frame_, refine_threshold_frame_;
+    cv::Rect refine_window_;
+
+    // Tile-parallel detection buffers, one per tile
+    std::vector<std::vector<int>> tile_column_sums_;
+    std::vector<oat::ComponentTile> component_tiles_;
+
     // Object detection
     double object_area_ {0.0};
 
@@ -79,13 +106,22 @@ private:
 
     // Tuning stuff
     const std::string tuning_image_title_;
-    cv::Mat tune_frame_;
     int dummy0_ {0}, dummy1_ {10000};
 
     // Processing functions
     void createTuningWindows(void);
     void tune(cv::Mat &frame, const oat::Position2D &position);
-    void applyThreshold(cv::Mat &frame);
+    void applyThreshold(const cv::Mat &frame, const cv::Size &blur_size);
+    void detectCoarseToFine(cv::Mat &frame, oat::Position2D &position);
+    void detectTiled(cv::Mat &frame, oat::Position2D &position);
+    void allocateBuffers(const cv::Mat &frame);
+    void convertToGrey(const cv::Mat &frame, cv::Mat &grey);
+    void differenceThreshold(const cv::Mat &frame, const cv::Mat &last_grey,
+                             cv::Mat &grey, cv::Mat &mask, const uchar on);
+    void blurThreshold(const cv::Mat &mask, cv::Mat &threshold_frame,
+                       const cv::Size &blur_size, std::vector<int> &column_sums,
+                       const cv::Range &rows_out);
+    void maskTuningFrame(cv::Mat &frame, const cv::Mat &threshold_frame);
 };
 
 // Tuning GUI callbacks
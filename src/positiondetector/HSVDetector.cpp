@@ -19,6 +19,7 @@
 
 #include "OatConfig.h" // Generated by CMake
 
+#include <algorithm>
 #include <string>
 #include <limits>
 #include <opencv2/opencv.hpp>
@@ -47,6 +48,38 @@ HSVDetector::HSVDetector(const std::string &frame_source_address,
 
 void HSVDetector::detectPosition(cv::Mat &frame, oat::Position2D &position) {
 
+    if (downsample_ > 1) {
+
+        detectCoarseToFine(frame, position);
+
+    } else if (num_tiles_ > 1) {
+
+        detectTiled(frame, position);
+
+    } else {
+
+        applyThreshold(frame, threshold_frame_, erode_element_, dilate_element_);
+
+        // Threshold frame will be destroyed by the transform below, so we need to use
+        // it to form the frame that will be shown in the tuning window here
+        if (tuning_on_)
+            frame.setTo(0, threshold_frame_ == 0);
+
+        // Find the largest contours in the threshold image
+        findBlobs(threshold_frame_, blobs_, max_candidates_,
+                  min_object_area_, max_object_area_);
+        selectLargest(position, object_area_);
+    }
+
+    // Use the GUI tuner if requested
+    if (tuning_on_)
+        tune(frame, position);
+}
+
+void HSVDetector::applyThreshold(cv::Mat &frame, cv::Mat &threshold_frame,
+                                 const cv::Mat &erode_element,
+                                 const cv::Mat &dilate_element) {
+
     // Transform frame to HSV
     // (Extremely expensive operation)
     cv::cvtColor(frame, frame, cv::COLOR_BGR2HSV);
@@ -56,30 +89,145 @@ void HSVDetector::detectPosition(cv::Mat &frame, oat::Position2D &position) {
     cv::inRange(frame,
                 cv::Scalar(h_min_, s_min_, v_min_),
                 cv::Scalar(h_max_, s_max_, v_max_),
-                threshold_frame_);
+                threshold_frame);
 
     // Filter the resulting threshold image
     if (erode_on_)
-        cv::erode(threshold_frame_, threshold_frame_, erode_element_);
+        cv::erode(threshold_frame, threshold_frame, erode_element);
 
     if (dilate_on_)
-        cv::dilate(threshold_frame_, threshold_frame_, dilate_element_);
+        cv::dilate(threshold_frame, threshold_frame, dilate_element);
+}
 
-    // Threshold frame will be destroyed by the transform below, so we need to use
-    // it to form the frame that will be shown in the tuning window here
-    if (tuning_on_)
-        frame.setTo(0, threshold_frame_ == 0).clone();
+void HSVDetector::detectCoarseToFine(cv::Mat &frame, oat::Position2D &position) {
 
-    // Find the largest contour in the threshold image
+    // Coarse detection on downsampled frame. Areas scale with the square of
+    // the downsampling factor.
+    const double scale = 1.0 / downsample_;
+    const double area_scale = downsample_ * downsample_;
+    cv::resize(frame, coarse_frame_, cv::Size(), scale, scale, cv::INTER_AREA);
+    applyThreshold(coarse_frame_, threshold_frame_,
+                   coarse_erode_element_, coarse_dilate_element_);
+
+    cv::Rect coarse_box;
     siftContours(threshold_frame_,
+                 position,
+                 object_area_,
+                 min_object_area_ / area_scale,
+                 max_object_area_ / area_scale,
+                 &coarse_box);
+
+    refine_window_ = cv::Rect();
+    if (!position.position_valid)
+        return;
+
+    const cv::Point2d coarse_position = upsamplePoint(position.position, downsample_);
+    const double coarse_area = object_area_ * area_scale;
+
+    // Refine at full resolution within a window around the coarse hit. The
+    // window is padded to account for downsampling error and for the
+    // erosion and dilation kernels.
+    int padding = downsample_
+                  + (erode_on_ ? erode_px_ : 0)
+                  + (dilate_on_ ? dilate_px_ : 0);
+    refine_window_ = refinementWindow(coarse_box, downsample_, padding, frame.size());
+
+    cv::Mat frame_window = frame(refine_window_);
+    applyThreshold(frame_window, refine_threshold_frame_,
+                   erode_element_, dilate_element_);
+
+    if (tuning_on_)
+        frame_window.setTo(0, refine_threshold_frame_ == 0);
+
+    siftContours(refine_threshold_frame_,
                  position,
                  object_area_,
                  min_object_area_,
                  max_object_area_);
 
-    // Use the GUI tuner if requested
-    if (tuning_on_)
-        tune(frame, position);
+    if (position.position_valid) {
+        position.position.x += refine_window_.x;
+        position.position.y += refine_window_.y;
+    } else {
+        // Fall back to the coarse estimate
+        position.position = coarse_position;
+        position.position_valid = true;
+        object_area_ = coarse_area;
+    }
+}
+
+void HSVDetector::detectTiled(cv::Mat &frame, oat::Position2D &position) {
+
+    const int rows = frame.rows;
+    const int num_tiles = std::min(num_tiles_, rows);
+
+    // Rows above and below each tile that are required by erosion and
+    // dilation to produce the correct result within the tile
+    const int halo = (erode_on_ ? erode_px_ : 0) + (dilate_on_ ? dilate_px_ : 0);
+
+    threshold_frame_.create(frame.size(), CV_8UC1);
+    tile_hsv_frames_.resize(num_tiles);
+    tile_threshold_frames_.resize(num_tiles);
+    component_tiles_.resize(num_tiles);
+
+    const cv::Scalar lower(h_min_, s_min_, v_min_);
+    const cv::Scalar upper(h_max_, s_max_, v_max_);
+
+    tile_pool_->parallelFor(num_tiles, [&](int t) {
+
+        const cv::Range tile = tileRowRange(t, num_tiles, rows);
+        const cv::Range halo_tile(std::max(tile.start - halo, 0),
+                                  std::min(tile.end + halo, rows));
+        const cv::Range interior(tile.start - halo_tile.start,
+                                 tile.end - halo_tile.start);
+
+        cv::Mat &hsv = tile_hsv_frames_[t];
+        cv::Mat &threshold = tile_threshold_frames_[t];
+
+        // Halo rows are shared with neighboring tiles, so the frame is not
+        // converted in place
+        cv::cvtColor(frame.rowRange(halo_tile), hsv, cv::COLOR_BGR2HSV);
+        cv::inRange(hsv, lower, upper, threshold);
+
+        if (erode_on_)
+            cv::erode(threshold, threshold, erode_element_);
+
+        if (dilate_on_)
+            cv::dilate(threshold, threshold, dilate_element_);
+
+        // Only the tile interior is written back
+        cv::Mat threshold_tile = threshold_frame_.rowRange(tile);
+        threshold.rowRange(interior).copyTo(threshold_tile);
+
+        // Per-tile component moments, merged below
+        ComponentTile &components = component_tiles_[t];
+        components.row_offset = tile.start;
+        cv::connectedComponentsWithStats(threshold_tile,
+                                         components.labels,
+                                         components.stats,
+                                         components.centroids,
+                                         8,
+                                         CV_32S);
+    });
+
+    // Form the HSV frame that will be shown in the tuning window. This
+    // cannot be done above because neighboring tiles read each other's rows.
+    if (tuning_on_) {
+        tile_pool_->parallelFor(num_tiles, [&](int t) {
+
+            const cv::Range tile = tileRowRange(t, num_tiles, rows);
+            const int start = std::max(tile.start - halo, 0);
+            cv::Mat frame_tile = frame.rowRange(tile);
+            tile_hsv_frames_[t].rowRange(tile.start - start, tile.end - start)
+                .copyTo(frame_tile);
+        });
+
+        frame.setTo(0, threshold_frame_ == 0);
+    }
+
+    findComponentBlobs(component_tiles_, blobs_, max_candidates_,
+                       min_object_area_, max_object_area_);
+    selectLargest(position, object_area_);
 }
 
 void HSVDetector::configure(const std::string &config_file,
@@ -93,7 +241,11 @@ void HSVDetector::configure(const std::string &config_file,
                                       "h_thresholds",
                                       "s_thresholds",
                                       "v_thresholds",
+                                      "downsample",
+                                      "tiles",
                                       "tune" };
+    options.insert(options.end(), keyframe_options.begin(), keyframe_options.end());
+    options.insert(options.end(), candidate_options.begin(), candidate_options.end());
 
     // This will throw cpptoml::parse_exception if a file
     // with invalid TOML is provided
@@ -158,6 +310,36 @@ void HSVDetector::configure(const std::string &config_file,
             v_max_ = val;
         }
 
+        // Downsampling factor for coarse-to-fine detection
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "downsample", val, (int64_t)1)) {
+                if (val != 1 && val != 2 && val != 4 && val != 8)
+                    throw (std::runtime_error(oat::configValueError(
+                        "downsample", config_key, config_file, "must be 1, 2, 4, or 8.")));
+                set_downsample(val);
+            }
+        }
+
+        // Number of horizontal tiles for parallel detection
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "tiles", val, (int64_t)1))
+                set_num_tiles(val);
+        }
+
+        // Keyframe detection and tracking
+        configureKeyframes(this_config);
+
+        // Number of candidate positions to publish
+        configureCandidates(this_config, config_key, config_file);
+
+        // Candidates are not found by coarse-to-fine detection
+        if (max_candidates_ > 1 && downsample_ > 1)
+            throw (std::runtime_error(oat::configValueError(
+                "max_candidates", config_key, config_file,
+                "must be 1 when downsample is greater than 1.")));
+
         // Tuning
         oat::config::getValue(this_config, "tune", tuning_on_);
 
@@ -173,6 +355,10 @@ void HSVDetector::tune(cv::Mat &frame, const oat::Position2D &position) {
     
     std::string msg = cv::format("Object not found");
 
+    // Plot the full resolution refinement window
+    if (refine_window_.area() > 0)
+        cv::rectangle(frame, refine_window_, cv::Scalar(255, 0, 0), 2);
+
     // Plot a circle representing found object
     if (position.position_valid) {
         auto radius = std::sqrt(object_area_ / PI);
@@ -235,6 +421,7 @@ void HSVDetector::set_erode_size(int value) {
         erode_on_ = true;
         erode_px_ = value;
         erode_element_ = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(erode_px_, erode_px_));
+        createCoarseElements();
     } else {
         erode_on_ = false;
     }
@@ -245,11 +432,29 @@ void HSVDetector::set_dilate_size(int value) {
         dilate_on_ = true;
         dilate_px_ = value;
         dilate_element_ = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(dilate_px_, dilate_px_));
+        createCoarseElements();
     } else {
         dilate_on_ = false;
     }
 }
 
+void HSVDetector::set_downsample(int factor) {
+
+    downsample_ = factor;
+    createCoarseElements();
+}
+
+void HSVDetector::createCoarseElements() {
+
+    // Erode and dilate kernels, scaled to the downsampled frame
+    int erode_px = std::max(erode_px_ / downsample_, 1);
+    int dilate_px = std::max(dilate_px_ / downsample_, 1);
+    coarse_erode_element_ =
+        cv::getStructuringElement(cv::MORPH_RECT, cv::Size(erode_px, erode_px));
+    coarse_dilate_element_ =
+        cv::getStructuringElement(cv::MORPH_RECT, cv::Size(dilate_px, dilate_px));
+}
+
 // Non-member GUI callback functions
 void hsvDetectorMinAreaSliderChangedCallback(int value, void * object) {
     auto hsv_detector = static_cast<HSVDetector *>(object);
@@ -24,6 +24,7 @@
 
 #include <string>
 #include <limits>
+#include <vector>
 #include <opencv2/core/mat.hpp>
 #ifdef NOIMP_OAT_USE_CUDA
 #include <opencv2/cudaarithm.hpp>
@@ -31,6 +32,7 @@
 #include <opencv2/cudaimgproc.hpp>
 #endif
 
+#include "DetectorFunc.h"
 #include "PositionDetector.h"
 
 namespace oat {
@@ -66,6 +68,7 @@ public:
     void set_dilate_size(int dilate_px);
     void set_min_object_area(double value) { min_object_area_ = value; }
     void set_max_object_area(double value) { max_object_area_ = value; }
+    void set_downsample(int factor);
 
 private:
 
@@ -76,6 +79,18 @@ private:
     // Internal matricies
     cv::Mat threshold_frame_, erode_element_, dilate_element_;
 
+    // Coarse-to-fine detection. If downsample_ > 1, detection is performed
+    // on a downsampled frame and then refined at full resolution within a
+    // window surrounding the coarse detection.
+    int downsample_ {1};
+    cv::Mat coarse_frame_, refine_threshold_frame_;
+    cv::Mat coarse_erode_element_, coarse_dilate_element_;
+    cv::Rect refine_window_;
+
+    // Tile-parallel detection buffers, one per tile
+    std::vector<cv::Mat> tile_hsv_frames_, tile_threshold_frames_;
+    std::vector<oat::ComponentTile> component_tiles_;
+
     // HSV threshold values
     int h_min_ {0}, h_max_ {256};
     int s_min_ {0}, s_max_ {256};
@@ -87,6 +102,14 @@ private:
     double min_object_area_ {0.0};
     double max_object_area_ {std::numeric_limits<double>::max()};
 
+    // Processing functions
+    void applyThreshold(cv::Mat &frame, cv::Mat &threshold_frame,
+                        const cv::Mat &erode_element,
+                        const cv::Mat &dilate_element);
+    void detectCoarseToFine(cv::Mat &frame, oat::Position2D &position);
+    void detectTiled(cv::Mat &frame, oat::Position2D &position);
+    void createCoarseElements(void);
+
     // Parameter tuning GUI functions and properties
     const std::string tuning_image_title_;
     void tune(cv::Mat &frame, const oat::Position2D &position);
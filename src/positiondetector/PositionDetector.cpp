@@ -19,16 +19,31 @@
 
 #include <string>
 #include <opencv2/core/mat.hpp>
+#include <cpptoml.h>
 
 #include "../../lib/datatypes/Position2D.h"
 #include "../../lib/shmemdf/Source.h"
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/SharedFrameHeader.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/make_unique.h"
+#include "../../lib/utility/TOMLSanitize.h"
 
 #include "PositionDetector.h"
 
 namespace oat {
 
+const std::vector<std::string> PositionDetector::keyframe_options {
+    "keyframe_interval",
+    "track_template",
+    "track_search",
+    "track_min_score"
+};
+
+const std::vector<std::string> PositionDetector::candidate_options {
+    "max_candidates"
+};
+
 PositionDetector::PositionDetector(const std::string &frame_source_address,
                                    const std::string &position_sink_address) :
   name_("posidet[" + frame_source_address + "->" + position_sink_address + "]")
@@ -46,9 +61,131 @@ void PositionDetector::connectToNode() {
     // Wait for synchronous start with sink when it binds the node
     frame_source_.connect();
 
-    // Bind to sink node and create a shared position
-    position_sink_.bind(position_sink_address_, position_sink_address_);
-    shared_position_ = position_sink_.retrieve();
+    // Bind to a sink node per candidate and create shared positions
+    for (const auto &addr : sink_addresses()) {
+
+        position_sinks_.push_back(std::make_unique<oat::Sink<oat::Position2D>>());
+        position_sinks_.back()->bind(addr);
+        shared_positions_.push_back(position_sinks_.back()->retrieve());
+    }
+
+    candidates_.resize(max_candidates_ - 1);
+}
+
+std::vector<std::string> PositionDetector::sink_addresses() const {
+
+    if (max_candidates_ == 1)
+        return {position_sink_address_};
+
+    std::vector<std::string> addrs;
+    for (size_t i = 0; i < max_candidates_; i++)
+        addrs.push_back(position_sink_address_ + "_" + std::to_string(i));
+
+    return addrs;
+}
+
+void PositionDetector::set_num_tiles(const int value) {
+
+    num_tiles_ = value > 1 ? value : 1;
+
+    // The calling thread processes one of the tiles
+    if (num_tiles_ > 1)
+        tile_pool_ = std::make_unique<oat::ThreadPool>(num_tiles_ - 1);
+    else
+        tile_pool_.reset();
+}
+
+void PositionDetector::configureKeyframes(const std::shared_ptr<cpptoml::table> &table) {
+
+    // Keyframe interval
+    {
+        int64_t val;
+        if (oat::config::getValue(table, "keyframe_interval", val, (int64_t)1))
+            keyframe_interval_ = val;
+    }
+
+    // Tracker template size
+    {
+        int64_t val;
+        if (oat::config::getValue(table, "track_template", val, (int64_t)3))
+            track_template_size_ = val;
+    }
+
+    // Tracker search radius
+    {
+        int64_t val;
+        if (oat::config::getValue(table, "track_search", val, (int64_t)1))
+            track_search_radius_ = val;
+    }
+
+    // Minimum tracking score
+    oat::config::getValue(table, "track_min_score", track_min_score_, -1.0, 1.0);
+}
+
+void PositionDetector::configureCandidates(const std::shared_ptr<cpptoml::table> &table,
+                                           const std::string &config_key,
+                                           const std::string &config_file) {
+
+    int64_t val;
+    if (!oat::config::getValue(table, "max_candidates", val, (int64_t)1))
+        return;
+
+    // The template tracker follows a single object between keyframes
+    if (val > 1 && keyframe_interval_ > 1)
+        throw (std::runtime_error(oat::configValueError(
+            "max_candidates", config_key, config_file,
+            "must be 1 when keyframe_interval is greater than 1.")));
+
+    max_candidates_ = val;
+}
+
+void PositionDetector::selectLargest(oat::Position2D &position, double &area) const {
+
+    position.position_valid = !blobs_.empty();
+    area = 0;
+
+    if (blobs_.empty())
+        return;
+
+    position.position = blobs_[0].centroid;
+    area = blobs_[0].area;
+}
+
+void PositionDetector::detectOrTrack(cv::Mat &frame, oat::Position2D &position) {
+
+    if (keyframe_interval_ <= 1) {
+        detectPosition(frame, position);
+        return;
+    }
+
+    if (tracker_ == nullptr)
+        tracker_ = std::make_unique<oat::TemplateTracker>(
+            track_template_size_, track_search_radius_, track_min_score_);
+
+    // Follow the object between keyframes
+    if (frames_since_keyframe_ < keyframe_interval_ - 1 && tracker_->template_valid()) {
+
+        cv::Point2d tracked;
+        if (tracker_->track(frame, tracked)) {
+            position.position = tracked;
+            position.position_valid = true;
+            frames_since_keyframe_++;
+            return;
+        }
+
+        // Tracking confidence dropped, so fall through to full detection
+    }
+
+    // Detectors may modify the frame in place, so keep a copy to take the
+    // tracker's template from
+    frame.copyTo(keyframe_);
+    detectPosition(frame, position);
+    frames_since_keyframe_ = 0;
+
+    if (position.position_valid)
+        tracker_->setTemplate(keyframe_, position.position);
+    else
+        tracker_->reset();
 }
 
 bool PositionDetector::process() {
@@ -71,21 +208,35 @@ bool PositionDetector::process() {
 
     // Propagate sample info and detect position
     internal_position_.sample() = internal_frame_.sample_copy();
-    detectPosition(internal_frame_, internal_position_);
+    detectOrTrack(internal_frame_, internal_position_);
 
-    // START CRITICAL SECTION //
-    ////////////////////////////
+    // The remaining candidates, largest first. Detectors fill blobs_ with at
+    // most max_candidates_ objects, the first of which is internal_position_.
+    for (size_t i = 0; i < candidates_.size(); i++) {
 
-    // Wait for sources to read
-    position_sink_.wait();
+        oat::Position2D &candidate = candidates_[i];
+        candidate = internal_position_;
+        candidate.position_valid = i + 1 < blobs_.size();
+        if (candidate.position_valid)
+            candidate.position = blobs_[i + 1].centroid;
+    }
 
-    *shared_position_ = internal_position_;
+    for (size_t i = 0; i < position_sinks_.size(); i++) {
 
-    // Tell sources there is new data
-    position_sink_.post();
+        // START CRITICAL SECTION //
+        ////////////////////////////
 
-    ////////////////////////////
-    //  END CRITICAL SECTION  //
+        // Wait for sources to read
+        position_sinks_[i]->wait();
+
+        *shared_positions_[i] = i == 0 ? internal_position_ : candidates_[i - 1];
+
+        // Tell sources there is new data
+        position_sinks_[i]->post();
+
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+    }
 
     // Sink was not at END state
     return false;
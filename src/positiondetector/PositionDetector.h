@@ -20,13 +20,22 @@
 #ifndef OAT_POSITIONDETECTOR_H
 #define	OAT_POSITIONDETECTOR_H
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "../../lib/datatypes/Frame.h"
 #include "../../lib/datatypes/Position2D.h"
 #include "../../lib/shmemdf/Source.h"
 #include "../../lib/shmemdf/Sink.h"
 
+#include "DetectorFunc.h"
+#include "TemplateTracker.h"
+#include "ThreadPool.h"
+
+// Forward decl.
+namespace cpptoml { class table; }
+
 namespace oat {
 
 // Forward decl.
@@ -73,7 +82,9 @@ public:
 
     // Accessors
     std::string name(void) const { return name_; }
+    std::vector<std::string> sink_addresses(void) const;
     void tuning_on(const bool value)  { tuning_on_ = value; }
+    void set_num_tiles(const int value);
 
 protected:
 
@@ -83,7 +94,38 @@ protected:
      * @param position Detected object position.
      */
     virtual void detectPosition(cv::Mat &frame, oat::Position2D &position) = 0;
-    
+
+    /**
+     * Read keyframe detection options, which are common to all detector
+     * types, from a detector's configuration table.
+     * @param table Detector configuration table
+     */
+    void configureKeyframes(const std::shared_ptr<cpptoml::table> &table);
+
+    /**
+     * Read the number of candidate positions to publish, which is common to
+     * all detector types, from a detector's configuration table. Must be
+     * called after configureKeyframes().
+     * @param table Detector configuration table
+     * @param config_key Configuration key, for error messages
+     * @param config_file Configuration file, for error messages
+     */
+    void configureCandidates(const std::shared_ptr<cpptoml::table> &table,
+                             const std::string &config_key,
+                             const std::string &config_file);
+
+    /**
+     * Set a position, and the area of the detected object, from the largest
+     * of the candidates in blobs_.
+     * @param position Detected object position.
+     * @param area Detected object area.
+     */
+    void selectLargest(oat::Position2D &position, double &area) const;
+
+    // Keyframe detection and candidate configuration keys
+    static const std::vector<std::string> keyframe_options;
+    static const std::vector<std::string> candidate_options;
+
     // Detector name
     const std::string name_;
 
@@ -91,20 +133,54 @@ protected:
     bool tuning_on_ {false};
     bool tuning_windows_created_ {false};
 
+    // Tile-parallel detection. If num_tiles_ > 1, frames are split into
+    // horizontal tiles that are processed by tile_pool_ and the calling thread.
+    int num_tiles_ {1};
+    std::unique_ptr<oat::ThreadPool> tile_pool_;
+
+    // Number of candidate positions to publish. If greater than 1, detectors
+    // find up to this many objects, largest first, and store them in blobs_.
+    size_t max_candidates_ {1};
+    std::vector<oat::Blob> blobs_;
+
 private:
 
+    /**
+     * Run full detection on keyframes, which occur every keyframe_interval_
+     * frames or when tracking fails. Follow the object using the template
+     * tracker otherwise.
+     * @param Frame to look for object within.
+     * @param position Detected object position.
+     */
+    void detectOrTrack(cv::Mat &frame, oat::Position2D &position);
+
+    // Keyframe detection. If keyframe_interval_ > 1, full detection is only
+    // performed on every keyframe_interval_'th frame and tracker_ is used in
+    // between.
+    int keyframe_interval_ {1};
+    int frames_since_keyframe_ {0};
+    int track_template_size_ {31};
+    int track_search_radius_ {20};
+    double track_min_score_ {0.8};
+    std::unique_ptr<oat::TemplateTracker> tracker_;
+    cv::Mat keyframe_;
+
+
     // Current frame
     oat::Frame internal_frame_;
-    oat::Position2D internal_position_ {"internal"};
-    oat::Position2D * shared_position_;
+    oat::Position2D internal_position_;
+
+    // Candidate positions, largest first. The first is internal_position_.
+    std::vector<oat::Position2D> candidates_;
 
     // Frame source
     const std::string frame_source_address_;
     oat::Source<oat::SharedFrameHeader> frame_source_;
 
-    // Position sink
+    // Position sinks, one per candidate
     const std::string position_sink_address_;
-    oat::Sink<oat::Position2D> position_sink_;
+    std::vector<oat::Position2D *> shared_positions_;
+    std::vector<std::unique_ptr<oat::Sink<oat::Position2D>>> position_sinks_;
 
 };
 
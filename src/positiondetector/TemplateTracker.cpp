@@ -0,0 +1,135 @@
+//******************************************************************************
+//* File:   TemplateTracker.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#include <cmath>
+#include <opencv2/imgproc.hpp>
+
+#include "TemplateTracker.h"
+
+namespace oat {
+
+TemplateTracker::TemplateTracker(const int template_size,
+                                 const int search_radius,
+                                 const double min_score) :
+  half_size_(template_size / 2)
+, search_radius_(search_radius)
+, min_score_(min_score)
+{
+    // Nothing
+}
+
+bool TemplateTracker::setTemplate(const cv::Mat &frame,
+                                  const cv::Point2d &position) {
+
+    const cv::Point center(cvRound(position.x), cvRound(position.y));
+    const cv::Rect roi(center.x - half_size_,
+                       center.y - half_size_,
+                       2 * half_size_ + 1,
+                       2 * half_size_ + 1);
+
+    // Template must lie entirely within the frame
+    template_valid_ = (roi & cv::Rect(cv::Point(0, 0), frame.size())) == roi;
+    if (!template_valid_)
+        return false;
+
+    toGrey(frame(roi), template_);
+    last_position_ = position;
+    displacement_ = cv::Point2d(0, 0);
+    score_ = 1.0;
+
+    return true;
+}
+
+bool TemplateTracker::track(const cv::Mat &frame, cv::Point2d &position) {
+
+    if (!template_valid_)
+        return false;
+
+    // Search around the position predicted from the last displacement
+    const cv::Point2d predicted = last_position_ + displacement_;
+    const int reach = half_size_ + search_radius_;
+    const cv::Rect window = cv::Rect(cvRound(predicted.x) - reach,
+                                     cvRound(predicted.y) - reach,
+                                     2 * reach + 1,
+                                     2 * reach + 1)
+                            & cv::Rect(cv::Point(0, 0), frame.size());
+
+    if (window.width < template_.cols || window.height < template_.rows) {
+        template_valid_ = false;
+        return false;
+    }
+
+    // Only the search window is converted to grey-scale
+    toGrey(frame(window), search_grey_);
+    cv::matchTemplate(search_grey_, template_, response_, cv::TM_CCOEFF_NORMED);
+
+    double max_val;
+    cv::Point max_loc;
+    cv::minMaxLoc(response_, nullptr, &max_val, nullptr, &max_loc);
+    score_ = max_val;
+
+    if (!(score_ >= min_score_)) {
+        template_valid_ = false;
+        return false;
+    }
+
+    // Sub-pixel peak location using a parabolic fit in each dimension
+    cv::Point2d peak(max_loc.x, max_loc.y);
+    if (max_loc.x > 0 && max_loc.x < response_.cols - 1) {
+        const float l = response_.at<float>(max_loc.y, max_loc.x - 1);
+        const float c = response_.at<float>(max_loc.y, max_loc.x);
+        const float r = response_.at<float>(max_loc.y, max_loc.x + 1);
+        const float d = l - 2 * c + r;
+        if (d < 0)
+            peak.x += 0.5 * (l - r) / d;
+    }
+    if (max_loc.y > 0 && max_loc.y < response_.rows - 1) {
+        const float u = response_.at<float>(max_loc.y - 1, max_loc.x);
+        const float c = response_.at<float>(max_loc.y, max_loc.x);
+        const float b = response_.at<float>(max_loc.y + 1, max_loc.x);
+        const float d = u - 2 * c + b;
+        if (d < 0)
+            peak.y += 0.5 * (u - b) / d;
+    }
+
+    position.x = window.x + peak.x + half_size_;
+    position.y = window.y + peak.y + half_size_;
+
+    displacement_ = position - last_position_;
+    last_position_ = position;
+
+    return true;
+}
+
+void TemplateTracker::toGrey(const cv::Mat &in, cv::Mat &out) {
+
+    switch (in.channels()) {
+        case 1:
+            in.copyTo(out);
+            break;
+        case 4:
+            cv::cvtColor(in, out, cv::COLOR_BGRA2GRAY);
+            break;
+        default:
+            cv::cvtColor(in, out, cv::COLOR_BGR2GRAY);
+            break;
+    }
+}
+
+} /* namespace oat */
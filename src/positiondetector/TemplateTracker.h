@@ -0,0 +1,96 @@
+//******************************************************************************
+//* File:   TemplateTracker.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#ifndef OAT_TEMPLATETRACKER_H
+#define OAT_TEMPLATETRACKER_H
+
+#include <opencv2/core/mat.hpp>
+
+namespace oat {
+
+/**
+ * Lightweight object tracker used between full detections. A grey-scale
+ * template is taken from around a detected position and located in
+ * subsequent frames using normalized cross-correlation within a small search
+ * window surrounding the predicted position.
+ */
+class TemplateTracker {
+public:
+
+    /**
+     * Lightweight template-matching object tracker.
+     * @param template_size Side length of the square template (pixels)
+     * @param search_radius Maximum displacement from the predicted position
+     * that is searched in each frame (pixels)
+     * @param min_score Minimum normalized correlation coefficient
+     * (TM_CCOEFF_NORMED), in [-1 1], required for a track to be considered
+     * valid
+     */
+    TemplateTracker(const int template_size,
+                    const int search_radius,
+                    const double min_score);
+
+    /**
+     * Take a new template centered on a detected position.
+     * @param frame Frame containing the object
+     * @param position Object position within the frame
+     * @return True if the template was fully contained within the frame
+     */
+    bool setTemplate(const cv::Mat &frame, const cv::Point2d &position);
+
+    /**
+     * Locate the template in a new frame.
+     * @param frame Frame to search
+     * @param position Tracked position if successful
+     * @return True if the template was found with sufficient confidence. If
+     * false, the template is discarded and a new one must be set.
+     */
+    bool track(const cv::Mat &frame, cv::Point2d &position);
+
+    /**
+     * Discard the current template.
+     */
+    void reset(void) { template_valid_ = false; }
+
+    // Accessors
+    bool template_valid(void) const { return template_valid_; }
+    double score(void) const { return score_; }
+
+private:
+
+    // Parameters
+    const int half_size_;
+    const int search_radius_;
+    const double min_score_;
+
+    // Current template, and the position and displacement of the last track
+    cv::Mat template_;
+    bool template_valid_ {false};
+    cv::Point2d last_position_;
+    cv::Point2d displacement_;
+    double score_ {0.0};
+
+    // Intermediate variables
+    cv::Mat search_grey_, response_;
+
+    void toGrey(const cv::Mat &in, cv::Mat &out);
+};
+
+}      /* namespace oat */
+#endif /* OAT_TEMPLATETRACKER_H */
@@ -0,0 +1,125 @@
+//******************************************************************************
+//* File:   ThreadPool.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#include "ThreadPool.h"
+
+namespace oat {
+
+ThreadPool::ThreadPool(const size_t num_threads)
+{
+    workers_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; i++)
+        workers_.emplace_back( [this] { workLoop(); } );
+}
+
+ThreadPool::~ThreadPool() {
+
+    // Set running to false to trigger thread join
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        running_ = false;
+    }
+    work_cv_.notify_all();
+
+    for (auto &w : workers_)
+        w.join();
+}
+
+void ThreadPool::parallelFor(const int num_tasks,
+                             const std::function<void(int)> &task) {
+
+    if (num_tasks <= 0)
+        return;
+
+    // Publish the new task set
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        task_ = &task;
+        num_tasks_ = num_tasks;
+        next_task_ = 0;
+        tasks_remaining_ = num_tasks;
+        error_ = nullptr;
+        generation_++;
+    }
+    work_cv_.notify_all();
+
+    // Calling thread does its share of the work
+    runTasks();
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lk(mutex_);
+        done_cv_.wait(lk, [this] { return tasks_remaining_ == 0; });
+        task_ = nullptr;
+        error = error_;
+        error_ = nullptr;
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void ThreadPool::workLoop() {
+
+    uint64_t generation = 0;
+    std::unique_lock<std::mutex> lk(mutex_);
+
+    while (true) {
+
+        work_cv_.wait(lk, [this, &generation] {
+            return !running_ || generation_ != generation;
+        });
+
+        if (!running_)
+            return;
+
+        generation = generation_;
+
+        lk.unlock();
+        runTasks();
+        lk.lock();
+    }
+}
+
+void ThreadPool::runTasks() {
+
+    std::unique_lock<std::mutex> lk(mutex_);
+
+    while (task_ != nullptr && next_task_ < num_tasks_) {
+
+        const int i = next_task_++;
+        const std::function<void(int)> *task = task_;
+
+        lk.unlock();
+        try {
+            (*task)(i);
+        } catch (...) {
+            lk.lock();
+            if (!error_)
+                error_ = std::current_exception();
+            lk.unlock();
+        }
+        lk.lock();
+
+        if (--tasks_remaining_ == 0)
+            done_cv_.notify_all();
+    }
+}
+
+} /* namespace oat */
@@ -0,0 +1,89 @@
+//******************************************************************************
+//* File:   ThreadPool.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#ifndef OAT_THREADPOOL_H
+#define OAT_THREADPOOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace oat {
+
+/**
+ * Persistent pool of worker threads used to process independent tasks (e.g.
+ * frame tiles) in parallel without creating threads for each frame.
+ */
+class ThreadPool {
+public:
+
+    /**
+     * Persistent pool of worker threads.
+     * @param num_threads Number of worker threads. The thread that calls
+     * parallelFor() also executes tasks, so this can be one less than the
+     * desired concurrency.
+     */
+    explicit ThreadPool(const size_t num_threads);
+
+    ~ThreadPool();
+
+    // Pool owns threads
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * Execute task(i) for i in [0, num_tasks) and block until all tasks are
+     * complete. If a task throws, the first exception is rethrown here after
+     * all tasks have finished.
+     * @param num_tasks Number of tasks
+     * @param task Task function. Must be safe to call concurrently.
+     */
+    void parallelFor(const int num_tasks, const std::function<void(int)> &task);
+
+    size_t size(void) const { return workers_.size(); }
+
+private:
+
+    std::vector<std::thread> workers_;
+
+    // Current task set. Guarded by mutex_.
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    const std::function<void(int)> *task_ {nullptr};
+    int num_tasks_ {0};
+    int next_task_ {0};
+    int tasks_remaining_ {0};
+    uint64_t generation_ {0};
+    std::exception_ptr error_;
+    bool running_ {true};
+
+    // Executed by worker threads
+    void workLoop(void);
+
+    // Claim and run tasks from the current task set until none remain
+    void runTasks(void);
+};
+
+}      /* namespace oat */
+#endif /* OAT_THREADPOOL_H */
@@ -237,10 +237,14 @@ int main(int argc, char *argv[]) {
 
         // Tell user
         std::cout << oat::whoMessage(detector->name(),
-                "Listening to source " + oat::sourceText(source) + ".\n")
-                << oat::whoMessage(detector->name(),
-                "Steaming to sink " + oat::sinkText(sink) + ".\n")
-                << oat::whoMessage(detector->name(),
+                "Listening to source " + oat::sourceText(source) + ".\n");
+
+        std::cout << oat::whoMessage(detector->name(), "Steaming to sinks ");
+        for (auto s : detector->sink_addresses())
+            std::cout << oat::sinkText(s) << " ";
+        std::cout << ".\n";
+
+        std::cout << oat::whoMessage(detector->name(),
                 "Press CTRL+C to exit.\n");
 
         // Infinite loop until ctrl-c or end of stream signal
@@ -0,0 +1,167 @@
+//******************************************************************************
+//* File:   Assignment.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "Assignment.h"
+
+namespace oat {
+
+void Assignment::solve(const std::vector<double> &cost,
+                       const int rows,
+                       const int cols,
+                       const double gate,
+                       const Method method,
+                       std::vector<int> &row_to_col) {
+
+    row_to_col.assign(rows, -1);
+    if (rows == 0 || cols == 0)
+        return;
+
+    switch (method) {
+        case Method::GREEDY:
+            solveGreedy(cost, rows, cols, gate, row_to_col);
+            break;
+        case Method::HUNGARIAN:
+            solveHungarian(cost, rows, cols, gate, row_to_col);
+            break;
+    }
+}
+
+void Assignment::solveGreedy(const std::vector<double> &cost,
+                             const int rows,
+                             const int cols,
+                             const double gate,
+                             std::vector<int> &row_to_col) {
+
+    // Candidate pairs within the gate, cheapest first
+    order_.clear();
+    for (int i = 0; i < rows * cols; i++)
+        if (cost[i] <= gate)
+            order_.push_back(i);
+
+    std::sort(order_.begin(), order_.end(),
+              [&cost](int a, int b) { return cost[a] < cost[b]; });
+
+    col_used_.assign(cols, false);
+    for (const auto i : order_) {
+        const int r = i / cols;
+        const int c = i % cols;
+        if (row_to_col[r] < 0 && !col_used_[c]) {
+            row_to_col[r] = c;
+            col_used_[c] = true;
+        }
+    }
+}
+
+void Assignment::solveHungarian(const std::vector<double> &cost,
+                                const int rows,
+                                const int cols,
+                                const double gate,
+                                std::vector<int> &row_to_col) {
+
+    // Shortest augmenting path formulation with row and column potentials,
+    // O(n^2 m) for n <= m. Transpose so that there are no more rows than
+    // columns. Gated pairs are given a cost that exceeds any admissible
+    // assignment so they are only used when nothing else is available, and
+    // are removed afterward.
+    const bool transpose = rows > cols;
+    const int n = transpose ? cols : rows;
+    const int m = transpose ? rows : cols;
+
+    double max_cost = 0.0;
+    for (int i = 0; i < rows * cols; i++)
+        if (cost[i] <= gate)
+            max_cost = std::max(max_cost, cost[i]);
+    const double blocked = (max_cost + 1.0) * (n + 1);
+
+    auto c = [&](int i, int j) {
+        const double x = transpose ? cost[j * cols + i] : cost[i * cols + j];
+        return x <= gate ? x : blocked;
+    };
+
+    const double inf = std::numeric_limits<double>::infinity();
+    u_.assign(n + 1, 0.0);
+    v_.assign(m + 1, 0.0);
+    p_.assign(m + 1, 0);
+    way_.assign(m + 1, 0);
+
+    for (int i = 1; i <= n; i++) {
+
+        p_[0] = i;
+        int j0 = 0;
+        min_v_.assign(m + 1, inf);
+        col_used_.assign(m + 1, false);
+
+        do {
+            col_used_[j0] = true;
+            const int i0 = p_[j0];
+            double delta = inf;
+            int j1 = 0;
+
+            for (int j = 1; j <= m; j++) {
+                if (!col_used_[j]) {
+                    const double cur = c(i0 - 1, j - 1) - u_[i0] - v_[j];
+                    if (cur < min_v_[j]) {
+                        min_v_[j] = cur;
+                        way_[j] = j0;
+                    }
+                    if (min_v_[j] < delta) {
+                        delta = min_v_[j];
+                        j1 = j;
+                    }
+                }
+            }
+
+            for (int j = 0; j <= m; j++) {
+                if (col_used_[j]) {
+                    u_[p_[j]] += delta;
+                    v_[j] -= delta;
+                } else {
+                    min_v_[j] -= delta;
+                }
+            }
+
+            j0 = j1;
+
+        } while (p_[j0] != 0);
+
+        // Augment along the alternating path
+        do {
+            const int j1 = way_[j0];
+            p_[j0] = p_[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+
+    for (int j = 1; j <= m; j++) {
+        if (p_[j] == 0)
+            continue;
+
+        const int r = transpose ? j - 1 : p_[j] - 1;
+        const int col = transpose ? p_[j] - 1 : j - 1;
+        if (cost[r * cols + col] <= gate)
+            row_to_col[r] = col;
+    }
+}
+
+} /* namespace oat */
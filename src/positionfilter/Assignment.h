@@ -0,0 +1,80 @@
+//******************************************************************************
+//* File:   Assignment.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_ASSIGNMENT_H
+#define	OAT_ASSIGNMENT_H
+
+#include <vector>
+
+namespace oat {
+
+/**
+ * Solver for the linear assignment problem between the rows (e.g. tracks) and
+ * columns (e.g. detections) of a cost matrix. Pairs whose cost exceeds a gate
+ * are never assigned. Working storage is retained between calls so that
+ * repeated solves of similarly sized problems do not allocate.
+ */
+class Assignment {
+
+public:
+
+    enum class Method {
+        GREEDY = 0, //!< Gated nearest neighbor, in order of increasing cost
+        HUNGARIAN   //!< Minimum total cost (Kuhn-Munkres)
+    };
+
+    /**
+     * Assign rows to columns.
+     * @param cost Row-major, rows x cols cost matrix
+     * @param rows Number of rows
+     * @param cols Number of columns
+     * @param gate Maximum cost of an assigned pair
+     * @param method Assignment method
+     * @param row_to_col Output. Column assigned to each row, or -1.
+     */
+    void solve(const std::vector<double> &cost,
+               const int rows,
+               const int cols,
+               const double gate,
+               const Method method,
+               std::vector<int> &row_to_col);
+
+private:
+
+    void solveGreedy(const std::vector<double> &cost,
+                     const int rows,
+                     const int cols,
+                     const double gate,
+                     std::vector<int> &row_to_col);
+
+    void solveHungarian(const std::vector<double> &cost,
+                        const int rows,
+                        const int cols,
+                        const double gate,
+                        std::vector<int> &row_to_col);
+
+    // Working storage
+    std::vector<int> order_;
+    std::vector<bool> col_used_;
+    std::vector<double> u_, v_, min_v_;
+    std::vector<int> p_, way_;
+};
+
+}      /* namespace oat */
+#endif	/* OAT_ASSIGNMENT_H */
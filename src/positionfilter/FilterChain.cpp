@@ -0,0 +1,127 @@
+//******************************************************************************
+//* File:   FilterChain.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#include <string>
+#include <cpptoml.h>
+
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/TOMLSanitize.h"
+#include "../../lib/utility/make_unique.h"
+
+#include "FilterChain.h"
+#include "HomographyTransform2D.h"
+#include "KalmanFilter2D.h"
+#include "LatencyPredictor2D.h"
+#include "RegionFilter2D.h"
+
+namespace oat {
+
+FilterChain::FilterChain(const std::string &position_source_address,
+                         const std::string &position_sink_address) :
+  PositionFilter(position_source_address, position_sink_address)
+, position_source_address_(position_source_address)
+, position_sink_address_(position_sink_address)
+{
+    // Nothing
+}
+
+void FilterChain::configure(const std::string &config_file,
+                            const std::string &config_key) {
+
+    // Available options
+    std::vector<std::string> options {"filters"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a camera configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Filter stages, each specified as [TYPE, KEY] where KEY is a
+        // configuration table in the same file
+        oat::config::Array filter_array;
+        oat::config::getArray(this_config, "filters", filter_array, true);
+
+        const std::string stage_error =
+            "must be a nested, Nx2 TOML array of strings to specify a "
+            "[TYPE, KEY] pair for each filter";
+
+        stages_.clear();
+        for (const auto &s : filter_array->nested_array()) {
+
+            if (s == nullptr)
+                throw std::runtime_error(oat::configValueError(
+                    "filters", config_key, config_file, stage_error));
+
+            auto stage = s->array_of<std::string>();
+            if (stage.size() != 2 || !stage[0] || !stage[1]) {
+                throw std::runtime_error(oat::configValueError(
+                    "filters", config_key, config_file, stage_error));
+            }
+
+            const std::string type = stage[0]->get();
+            const std::string key = stage[1]->get();
+
+            std::unique_ptr<oat::PositionFilter> f;
+            if (type == "kalman") {
+                f = std::make_unique<oat::KalmanFilter2D>(
+                        position_source_address_, position_sink_address_);
+            } else if (type == "homography") {
+                f = std::make_unique<oat::HomographyTransform2D>(
+                        position_source_address_, position_sink_address_);
+            } else if (type == "region") {
+                f = std::make_unique<oat::RegionFilter2D>(
+                        position_source_address_, position_sink_address_);
+            } else if (type == "predict") {
+                f = std::make_unique<oat::LatencyPredictor2D>(
+                        position_source_address_, position_sink_address_);
+            } else {
+                throw std::runtime_error(oat::configValueError(
+                    "filters", config_key, config_file,
+                    "contains unknown filter TYPE '" + type + "'"));
+            }
+
+            f->configure(config_file, key);
+            stages_.push_back(std::move(f));
+        }
+
+        if (stages_.empty()) {
+            throw std::runtime_error(oat::configValueError(
+                "filters", config_key, config_file, stage_error));
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+void FilterChain::filter(oat::Position2D &position) {
+
+    for (auto &s : stages_)
+        s->filter(position);
+}
+
+} /* namespace oat */
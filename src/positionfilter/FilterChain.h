@@ -0,0 +1,68 @@
+//******************************************************************************
+//* File:   FilterChain.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#ifndef OAT_FILTERCHAIN_H
+#define	OAT_FILTERCHAIN_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "PositionFilter.h"
+
+namespace oat {
+
+/**
+ * An ordered chain of position filters applied within a single component.
+ */
+class FilterChain : public PositionFilter {
+public:
+
+    /**
+     * An ordered chain of position filters.
+     * Each position is passed through all filters in the chain, in order,
+     * before being published. This avoids the shared memory hop between
+     * separate position filter components.
+     * @param position_source_address Un-filtered position SOURCE name
+     * @param position_sink_address Filtered position SINK name
+     */
+    FilterChain(const std::string &position_source_address,
+                const std::string &position_sink_address);
+
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+
+private:
+
+    // Addresses, passed to the filter stages which do not connect to them
+    const std::string position_source_address_;
+    const std::string position_sink_address_;
+
+    // Filter stages, in order of application
+    std::vector<std::unique_ptr<oat::PositionFilter>> stages_;
+
+    /**
+     * Apply each filter in the chain.
+     * @param position Position to be filtered
+     */
+    void filter(oat::Position2D &position) override;
+};
+
+}      /* namespace oat */
+#endif	/* OAT_FILTERCHAIN_H */
@@ -20,6 +20,7 @@
 #include <string>
 #include <cpptoml.h>
 
+#include "../../lib/datatypes/PositionRegistry.h"
 #include "../../lib/utility/TOMLSanitize.h"
 #include "../../lib/utility/IOFormat.h"
 
@@ -37,45 +38,8 @@ PositionFilter(position_source_address, position_sink_address)
 void HomographyTransform2D::filter(oat::Position2D& position) {
 
     // TODO: If the homography_is not valid, I should warn the user...
-    if (homography_valid_) {
-
-        // Position transform
-        if (position.position_valid) {
-            std::vector<oat::Point2D> in_positions;
-            std::vector<oat::Point2D> out_positions;
-            in_positions.push_back(position.position);
-            cv::perspectiveTransform(in_positions, out_positions, homography_);
-            position.position = out_positions[0];
-        }
-
-        // Velocity transform
-        if (position.velocity_valid) {
-            std::vector<oat::Velocity2D> in_velocities;
-            std::vector<oat::Velocity2D> out_velocities;
-            cv::Matx33d vel_homo = homography_;
-            vel_homo(0, 2) = 0.0; // offsets do not apply to velocity
-            vel_homo(1, 2) = 0.0; // offsets do not apply to velocity
-            in_velocities.push_back(position.velocity);
-            cv::perspectiveTransform(in_velocities, out_velocities, vel_homo);
-            position.velocity = out_velocities[0];
-        }
-
-        // Heading transform
-        if (position.heading_valid) {
-            std::vector<oat::UnitVector2D> in_heading;
-            std::vector<oat::UnitVector2D> out_heading;
-            cv::Matx33d head_homo = homography_;
-            head_homo(0, 2) = 0.0; // offsets do not apply to heading
-            head_homo(1, 2) = 0.0; // offsets do not apply to heading
-            in_heading.push_back(position.heading);
-            cv::perspectiveTransform(in_heading, out_heading, head_homo);
-            cv::normalize(out_heading, out_heading);
-            position.heading = out_heading[0];
-        }
-
-        // Update outgoing position's coordinate system
-        position.setCoordSystem(oat::DistanceUnit::WORLD, homography_);
-    }
+    if (homography_valid_)
+        homography_.apply(position);
 }
 
 void HomographyTransform2D::configure(const std::string &config_file,
@@ -103,16 +67,14 @@ void HomographyTransform2D::configure(const std::string &config_file,
 
             auto homo_vec = homo_array->array_of<double>();
 
-            homography_(0, 0) = homo_vec[0]->get();
-            homography_(0, 1) = homo_vec[1]->get();
-            homography_(0, 2) = homo_vec[2]->get();
-            homography_(1, 0) = homo_vec[3]->get();
-            homography_(1, 1) = homo_vec[4]->get();
-            homography_(1, 2) = homo_vec[5]->get();
-            homography_(2, 0) = homo_vec[6]->get();
-            homography_(2, 1) = homo_vec[7]->get();
-            homography_(2, 2) = homo_vec[8]->get();
+            cv::Matx33d homography;
+            for (int i = 0; i < 9; i++)
+                homography(i / 3, i % 3) = homo_vec[i]->get();
 
+            // Register the homography once so that published positions
+            // can refer to it by ID
+            homography_ = oat::Homography2D(
+                homography, oat::PositionRegistry::homographyID(homography));
             homography_valid_ = true;
         }
     } else {
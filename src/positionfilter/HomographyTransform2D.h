@@ -23,6 +23,8 @@
 #include <string>
 #include <opencv2/core/mat.hpp>
 
+#include "../../lib/datatypes/Homography2D.h"
+
 #include "PositionFilter.h"
 
 namespace oat {
@@ -48,9 +50,9 @@ public:
 
 private:
 
-    // 2D homography matrix
+    // 2D homography
     bool homography_valid_ {false};
-    cv::Matx33d homography_ {1.0, 0, 0, 0, 1.0, 0, 0, 0, 1.0};
+    oat::Homography2D homography_;
 
     /**
      * Apply homography transform.
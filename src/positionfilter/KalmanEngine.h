@@ -0,0 +1,106 @@
+//******************************************************************************
+//* File:   KalmanEngine.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#ifndef OAT_KALMANENGINE_H
+#define	OAT_KALMANENGINE_H
+
+#include <opencv2/core/matx.hpp>
+
+namespace oat {
+
+/**
+ * Fixed-size linear Kalman filter. Dimensions are known at compile time and
+ * all matrices are cv::Matx so that no heap allocation occurs during
+ * filtering. The model matrices are supplied on each step so that they can
+ * depend on the time elapsed between samples.
+ * @tparam N State dimension
+ * @tparam M Measurement dimension
+ */
+template <int N, int M>
+class KalmanEngine {
+public:
+
+    using State = cv::Matx<double, N, 1>;
+    using StateCov = cv::Matx<double, N, N>;
+    using Measurement = cv::Matx<double, M, 1>;
+    using MeasurementCov = cv::Matx<double, M, M>;
+    using Observation = cv::Matx<double, M, N>;
+    using Gain = cv::Matx<double, N, M>;
+
+    /**
+     * Set the state estimate and its error covariance.
+     * @param state Initial state estimate
+     * @param error_cov Initial error covariance
+     */
+    void initialize(const State &state, const StateCov &error_cov) {
+        x_ = state;
+        P_ = error_cov;
+    }
+
+    /**
+     * Propagate the state estimate forward in time.
+     * @param transition State transition matrix (F)
+     * @param process_noise_cov Process noise covariance (Q)
+     * @return A priori state estimate
+     */
+    const State &predict(const StateCov &transition,
+                         const StateCov &process_noise_cov) {
+
+        x_ = transition * x_;
+        P_ = transition * P_ * transition.t() + process_noise_cov;
+        return x_;
+    }
+
+    /**
+     * Update the state estimate using a measurement.
+     * @param measurement Measurement vector (z)
+     * @param observation Observation matrix (H)
+     * @param measurement_noise_cov Measurement noise covariance (R)
+     * @return A posteriori state estimate
+     */
+    const State &correct(const Measurement &measurement,
+                         const Observation &observation,
+                         const MeasurementCov &measurement_noise_cov) {
+
+        const Gain PHt = P_ * observation.t();
+        const MeasurementCov S = observation * PHt + measurement_noise_cov;
+        const Gain K = PHt * S.inv(cv::DECOMP_LU);
+
+        x_ += K * (measurement - observation * x_);
+        P_ = (StateCov::eye() - K * observation) * P_;
+
+        // Guard against loss of symmetry due to rounding
+        P_ = 0.5 * (P_ + P_.t());
+
+        return x_;
+    }
+
+    // Accessors
+    const State &state(void) const { return x_; }
+    const StateCov &error_cov(void) const { return P_; }
+
+private:
+
+    // State estimate and its error covariance
+    State x_ = State::zeros();
+    StateCov P_ = StateCov::eye();
+};
+
+}      /* namespace oat */
+#endif	/* OAT_KALMANENGINE_H */
@@ -17,6 +17,7 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //******************************************************************************
 
+#include <chrono>
 #include <string>
 #include <opencv2/opencv.hpp>
 #include <cpptoml.h>
@@ -64,10 +65,7 @@ void KalmanFilter2D::configure(const std::string &config_file,
         oat::config::getValue(this_config, "dt", dt_, 0.0);
 
         // Occlusion timeout
-        double timeout_in_sec {0};
-        if (oat::config::getValue(this_config, "timeout", timeout_in_sec, 0.0)) {
-            not_found_count_threshold_ = static_cast<int>(timeout_in_sec / dt_);
-        }
+        oat::config::getValue(this_config, "timeout", timeout_sec_, 0.0);
 
         // Acceleration stdev
         oat::config::getValue(this_config, "sigma_accel", sig_accel_, 0.0);
@@ -91,11 +89,20 @@ void KalmanFilter2D::configure(const std::string &config_file,
 
 void KalmanFilter2D::filter(oat::Position2D &position) {
 
+    // Time step is the interval between sample timestamps. Fall back to the
+    // nominal period for the first sample or if timestamps do not advance.
+    const auto usec = position.sample().microseconds();
+    double dt = dt_;
+    if (last_usec_valid_ && usec > last_usec_)
+        dt = std::chrono::duration<double>(usec - last_usec_).count();
+    last_usec_ = usec;
+    last_usec_valid_ = true;
+
     // Transform raw position into kf_meas_ vector
-    if (position.position_valid) {
-        kf_meas_(0,0) = position.position.x;
-        kf_meas_(1,0) = position.position.y;
-        not_found_count_ = 0;
+    const bool measured = position.position_valid;
+    if (measured) {
+        kf_meas_ = Engine::Measurement(position.position.x, position.position.y);
+        not_found_sec_ = 0.0;
 
         // We are coming from a time step where there were no measurements for
         // a long time, or the first sample, so we need to reinitialize the
@@ -105,31 +112,33 @@ void KalmanFilter2D::filter(oat::Position2D &position) {
 
         found_ = true;
     } else {
-        not_found_count_++;
+        not_found_sec_ += dt;
     }
 
     // If we have not gotten a measurement of the object for a long time
     // we need to reinitialize the filter
-    if (not_found_count_ >= not_found_count_threshold_)
+    if (not_found_sec_ > timeout_sec_)
         found_ = false;
 
     // Only update if the object is found_ (this includes time points for which
-    // the position measurement was invalid, but we are within the not_found_count_threshold_)
+    // the position measurement was invalid, but we are within the timeout).
+    // The correction is only applied when there is a new measurement.
     if (found_) {
 
-        kf_predicted_state_ = kf_.predict();
+        updateModel(dt);
+        kf_.predict(transition_, process_noise_cov_);
 
-        // Apply the Kalman update
-        kf_.correct(kf_meas_);
+        if (measured)
+            kf_.correct(kf_meas_, observation_, measurement_noise_cov_);
     }
 
-    position.position.x = kf_predicted_state_(0, 0);
-    position.velocity.x = kf_predicted_state_(1, 0);
-    position.position.y = kf_predicted_state_(2, 0);
-    position.velocity.y = kf_predicted_state_(3, 0);
+    const Engine::State &state = kf_.state();
+    position.position.x = state(0);
+    position.velocity.x = state(1);
+    position.position.y = state(2);
+    position.velocity.y = state(3);
 
-    // This Position is only valid if the not_found_count_threshold_ has not
-    // be exceeded
+    // This Position is only valid if the timeout has not been exceeded
     if (found_) {
         position.position_valid = true;
         position.velocity_valid = true;
@@ -144,67 +153,55 @@ void KalmanFilter2D::filter(oat::Position2D &position) {
 
 void KalmanFilter2D::initializeFilter(void) {
 
-    initializeStaticMatracies();
-
     // Error covariance matrix (initialize with large value to indicate a lack
     // of trust in the model)
-    cv::setIdentity(kf_.errorCovPre, 1000.0);
-
     // TODO: Add head direction?
-    // The state is
-    // [ x  x'  y  y']^T, where ' denotes the time derivative
-    // Initialize the pre/post state using the current measurement
-    kf_.statePre.at<double>(0) = kf_meas_(0, 0);
-    kf_.statePre.at<double>(1) = 0.0;
-    kf_.statePre.at<double>(2) = kf_meas_(1, 0);
-    kf_.statePre.at<double>(3) = 0.0;
-
-    kf_.statePost.at<double>(0) = kf_meas_(0, 0);
-    kf_.statePost.at<double>(1) = 0.0;
-    kf_.statePost.at<double>(2) = kf_meas_(1, 0);
-    kf_.statePost.at<double>(3) = 0.0;
+    // Initialize the state using the current measurement
+    kf_.initialize(Engine::State(kf_meas_(0), 0.0, kf_meas_(1), 0.0),
+                   Engine::StateCov::eye() * 1000.0);
 }
 
-void KalmanFilter2D::initializeStaticMatracies() {
+void KalmanFilter2D::updateModel(const double dt) {
 
     // State transition matrix
-    // [ 1  dt_ 0  0  ]
-    // [ 0  1  0  0   ]
-    // [ 0  0  1  dt_ ]
-    // [ 0  0  0  1   ]
-    cv::setIdentity(kf_.transitionMatrix);
-    kf_.transitionMatrix.at<double>(0, 1) = dt_;
-    kf_.transitionMatrix.at<double>(2, 3) = dt_;
+    // [ 1  dt 0  0  ]
+    // [ 0  1  0  0  ]
+    // [ 0  0  1  dt ]
+    // [ 0  0  0  1  ]
+    transition_ = Engine::StateCov::eye();
+    transition_(0, 1) = dt;
+    transition_(2, 3) = dt;
 
     // Observation Matrix (can only see position directly)
     // [ 1  0  0  0 ]
     // [ 0  0  1  0 ]
-    kf_.measurementMatrix = cv::Mat::zeros(2, 4, CV_64F);
-    kf_.measurementMatrix.at<double>(0, 0) = 1.0;
-    kf_.measurementMatrix.at<double>(1, 2) = 1.0;
+    observation_ = Engine::Observation::zeros();
+    observation_(0, 0) = 1.0;
+    observation_(1, 2) = 1.0;
 
     // Noise covariance matrix (see pp13-15 of MWL.JPN.105.02.002 for derivation)
-    // [ dt_^4/4 dt_^3/2 		       ]
-    // [ dt_^3/2 dt_^2   		       ]
-    // [               dt_^4/2 dt_^2/3 ] * sigma_accel^2
-    // [               dt_^2/3 dt_^2   ]
-    kf_.processNoiseCov = cv::Mat::zeros(4, 4, CV_64F);
-    kf_.processNoiseCov.at<double>(0, 0) = sig_accel_ * sig_accel_ * (dt_ * dt_ * dt_ * dt_) / 4.0;
-    kf_.processNoiseCov.at<double>(0, 1) = sig_accel_ * sig_accel_ * (dt_ * dt_ * dt_) / 2.0;
-
-    kf_.processNoiseCov.at<double>(1, 0) = sig_accel_ * sig_accel_ * (dt_ * dt_ * dt_) / 2.0;
-    kf_.processNoiseCov.at<double>(1, 1) = sig_accel_ * sig_accel_ * (dt_ * dt_);
-
-    kf_.processNoiseCov.at<double>(2, 2) = sig_accel_ * sig_accel_ * (dt_ * dt_ * dt_ * dt_) / 4.0;
-    kf_.processNoiseCov.at<double>(2, 3) = sig_accel_ * sig_accel_ * (dt_ * dt_ * dt_) / 2.0;
-
-    kf_.processNoiseCov.at<double>(3, 2) = sig_accel_ * sig_accel_ * (dt_ * dt_ * dt_) / 2.0;
-    kf_.processNoiseCov.at<double>(3, 3) = sig_accel_ * sig_accel_ * (dt_ * dt_);
+    // [ dt^4/4 dt^3/2               ]
+    // [ dt^3/2 dt^2                 ]
+    // [               dt^4/4 dt^3/2 ] * sigma_accel^2
+    // [               dt^3/2 dt^2   ]
+    const double var = sig_accel_ * sig_accel_;
+    const double dt2 = dt * dt;
+    process_noise_cov_ = Engine::StateCov::zeros();
+    process_noise_cov_(0, 0) = var * dt2 * dt2 / 4.0;
+    process_noise_cov_(0, 1) = var * dt2 * dt / 2.0;
+    process_noise_cov_(1, 0) = var * dt2 * dt / 2.0;
+    process_noise_cov_(1, 1) = var * dt2;
+
+    process_noise_cov_(2, 2) = var * dt2 * dt2 / 4.0;
+    process_noise_cov_(2, 3) = var * dt2 * dt / 2.0;
+    process_noise_cov_(3, 2) = var * dt2 * dt / 2.0;
+    process_noise_cov_(3, 3) = var * dt2;
 
     // Measurement noise covariance
     // [ sig_x^2  0 ]
     // [ 0  sig_y^2 ]
-    cv::setIdentity(kf_.measurementNoiseCov, cv::Scalar(sig_measure_noise_ * sig_measure_noise_));
+    measurement_noise_cov_ =
+        Engine::MeasurementCov::eye() * (sig_measure_noise_ * sig_measure_noise_);
 }
 
 void KalmanFilter2D::tune() {
@@ -218,10 +215,9 @@ void KalmanFilter2D::tune() {
             createTuningWindows();
         }
 
-        // Use the new parameters to create new static filter matracies
+        // Use the new parameters. Model matrices are rebuilt on each step.
         sig_accel_ = static_cast<double>(sig_accel_tune_);
         sig_measure_noise_ = static_cast<double>(sig_measure_noise_tune_);
-        initializeStaticMatracies();
 
         //cv::Mat tuning_canvas(canvas_hw, canvas_hw, CV_8UC3);
         //tuning_canvas.setTo(255);
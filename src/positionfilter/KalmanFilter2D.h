@@ -23,6 +23,9 @@
 #include <string>
 #include <opencv2/opencv.hpp>
 
+#include "../../lib/datatypes/Sample.h"
+
+#include "KalmanEngine.h"
 #include "PositionFilter.h"
 
 namespace oat {
@@ -39,9 +42,11 @@ public:
      * The assumed model is normally distributed constant force applied at each
      * time steps causes a random, constant acceleration in between each time-step.
      * Measurement noise is assumed to be Gaussian with a user supplied variance.
-     * Model parameters (time step size, standard deviation of random acceleration,
-     * and measurement noise standard deviation, etc) are supplied using the
-     * configure method.
+     * The time step is the interval between the timestamps of consecutive
+     * samples, so the model remains correct when samples are dropped.
+     * Model parameters (nominal time step size, standard deviation of random
+     * acceleration, and measurement noise standard deviation, etc) are
+     * supplied using the configure method.
      * @param position_source_address Un-filtered position SOURCE name
      * @param position_sink_address Filtered position SINK name
      */
@@ -53,13 +58,25 @@ public:
 
 private:
 
-    // Kalman state estimate and measurement vectors
-    cv::Mat_<double> kf_predicted_state_ {4, 1, CV_64F};
-    cv::Mat_<double> kf_meas_ {2, 1, CV_64F};
+    // Kalman filter. The state is [x x' y y']^T, where ' denotes the time
+    // derivative, and the measurement is [x y]^T.
+    using Engine = oat::KalmanEngine<4, 2>;
+    Engine kf_;
+    Engine::Measurement kf_meas_;
+
+    // Model matrices. Transition and process noise depend on the time step.
+    Engine::StateCov transition_;
+    Engine::StateCov process_noise_cov_;
+    Engine::Observation observation_;
+    Engine::MeasurementCov measurement_noise_cov_;
 
-    // Sample period
+    // Nominal sample period, used when sample timestamps cannot provide one
     double dt_ {0.02};
 
+    // Timestamp of the previous sample
+    oat::Sample::Microseconds last_usec_ {0};
+    bool last_usec_valid_ {false};
+
     // Standard deviation of assumed random accelerations.
     double sig_accel_ {5.0};
     double sig_measure_noise_ {0.0};
@@ -74,11 +91,8 @@ private:
 
     // Variables and parameters to control whether or not to apply the filter
     bool found_ {false};
-    int not_found_count_ {0};
-    int not_found_count_threshold_ {0};
-
-    // Kalman filter object
-    cv::KalmanFilter kf_ {4, 2, 0, CV_64F};
+    double not_found_sec_ {0.0};
+    double timeout_sec_ {0.0};
 
     /**
      * Perform Kalman filtering.
@@ -89,7 +103,7 @@ private:
     // TODO: These subroutines have pretty boring type signatures...
     void tune(void);
     void initializeFilter(void);
-    void initializeStaticMatracies(void);
+    void updateModel(const double dt);
     void createTuningWindows(void);
     void drawPosition(cv::Mat& canvas, const oat::Position2D& position);
 };
@@ -0,0 +1,135 @@
+//******************************************************************************
+//* File:   LatencyPredictor2D.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <cpptoml.h>
+
+#include "../../lib/utility/TOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
+#include "LatencyPredictor2D.h"
+
+namespace oat {
+
+LatencyPredictor2D::LatencyPredictor2D(const std::string &position_source_address,
+                                       const std::string &position_sink_address) :
+  PositionFilter(position_source_address, position_sink_address)
+{
+    // Nothing
+}
+
+void LatencyPredictor2D::configure(const std::string &config_file,
+                                   const std::string &config_key) {
+
+    // Available options
+    std::vector<std::string> options {"model",
+                                      "delay",
+                                      "max_horizon"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a camera configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Motion model
+        std::string model;
+        if (oat::config::getValue(this_config, "model", model)) {
+            if (model == "velocity")
+                model_ = Model::VELOCITY;
+            else if (model == "acceleration")
+                model_ = Model::ACCELERATION;
+            else
+                throw (std::runtime_error(oat::configValueError(
+                    "model", config_key, config_file,
+                    "must be 'velocity' or 'acceleration'.")));
+        }
+
+        // Output delay
+        oat::config::getValue(this_config, "delay", delay_sec_, 0.0);
+
+        // Extrapolation limit
+        oat::config::getValue(this_config, "max_horizon", max_horizon_sec_, 0.0);
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+void LatencyPredictor2D::filter(oat::Position2D &position) {
+
+    const auto usec = position.sample().microseconds();
+    const bool dt_valid = usec > last_usec_;
+    const double dt = dt_valid ?
+        std::chrono::duration<double>(usec - last_usec_).count() : 0.0;
+
+    // Velocity is taken from the incoming position if it has one, otherwise
+    // it is estimated from consecutive positions
+    if (!position.velocity_valid && position.position_valid
+        && last_position_valid_ && dt_valid) {
+        position.velocity = (position.position - last_position_) * (1.0 / dt);
+        position.velocity_valid = true;
+    }
+
+    // Acceleration is estimated from consecutive velocities
+    oat::Velocity2D accel(0, 0);
+    if (model_ == Model::ACCELERATION && position.velocity_valid
+        && last_velocity_valid_ && dt_valid) {
+        accel = (position.velocity - last_velocity_) * (1.0 / dt);
+    }
+
+    // Derivatives are estimated from the measured, not predicted, state
+    last_usec_ = usec;
+    last_position_ = position.position;
+    last_velocity_ = position.velocity;
+    last_position_valid_ = position.position_valid;
+    last_velocity_valid_ = position.velocity_valid;
+
+    if (!position.position_valid || !position.velocity_valid)
+        return;
+
+    const double h = horizon(position.sample());
+    position.position += position.velocity * h + accel * (0.5 * h * h);
+    position.velocity += accel * h;
+}
+
+double LatencyPredictor2D::horizon(const oat::Sample &sample) const {
+
+    // Samples that were never stamped on the monotonic clock only
+    // compensate for the configured delay
+    double latency = 0.0;
+    const auto acquired = sample.monotonic_microseconds();
+    if (acquired.count() > 0) {
+        latency = std::chrono::duration<double>(
+            oat::Sample::monotonicNow() - acquired).count();
+    }
+
+    return std::min(std::max(latency + delay_sec_, 0.0), max_horizon_sec_);
+}
+
+} /* namespace oat */
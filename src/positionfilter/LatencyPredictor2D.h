@@ -0,0 +1,98 @@
+//******************************************************************************
+//* File:   LatencyPredictor2D.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_LATENCYPREDICTOR2D_H
+#define	OAT_LATENCYPREDICTOR2D_H
+
+#include <string>
+
+#include "../../lib/datatypes/Sample.h"
+
+#include "PositionFilter.h"
+
+namespace oat {
+
+/**
+ * Latency-compensating position predictor. Extrapolates each position forward
+ * by the time elapsed since its sample was acquired plus a fixed output delay
+ * so that downstream consumers receive an estimate of where the object is
+ * now, rather than where it was when the frame was captured.
+ */
+class LatencyPredictor2D : public PositionFilter {
+
+public:
+
+    /**
+     * Latency-compensating position predictor.
+     * Latency is measured by comparing each sample's acquisition stamp on the
+     * shared monotonic clock against the current time. Motion is modeled as
+     * either constant velocity, using the velocity estimate of the incoming
+     * position (e.g. from an upstream Kalman filter), or constant acceleration,
+     * which additionally differentiates that velocity across samples.
+     * @param position_source_address Un-filtered position SOURCE name
+     * @param position_sink_address Filtered position SINK name
+     */
+    LatencyPredictor2D(const std::string &position_source_address,
+                       const std::string &position_sink_address);
+
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+
+private:
+
+    enum class Model {
+        VELOCITY = 0,
+        ACCELERATION
+    };
+
+    // Motion model used for extrapolation
+    Model model_ {Model::VELOCITY};
+
+    // Additional output delay to compensate for (seconds)
+    double delay_sec_ {0.0};
+
+    // Maximum extrapolation horizon (seconds)
+    double max_horizon_sec_ {0.5};
+
+    // Previous sample state, used to estimate derivatives that are not
+    // supplied by the incoming position
+    oat::Sample::Microseconds last_usec_ {0};
+    oat::Point2D last_position_;
+    oat::Velocity2D last_velocity_;
+    bool last_position_valid_ {false};
+    bool last_velocity_valid_ {false};
+
+    /**
+     * Extrapolate position forward by the measured latency.
+     * @param position Position to be filtered
+     */
+    void filter(oat::Position2D &position) override;
+
+    /**
+     * Compute the extrapolation horizon for a sample: the time elapsed since
+     * it was acquired plus the configured output delay, clamped to the
+     * configured maximum.
+     * @param sample Sample to compute horizon for
+     * @return Horizon in seconds
+     */
+    double horizon(const oat::Sample &sample) const;
+};
+
+}      /* namespace oat */
+#endif /* OAT_LATENCYPREDICTOR2D_H */
@@ -0,0 +1,382 @@
+//******************************************************************************
+//* File:   MultiTargetTracker.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cpptoml.h>
+
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/TOMLSanitize.h"
+#include "../../lib/utility/make_unique.h"
+
+#include "MultiTargetTracker.h"
+
+namespace oat {
+
+MultiTargetTracker::MultiTargetTracker(
+                        const std::vector<std::string> &position_source_addresses,
+                        const std::string &position_sink_address) :
+  name_("posifilt[" + position_source_addresses[0] + "...->" + position_sink_address + "_*]")
+, position_sink_address_(position_sink_address)
+, num_targets_(position_source_addresses.size())
+{
+    for (auto &addr : position_source_addresses) {
+
+        candidates_.push_back(oat::Position2D());
+        position_sources_.push_back(
+            oat::NamedSource<oat::Position2D>(
+                addr,
+                std::make_unique<oat::Source<oat::Position2D>>()
+            )
+        );
+    }
+}
+
+void MultiTargetTracker::configure(const std::string &config_file,
+                                   const std::string &config_key) {
+
+    // Available options
+    std::vector<std::string> options {"targets",
+                                      "association",
+                                      "gate",
+                                      "dt",
+                                      "timeout",
+                                      "sigma_accel",
+                                      "sigma_noise"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Number of tracks
+        int64_t targets;
+        if (oat::config::getValue(this_config, "targets", targets, (int64_t)1))
+            num_targets_ = targets;
+
+        // Data association method
+        std::string association;
+        if (oat::config::getValue(this_config, "association", association)) {
+            if (association == "nearest")
+                method_ = oat::Assignment::Method::GREEDY;
+            else if (association == "hungarian")
+                method_ = oat::Assignment::Method::HUNGARIAN;
+            else
+                throw (std::runtime_error(oat::configValueError(
+                    "association", config_key, config_file,
+                    "must be 'nearest' or 'hungarian'.")));
+        }
+
+        // Association gate
+        oat::config::getValue(this_config, "gate", gate_, 0.0);
+
+        // Time step
+        oat::config::getValue(this_config, "dt", dt_, 0.0);
+
+        // Occlusion timeout
+        oat::config::getValue(this_config, "timeout", timeout_sec_, 0.0);
+
+        // Acceleration stdev
+        oat::config::getValue(this_config, "sigma_accel", sig_accel_, 0.0);
+
+        // Measurement noise stdev
+        oat::config::getValue(this_config, "sigma_noise", sig_measure_noise_, 0.0);
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+std::vector<std::string> MultiTargetTracker::sink_addresses() const {
+
+    std::vector<std::string> addrs;
+    for (size_t i = 0; i < num_targets_; i++)
+        addrs.push_back(position_sink_address_ + "_" + std::to_string(i));
+
+    return addrs;
+}
+
+void MultiTargetTracker::connectToNodes() {
+
+    // Establish our slot in each node
+    for (auto &ps : position_sources_)
+        ps.source->touch(ps.name);
+
+    // Examine sample period of sources to make sure they are the same
+    double sample_rate_hz;
+    std::vector<double> all_ts;
+
+    // Wait for sychronous start with sink when it binds the node
+    for (auto &ps : position_sources_) {
+        ps.source->connect();
+        all_ts.push_back(ps.source->retrieve()->sample().period_sec().count());
+    }
+
+    if (!oat::checkSamplePeriods(all_ts, sample_rate_hz)) {
+        std::cerr << oat::Warn(oat::inconsistentSampleRateWarning(sample_rate_hz));
+    }
+
+    // Bind a sink node for each track
+    tracks_.resize(num_targets_);
+    for (const auto &addr : sink_addresses()) {
+
+        outputs_.push_back(oat::Position2D());
+        position_sinks_.push_back(std::make_unique<oat::Sink<oat::Position2D>>());
+        position_sinks_.back()->bind(addr);
+        shared_positions_.push_back(position_sinks_.back()->retrieve());
+    }
+}
+
+bool MultiTargetTracker::readSource(const size_t idx, const bool block) {
+
+    oat::NodeState state;
+    auto &source = position_sources_[idx].source;
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+    if (block ? !source->tryWait(state, oat::msec_t(1))
+              : !source->tryWait(state))
+        return false;
+
+    source_eof_ |= (state == oat::NodeState::END);
+
+    candidates_[idx] = source->clone();
+
+    source->post();
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    return true;
+}
+
+bool MultiTargetTracker::process() {
+
+    pending_sources_.clear();
+    for (size_t i = 0; i != position_sources_.size(); i++)
+        pending_sources_.push_back(i);
+
+    // Read SOURCEs in the order in which they become ready so that a slow
+    // upstream component does not delay releasing the others
+    while (!pending_sources_.empty()) {
+
+        auto it = std::remove_if(pending_sources_.begin(),
+                                 pending_sources_.end(),
+                                 [this](const size_t idx) {
+                                     return readSource(idx, false);
+                                 });
+
+        if (it != pending_sources_.end()) {
+            pending_sources_.erase(it, pending_sources_.end());
+            continue;
+        }
+
+        // Nothing was ready, so wait briefly on the first pending SOURCE
+        // before polling all of them again
+        if (readSource(pending_sources_.front(), true))
+            pending_sources_.erase(pending_sources_.begin());
+    }
+
+    if (source_eof_)
+        return true;
+
+    // Time step is the interval between sample timestamps. Fall back to the
+    // nominal period for the first sample or if timestamps do not advance.
+    const auto usec = candidates_[0].sample().microseconds();
+    double dt = dt_;
+    if (last_usec_valid_ && usec > last_usec_)
+        dt = std::chrono::duration<double>(usec - last_usec_).count();
+    last_usec_ = usec;
+    last_usec_valid_ = true;
+
+    track(dt);
+
+    for (size_t i = 0; i != position_sinks_.size(); i++) {
+
+        // START CRITICAL SECTION //
+        ////////////////////////////
+
+        // Wait for sources to read
+        position_sinks_[i]->wait();
+
+        *shared_positions_[i] = outputs_[i];
+
+        // Tell sources there is new data
+        position_sinks_[i]->post();
+
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+    }
+
+    // Sink was not at END state
+    return false;
+}
+
+void MultiTargetTracker::track(const double dt) {
+
+    updateModel(dt);
+
+    // Valid candidates
+    measured_.clear();
+    for (size_t j = 0; j < candidates_.size(); j++)
+        if (candidates_[j].position_valid)
+            measured_.push_back(j);
+
+    // Propagate active tracks
+    active_.clear();
+    for (size_t i = 0; i < tracks_.size(); i++) {
+        if (tracks_[i].active) {
+            tracks_[i].kf.predict(transition_, process_noise_cov_);
+            active_.push_back(i);
+        }
+    }
+
+    // Associate candidates with active tracks
+    const int rows = active_.size();
+    const int cols = measured_.size();
+    cost_.resize(rows * cols);
+    for (int r = 0; r < rows; r++)
+        for (int c = 0; c < cols; c++)
+            cost_[r * cols + c] = distance(tracks_[active_[r]],
+                                           candidates_[measured_[c]].position);
+
+    assignment_.solve(cost_, rows, cols, gate_, method_, track_to_meas_);
+
+    meas_used_.assign(cols, false);
+    for (int r = 0; r < rows; r++) {
+
+        Track &t = tracks_[active_[r]];
+        const int c = track_to_meas_[r];
+
+        if (c >= 0) {
+            const auto &z = candidates_[measured_[c]].position;
+            t.kf.correct(Engine::Measurement(z.x, z.y),
+                         observation_,
+                         measurement_noise_cov_);
+            t.not_found_sec = 0.0;
+            meas_used_[c] = true;
+        } else {
+            t.not_found_sec += dt;
+            if (t.not_found_sec > timeout_sec_)
+                t.active = false;
+        }
+    }
+
+    // Candidates that could not be associated with an existing track start
+    // new tracks in free slots
+    size_t next_free = 0;
+    for (int c = 0; c < cols; c++) {
+
+        if (meas_used_[c])
+            continue;
+
+        while (next_free < tracks_.size() && tracks_[next_free].active)
+            next_free++;
+
+        if (next_free == tracks_.size())
+            break;
+
+        const auto &z = candidates_[measured_[c]].position;
+        Track &t = tracks_[next_free];
+        t.kf.initialize(Engine::State(z.x, 0.0, z.y, 0.0),
+                        Engine::StateCov::eye() * 1000.0);
+        t.active = true;
+        t.not_found_sec = 0.0;
+    }
+
+    // Build outputs. Sample and coordinate system are inherited from the
+    // first candidate SOURCE.
+    for (size_t i = 0; i < tracks_.size(); i++) {
+
+        const Track &t = tracks_[i];
+        oat::Position2D &out = outputs_[i];
+
+        out = candidates_[0];
+        out.heading_valid = false;
+        out.region_valid = false;
+
+        const Engine::State &state = t.kf.state();
+        out.position.x = state(0);
+        out.velocity.x = state(1);
+        out.position.y = state(2);
+        out.velocity.y = state(3);
+        out.position_valid = t.active;
+        out.velocity_valid = t.active;
+    }
+}
+
+double MultiTargetTracker::distance(const Track &t, const oat::Point2D &z) const {
+
+    // Innovation covariance, S = H P H^T + R, where H selects x and y
+    const Engine::State &x = t.kf.state();
+    const Engine::StateCov &P = t.kf.error_cov();
+    const double r = sig_measure_noise_ * sig_measure_noise_;
+    const double s00 = P(0, 0) + r;
+    const double s01 = P(0, 2);
+    const double s11 = P(2, 2) + r;
+    const double det = s00 * s11 - s01 * s01;
+
+    const double dx = z.x - x(0);
+    const double dy = z.y - x(2);
+
+    if (det <= 0.0)
+        return dx * dx + dy * dy;
+
+    return (s11 * dx * dx - 2.0 * s01 * dx * dy + s00 * dy * dy) / det;
+}
+
+void MultiTargetTracker::updateModel(const double dt) {
+
+    // See KalmanFilter2D::updateModel for model derivation
+    transition_ = Engine::StateCov::eye();
+    transition_(0, 1) = dt;
+    transition_(2, 3) = dt;
+
+    observation_ = Engine::Observation::zeros();
+    observation_(0, 0) = 1.0;
+    observation_(1, 2) = 1.0;
+
+    const double var = sig_accel_ * sig_accel_;
+    const double dt2 = dt * dt;
+    process_noise_cov_ = Engine::StateCov::zeros();
+    process_noise_cov_(0, 0) = var * dt2 * dt2 / 4.0;
+    process_noise_cov_(0, 1) = var * dt2 * dt / 2.0;
+    process_noise_cov_(1, 0) = var * dt2 * dt / 2.0;
+    process_noise_cov_(1, 1) = var * dt2;
+
+    process_noise_cov_(2, 2) = var * dt2 * dt2 / 4.0;
+    process_noise_cov_(2, 3) = var * dt2 * dt / 2.0;
+    process_noise_cov_(3, 2) = var * dt2 * dt / 2.0;
+    process_noise_cov_(3, 3) = var * dt2;
+
+    measurement_noise_cov_ =
+        Engine::MeasurementCov::eye() * (sig_measure_noise_ * sig_measure_noise_);
+}
+
+} /* namespace oat */
@@ -0,0 +1,166 @@
+//******************************************************************************
+//* File:   MultiTargetTracker.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_MULTITARGETTRACKER_H
+#define	OAT_MULTITARGETTRACKER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/Sample.h"
+#include "../../lib/shmemdf/Helpers.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+#include "Assignment.h"
+#include "KalmanEngine.h"
+
+namespace oat {
+
+/**
+ * Multi-target tracker. Receives candidate positions from one or more SOURCEs,
+ * associates them with a fixed number of tracks, each of which has its own
+ * Kalman filter, and publishes the filtered position of each track to its own
+ * SINK. Track identities are stable for as long as a track is not lost.
+ */
+class MultiTargetTracker {
+
+public:
+
+    using Engine = oat::KalmanEngine<4, 2>;
+
+    /**
+     * Multi-target tracker.
+     * @param position_source_addresses Candidate position SOURCE addresses
+     * @param position_sink_address Base SINK address. The position of track i
+     * is published to <position_sink_address>_<i>.
+     */
+    MultiTargetTracker(const std::vector<std::string> &position_source_addresses,
+                       const std::string &position_sink_address);
+
+    /**
+     * Connect to candidate SOURCEs and bind a SINK for each track.
+     */
+    void connectToNodes(void);
+
+    /**
+     * Obtain candidate positions from all SOURCEs, update tracks, and publish
+     * the position of each track.
+     * @return SOURCE end-of-stream signal. If true, this component should exit.
+     */
+    bool process(void);
+
+    /**
+     * Configure tracker parameters.
+     * @param config_file configuration file path
+     * @param config_key configuration key
+     */
+    void configure(const std::string &config_file,
+                   const std::string &config_key);
+
+    // Accessors
+    std::string name(void) const { return name_; }
+    std::vector<std::string> sink_addresses(void) const;
+
+private:
+
+    struct Track {
+        Engine kf;
+        bool active {false};
+        double not_found_sec {0.0};
+    };
+
+    // Tracker name
+    const std::string name_;
+
+    // Candidate position SOURCEs
+    std::vector<oat::Position2D> candidates_;
+    oat::NamedSourceList<oat::Position2D> position_sources_;
+
+    // SOURCEs that have not been read during the current call to process
+    std::vector<size_t> pending_sources_;
+    bool source_eof_ {false};
+
+    // Track position SINKs
+    const std::string position_sink_address_;
+    std::vector<oat::Position2D> outputs_;
+    std::vector<oat::Position2D *> shared_positions_;
+    std::vector<std::unique_ptr<oat::Sink<oat::Position2D>>> position_sinks_;
+
+    // Tracks
+    std::vector<Track> tracks_;
+    size_t num_targets_ {0};
+
+    // Data association
+    oat::Assignment assignment_;
+    oat::Assignment::Method method_ {oat::Assignment::Method::HUNGARIAN};
+    double gate_ {9.21}; // 99% of chi-squared with 2 DOF
+    std::vector<int> measured_;
+    std::vector<int> active_;
+    std::vector<double> cost_;
+    std::vector<int> track_to_meas_;
+    std::vector<bool> meas_used_;
+
+    // Model parameters
+    double dt_ {0.02};
+    double sig_accel_ {5.0};
+    double sig_measure_noise_ {1.0};
+    double timeout_sec_ {0.5};
+
+    // Model matrices, shared by all tracks
+    Engine::StateCov transition_;
+    Engine::StateCov process_noise_cov_;
+    Engine::Observation observation_;
+    Engine::MeasurementCov measurement_noise_cov_;
+
+    // Timestamp of the previous sample
+    oat::Sample::Microseconds last_usec_ {0};
+    bool last_usec_valid_ {false};
+
+    /**
+     * Read the current candidate from a SOURCE.
+     * @param idx SOURCE index
+     * @param block If true, wait up to a millisecond for the SOURCE to become
+     * ready. Otherwise, return immediately if it is not.
+     * @return True if the SOURCE was read.
+     */
+    bool readSource(const size_t idx, const bool block);
+
+    /**
+     * Predict, associate, and correct all tracks using the current candidates.
+     * @param dt Time since previous sample (seconds)
+     */
+    void track(const double dt);
+
+    /**
+     * Squared Mahalanobis distance between a measurement and the predicted
+     * measurement of a track.
+     * @param t Track
+     * @param z Measurement
+     * @return Distance
+     */
+    double distance(const Track &t, const oat::Point2D &z) const;
+
+    void updateModel(const double dt);
+};
+
+}      /* namespace oat */
+#endif	/* OAT_MULTITARGETTRACKER_H */
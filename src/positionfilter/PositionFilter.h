@@ -73,6 +73,9 @@ public:
 
 protected:
 
+    // Filter chains apply the filter() method of their stages
+    friend class FilterChain;
+
     /**
      * Perform position filtering.
      * @param position Position to be filtered
@@ -89,7 +92,7 @@ private:
     oat::Source<oat::Position2D> position_source_;
 
     // Internal, mutable position
-    oat::Position2D internal_position_ {"internal"};
+    oat::Position2D internal_position_;
 
     // Shared position
     oat::Position2D * shared_position_;
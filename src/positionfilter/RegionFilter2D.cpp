@@ -20,7 +20,7 @@
 #include <ostream>
 #include <opencv2/core/types.hpp>
 #include <opencv2/imgproc.hpp>
-#include <string.h>
+#include <limits>
 #include <vector>
 #include <cpptoml.h>
 
@@ -38,12 +38,6 @@ RegionFilter2D::RegionFilter2D(const std::string &position_source_address,
     // Nothing
 }
 
-RegionFilter2D::~RegionFilter2D() {
-
-    for (auto &value : region_contours)
-        delete value;
-}
-
 void RegionFilter2D::configure(const std::string &config_file,
                                const std::string &config_key) {
 
@@ -69,9 +63,9 @@ void RegionFilter2D::configure(const std::string &config_file,
             oat::config::Array region_array;
             oat::config::getArray(this_config, it->first, region_array);
 
-            // Push the name of this region onto the id list
-            region_ids.push_back(it->first);
-            region_contours.push_back(new std::vector<cv::Point>());
+            // Register the name of this region. Its ID is its index.
+            region_name_ids_.push_back(oat::PositionRegistry::regionID(it->first));
+            region_contours_.push_back(std::vector<cv::Point>());
 
             auto region = region_array->nested_array();
             auto reg_it = region.begin();
@@ -91,12 +85,14 @@ void RegionFilter2D::configure(const std::string &config_file,
                 }
 
                 auto p = cv::Point2d(point[0]->get(), point[1]->get());
-                region_contours.back()->push_back(p);
+                region_contours_.back().push_back(p);
                 reg_it++;
             }
             it++;
         }
 
+        createRegionMap();
+
 //#ifndef NDEBUG
 //        //check the result
 //        for (size_t i = 0; i < region_contours.size(); i++) {
@@ -118,26 +114,69 @@ void RegionFilter2D::filter(oat::Position2D &position) {
     // Check the current position to see if it lies inside any regions.
     if (position.position_valid) {
 
-        cv::Point pt = (cv::Point)position.position;
-        std::vector<std::string>::size_type i = 0;
+        const int id = regionID(position.position);
 
-        for (auto &r : region_contours) {
+        if (id >= 0) {
+            position.region_valid = true;
+            position.region_id = region_name_ids_[id];
+        }
+    }
+}
 
-            if (cv::pointPolygonTest(*r, pt, false) >= 0) {
+void RegionFilter2D::createRegionMap() {
 
-                position.region_valid = true;
+    region_map_.release();
+    map_roi_ = cv::Rect();
 
-                std::vector<char> writable(region_ids[i].begin(), region_ids[i].end());
-                writable.push_back('\0');
+    for (const auto &c : region_contours_) {
+        if (!c.empty()) {
+            const cv::Rect r = cv::boundingRect(c);
+            map_roi_ = map_roi_.area() > 0 ? (map_roi_ | r) : r;
+        }
+    }
 
-                strcpy(position.region, &writable[0]);
+    // Fall back to polygon tests if the map would be too large (e.g. the
+    // regions are specified in very large units) or there are too many
+    // regions to label
+    if (static_cast<int64_t>(map_roi_.width) * map_roi_.height > MAX_MAP_AREA
+        || region_contours_.size() >= std::numeric_limits<uint16_t>::max()) {
+        map_roi_ = cv::Rect();
+        return;
+    }
 
-                break;
-            }
+    region_map_.create(map_roi_.size());
+    region_map_.setTo(0);
 
-            i++;
-        }
+    // Draw in reverse order so that the first region defined takes precedence
+    // where regions overlap
+    for (int i = static_cast<int>(region_contours_.size()) - 1; i >= 0; i--) {
+
+        if (region_contours_[i].empty())
+            continue;
+
+        std::vector<std::vector<cv::Point>> polygon {region_contours_[i]};
+        cv::fillPoly(region_map_, polygon, cv::Scalar(i + 1), cv::LINE_8, 0, -map_roi_.tl());
     }
 }
 
+int RegionFilter2D::regionID(const cv::Point &pt) const {
+
+    // Region map lookup
+    if (!region_map_.empty()) {
+
+        if (!map_roi_.contains(pt))
+            return -1;
+
+        return region_map_(pt.y - map_roi_.y, pt.x - map_roi_.x) - 1;
+    }
+
+    // Polygon tests
+    for (size_t i = 0; i < region_contours_.size(); i++) {
+        if (cv::pointPolygonTest(region_contours_[i], pt, false) >= 0)
+            return i;
+    }
+
+    return -1;
+}
+
 } /* namespace oat */
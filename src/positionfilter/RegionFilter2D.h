@@ -24,6 +24,8 @@
 #include <vector>
 #include <opencv2/core.hpp>
 
+#include "../../lib/datatypes/Position2D.h"
+
 #include "PositionFilter.h"
 
 namespace oat {
@@ -49,16 +51,26 @@ public:
     RegionFilter2D(const std::string &position_source_address,
                    const std::string &position_sink_address);
 
-    ~RegionFilter2D();
-
     void configure(const std::string &config_file,
                    const std::string &config_key) override;
 
 private:
 
-    // Regions
-    std::vector< std::string > region_ids;
-    std::vector< std::vector<cv::Point> * > region_contours;
+    // Regions. Region IDs are indices into these vectors. Region names are
+    // held as their registered IDs, which are copied into
+    // Position2D::region_id.
+    std::vector<oat::RegionID> region_name_ids_;
+    std::vector<std::vector<cv::Point>> region_contours_;
+
+    // Rasterized region map. Each pixel holds 1 + the ID of the region that
+    // contains it, or 0 if it is not within any region. The map covers
+    // map_roi_ in position coordinates.
+    cv::Mat_<uint16_t> region_map_;
+    cv::Rect map_roi_;
+
+    // Maximum number of map elements. Beyond this, regions are checked
+    // using polygon tests instead.
+    static constexpr int MAX_MAP_AREA {1 << 26};
 
     /**
      * Check the position to see if it lies within any of the
@@ -67,6 +79,19 @@ private:
      * @param position Position to be filtered
      */
     void filter(oat::Position2D &position) override;
+
+    /**
+     * Rasterize region contours into the region map so that the region
+     * containing a position can be found with a single lookup.
+     */
+    void createRegionMap(void);
+
+    /**
+     * Get the ID of the region containing a point.
+     * @param pt Point to check
+     * @return Region ID, or -1 if the point is not within any region
+     */
+    int regionID(const cv::Point &pt) const;
 };
 
 }      /* namespace oat */
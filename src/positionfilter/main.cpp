@@ -33,7 +33,10 @@
 
 #include "KalmanFilter2D.h"
 #include "HomographyTransform2D.h"
+#include "LatencyPredictor2D.h"
 #include "RegionFilter2D.h"
+#include "FilterChain.h"
+#include "MultiTargetTracker.h"
 
 namespace po = boost::program_options;
 
@@ -43,12 +46,19 @@ volatile sig_atomic_t source_eof = 0;
 void printUsage(po::options_description options) {
     std::cout << "Usage: posifilt [INFO]\n"
               << "   or: posifilt TYPE SOURCE SINK [CONFIGURATION]\n"
+              << "   or: posifilt track SOURCES SINK [CONFIGURATION]\n"
               << "Filter positions from SOURCE and published filtered positions "
               << "to SINK.\n\n"
               << "TYPE\n"
               << "  kalman: Kalman filter\n"
               << "  homography: homography transform\n"
-              << "  region: position region annotation\n\n"
+              << "  region: position region annotation\n"
+              << "  predict: latency-compensating position prediction\n"
+              << "  chain: ordered chain of the filters above, applied within a\n"
+              << "         single component\n"
+              << "  track: multi-target tracker. Candidate positions are received\n"
+              << "         from one or more SOURCES and the position of track i is\n"
+              << "         published to SINK_i\n\n"
               << "SOURCE:\n"
               << "  User-supplied name of the memory segment to receive "
               << "positions from (e.g. rpos).\n\n"
@@ -83,12 +93,33 @@ void run(std::shared_ptr<oat::PositionFilter> filter) {
     }
 }
 
+// Multi-target tracker processing loop
+void run(std::shared_ptr<oat::MultiTargetTracker> tracker) {
+
+    try {
+
+        tracker->connectToNodes();
+
+        while (!quit && !source_eof) {
+            source_eof = tracker->process();
+        }
+
+    } catch (const boost::interprocess::interprocess_exception &ex) {
+
+        // Error code 1 indicates a SIGNINT during a call to wait(), which
+        // is normal behavior
+        if (ex.get_error_code() != 1)
+            throw;
+    }
+}
+
 int main(int argc, char *argv[]) {
 
     std::signal(SIGINT, sigHandler);
 
     // The image source to which the viewer will be attached
     std::string type;
+    std::vector<std::string> sources;
     std::string source;
     std::string sink;
     std::vector<std::string> config_fk;
@@ -99,6 +130,9 @@ int main(int argc, char *argv[]) {
     type_hash["kalman"] = 'a';
     type_hash["homography"] = 'b';
     type_hash["region"] = 'c';
+    type_hash["chain"] = 'd';
+    type_hash["predict"] = 'e';
+    type_hash["track"] = 'f';
 
     try {
 
@@ -117,18 +151,15 @@ int main(int argc, char *argv[]) {
         po::options_description hidden("HIDDEN OPTIONS");
         hidden.add_options()
                 ("type", po::value<std::string>(&type), "Filter TYPE.")
-                ("position-source", po::value<std::string>(&source),
-                "The name of the server that supplies object position information."
-                "The server must be of type SMServer<Position>\n")
-                ("sink", po::value<std::string>(&sink),
-                "The name of the sink to which filtered positions will be published."
-                "The server must be of type SMServer<Position>\n")
+                ("position-sources", po::value<std::vector<std::string> >(),
+                "The names of the servers that supply object position information, "
+                "followed by the name of the sink to which filtered positions "
+                "will be published.\n")
                 ;
 
         po::positional_options_description positional_options;
         positional_options.add("type", 1);
-        positional_options.add("position-source", 1);
-        positional_options.add("sink", 1);
+        positional_options.add("position-sources", -1); // Last positional argument is the sink.
 
         visible_options.add(options).add(config);
 
@@ -166,18 +197,30 @@ int main(int argc, char *argv[]) {
             return -1;
         }
 
-        if (!variable_map.count("position-source")) {
+        if (!variable_map.count("position-sources")) {
             printUsage(visible_options);
             std::cout <<  oat::Error("A position SOURCE must be specified.\n");
             return -1;
         }
 
-        if (!variable_map.count("sink")) {
+        sources = variable_map["position-sources"].as< std::vector<std::string> >();
+        if (sources.size() < 2) {
             printUsage(visible_options);
             std::cout <<  oat::Error("A position SINK must be specified.\n");
             return -1;
         }
 
+        // Last positional argument is the sink.
+        sink = sources.back();
+        sources.pop_back();
+        source = sources[0];
+
+        if (sources.size() > 1 && type.compare("track") != 0) {
+            printUsage(visible_options);
+            std::cout <<  oat::Error("Only TYPE=track accepts multiple position SOURCES.\n");
+            return -1;
+        }
+
         if (!variable_map.count("config") && type.compare("homography") == 0) {
             printUsage(visible_options);
             std::cerr << oat::Error("When TYPE=homography, a configuration file must be specified"
@@ -185,6 +228,13 @@ int main(int argc, char *argv[]) {
             return -1;
         }
 
+        if (!variable_map.count("config") && type.compare("chain") == 0) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("When TYPE=chain, a configuration file must be specified"
+                                    " to provide the filter list.\n");
+            return -1;
+        }
+
         if (!variable_map["config"].empty()) {
 
             config_fk = variable_map["config"].as<std::vector<std::string> >();
@@ -206,6 +256,58 @@ int main(int argc, char *argv[]) {
         return -1;
     }
 
+    // The multi-target tracker has multiple SOURCES and SINKS, so it is
+    // handled separately from the single SOURCE filters
+    if (type_hash[type] == 'f') {
+
+        auto tracker = std::make_shared<oat::MultiTargetTracker>(sources, sink);
+
+        try {
+
+            if (config_used)
+                tracker->configure(config_fk[0], config_fk[1]);
+
+            // Tell user
+            std::cout << oat::whoMessage(tracker->name(), "Listening to sources ");
+            for (auto s : sources)
+                std::cout << oat::sourceText(s) << " ";
+            std::cout << ".\n";
+
+            std::cout << oat::whoMessage(tracker->name(), "Steaming to sinks ");
+            for (auto s : tracker->sink_addresses())
+                std::cout << oat::sinkText(s) << " ";
+            std::cout << ".\n";
+
+            std::cout << oat::whoMessage(tracker->name(),
+                         "Press CTRL+C to exit.\n");
+
+            // Infinite loop until ctrl-c or server end-of-stream signal
+            run(tracker);
+
+            // Tell user
+            std::cout << oat::whoMessage(tracker->name(), "Exiting.\n");
+
+            // Exit
+            return 0;
+
+        } catch (const cpptoml::parse_exception &ex) {
+            std::cerr << oat::whoError(tracker->name(),
+                         "Failed to parse configuration file " + config_fk[0]  + "\n")
+                      << oat::whoError(tracker->name(), ex.what()) << "\n";
+        } catch (const std::runtime_error &ex) {
+            std::cerr << oat::whoError(tracker->name(), ex.what()) << "\n";
+        } catch (const cv::Exception &ex) {
+            std::cerr << oat::whoError(tracker->name(), ex.what()) << "\n";
+        } catch (const boost::interprocess::interprocess_exception &ex) {
+            std::cerr << oat::whoError(tracker->name(), ex.what()) << "\n";
+        } catch (...) {
+            std::cerr << oat::whoError(tracker->name(), "Unknown exception.\n");
+        }
+
+        // Exit failure
+        return -1;
+    }
+
     // Create component
     std::shared_ptr<oat::PositionFilter> filter;
 
@@ -226,6 +328,16 @@ int main(int argc, char *argv[]) {
             filter = std::make_shared<oat::RegionFilter2D>(source, sink);
             break;
         }
+        case 'd':
+        {
+            filter = std::make_shared<oat::FilterChain>(source, sink);
+            break;
+        }
+        case 'e':
+        {
+            filter = std::make_shared<oat::LatencyPredictor2D>(source, sink);
+            break;
+        }
         default:
         {
             printUsage(visible_options);
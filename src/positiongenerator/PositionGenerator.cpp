@@ -102,7 +102,7 @@ template<typename T>
 void PositionGenerator<T>::connectToNode() {
 
     // Bind to sink sink node and create a shared position
-    position_sink_.bind(position_sink_address_, position_sink_address_);
+    position_sink_.bind(position_sink_address_);
     shared_position_ = position_sink_.retrieve();
 
     // Setup sample rate info on internal copy
@@ -121,6 +121,9 @@ bool PositionGenerator<T>::process() {
         tick_ = clock_.now();
     }
 
+    // Stamp generation time on the shared monotonic clock
+    internal_position_.sample().stampMonotonic();
+
     // START CRITICAL SECTION //
     ////////////////////////////
 
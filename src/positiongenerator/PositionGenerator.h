@@ -121,7 +121,7 @@ private:
     std::string name_;
 
     // Internally generated position
-    T internal_position_ {"internal"};
+    T internal_position_;
 
     // Shared position
     T * shared_position_;
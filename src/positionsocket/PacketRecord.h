@@ -0,0 +1,143 @@
+//******************************************************************************
+//* File:   PacketRecord.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_PACKETRECORD_H
+#define	OAT_PACKETRECORD_H
+
+#include <algorithm>
+#include <bitset>
+#include <string>
+#include <vector>
+
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionLog.h"
+#include "../../lib/datatypes/PositionPacket.h"
+#include "../../lib/datatypes/PositionRegistry.h"
+
+namespace oat {
+
+/**
+ * @brief Convert a position to a binary UDP protocol record.
+ * @param p Position to convert
+ * @param r Record to fill
+ */
+inline void toPacketRecord(const oat::Position2D &p, oat_packet_record &r) {
+
+    const auto &s = p.sample();
+    r.tick = s.count();
+    r.usec = s.microseconds().count();
+    r.monotonic_usec = s.monotonic_microseconds().count();
+    r.position[0] = p.position.x;
+    r.position[1] = p.position.y;
+    r.velocity[0] = p.velocity.x;
+    r.velocity[1] = p.velocity.y;
+    r.heading[0] = p.heading.x;
+    r.heading[1] = p.heading.y;
+    r.region = p.region_id;
+
+    // Same bits as the binary position log
+    r.flags = 0;
+    if (p.position_valid) r.flags |= oat::poslog::POSITION_VALID;
+    if (p.velocity_valid) r.flags |= oat::poslog::VELOCITY_VALID;
+    if (p.heading_valid) r.flags |= oat::poslog::HEADING_VALID;
+    if (p.region_valid) r.flags |= oat::poslog::REGION_VALID;
+    if (p.unit_of_length() == oat::DistanceUnit::WORLD)
+        r.flags |= oat::poslog::UNIT_WORLD;
+}
+
+/**
+ * Region IDs used by the positions a sender has transmitted. Region IDs are
+ * only meaningful on the sending host, so receivers are sent region
+ * dictionary datagrams that name them.
+ */
+class RegionDictionary {
+
+public:
+
+    /**
+     * @brief Note the region of a position that is about to be sent.
+     * @param p Position
+     * @return True if the position has a region that was not used before,
+     * in which case the dictionary must be sent before the position.
+     */
+    bool add(const oat::Position2D &p) {
+
+        if (!p.region_valid || p.region_id >= seen_.size()
+            || seen_[p.region_id])
+            return false;
+
+        seen_[p.region_id] = true;
+        ids_.push_back(p.region_id);
+        return true;
+    }
+
+    bool empty(void) const { return ids_.empty(); }
+
+    /**
+     * @brief Encode the dictionary into as many datagrams as required and
+     * pass each to a callback.
+     * @param buf Buffer to encode into, of at least MAX_DATAGRAM bytes.
+     * @param sequence Datagram sequence number, incremented for each
+     * datagram.
+     * @param send Callback taking the datagram's size in bytes.
+     */
+    template <typename F>
+    void encode(char *buf, uint32_t &sequence, F send) const {
+
+        for (size_t first = 0; first < ids_.size();
+             first += OAT_PACKET_MAX_RECORDS) {
+
+            const size_t n = std::min(ids_.size() - first,
+                                      static_cast<size_t>(OAT_PACKET_MAX_RECORDS));
+
+            oat_packet_header h;
+            h.type = OAT_PACKET_REGIONS;
+            h.count = static_cast<uint8_t>(n);
+            h.sequence = sequence++;
+            h.send_usec = oat::Sample::monotonicNow().count();
+            oat_packet_encode_header(buf, &h);
+
+            size_t offset = OAT_PACKET_HEADER_SIZE;
+            for (size_t i = first; i < first + n; i++) {
+                const std::string name = oat::PositionRegistry::regionName(ids_[i]);
+                oat_packet_region r;
+                r.id = ids_[i];
+                r.length = static_cast<uint8_t>(std::min(name.size(),
+                                                         static_cast<size_t>(255)));
+                r.name = name.c_str();
+                offset = oat_packet_encode_region(buf, offset, &r);
+            }
+
+            send(offset);
+        }
+    }
+
+    // Largest datagram produced by encode()
+    static constexpr size_t MAX_DATAGRAM {
+        OAT_PACKET_HEADER_SIZE
+        + OAT_PACKET_MAX_RECORDS * (3 + oat::PositionRegistry::REGION_NAME_SIZE - 1)};
+
+private:
+
+    std::bitset<oat::PositionRegistry::MAX_REGIONS> seen_;
+    std::vector<oat::RegionID> ids_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_PACKETRECORD_H */
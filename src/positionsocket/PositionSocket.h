@@ -76,7 +76,7 @@ private:
     oat::Source<oat::Position2D> position_source_;
 
     // The current, internally allocated position
-    oat::Position2D internal_position_ {"internal"};
+    oat::Position2D internal_position_;
 };
 
 }      /* namespace oat */
@@ -17,13 +17,21 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //******************************************************************************
 
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/ip/udp.hpp>
 
 #include <rapidjson/rapidjson.h>
 
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionPacket.h"
 
+#include "PacketRecord.h"
 #include "SocketWriteStream.h"
 #include "UDPPositionClient.h"
 
@@ -36,17 +44,137 @@ UDPPositionClient::UDPPositionClient(const std::string &position_source_address,
 , socket_(io_service_, UDPEndpoint(boost::asio::ip::udp::v4(), 0)) {
 
     UDPResolver resolver(io_service_);
-    UDPEndpoint endpoint = *resolver.resolve({boost::asio::ip::udp::v4(),
-                                              host,
-                                              port});
+    endpoint_ = *resolver.resolve({boost::asio::ip::udp::v4(),
+                                   host,
+                                   port});
 
     udp_stream_.reset(new rapidjson::SocketWriteStream<UDPSocket, UDPEndpoint>(
-            &socket_, endpoint, buffer_, sizeof(buffer_)));
+            &socket_, endpoint_, buffer_, sizeof(buffer_)));
 }
 
-// Each position is sent in a single UDP packet
+UDPPositionClient::~UDPPositionClient() {
+
+    {
+        std::lock_guard<std::mutex> lk(batch_mutex_);
+        running_ = false;
+    }
+
+    batch_cv_.notify_one();
+    if (flush_thread_.joinable())
+        flush_thread_.join();
+
+    try {
+        if (binary_ && num_pending_ > 0)
+            sendPacket();
+    } catch (...) {
+        // Receiver is gone
+    }
+}
+
+void UDPPositionClient::useBinary(const size_t batch,
+                                  const Clock::duration max_delay) {
+
+    if (batch < 1 || batch > OAT_PACKET_MAX_RECORDS)
+        throw (std::runtime_error("Binary batch size must be between 1 and "
+                                  + std::to_string(OAT_PACKET_MAX_RECORDS)
+                                  + "."));
+
+    static_assert(OAT_PACKET_HEADER_SIZE
+                  + OAT_PACKET_MAX_RECORDS * OAT_PACKET_RECORD_SIZE
+                  <= MAX_LENGTH, "Binary batch exceeds datagram size.");
+    static_assert(oat::RegionDictionary::MAX_DATAGRAM <= MAX_LENGTH,
+                  "Region dictionary exceeds datagram size.");
+
+    binary_ = true;
+    batch_ = batch;
+    max_delay_ = max_delay;
+
+    // Single position datagrams are sent immediately
+    if (batch_ > 1)
+        flush_thread_ = std::thread([this] { flushLoop(); });
+}
+
+void UDPPositionClient::flushLoop() {
+
+    std::unique_lock<std::mutex> lk(batch_mutex_);
+
+    while (running_) {
+
+        if (num_pending_ == 0) {
+            batch_cv_.wait(lk);
+            continue;
+        }
+
+        // The deadline is set when the first record of a batch is encoded
+        if (Clock::now() < batch_deadline_) {
+            batch_cv_.wait_until(lk, batch_deadline_);
+            continue;
+        }
+
+        try {
+            sendPacket();
+        } catch (...) {
+            // Datagram is lost, as it would be on the network
+            num_pending_ = 0;
+        }
+    }
+}
+
+void UDPPositionClient::sendPacket() {
+
+    oat_packet_header h;
+    h.type = OAT_PACKET_POSITIONS;
+    h.count = static_cast<uint8_t>(num_pending_);
+    h.sequence = sequence_++;
+    h.send_usec = oat::Sample::monotonicNow().count();
+    oat_packet_encode_header(buffer_, &h);
+
+    socket_.send_to(boost::asio::buffer(buffer_, oat_packet_size(num_pending_)),
+                    endpoint_);
+    num_pending_ = 0;
+}
+
+void UDPPositionClient::sendRegions(const Clock::time_point now) {
+
+    regions_.encode(region_buffer_, sequence_, [this](const size_t size) {
+        socket_.send_to(boost::asio::buffer(region_buffer_, size), endpoint_);
+    });
+
+    next_regions_send_ = now + std::chrono::seconds(1);
+}
+
+// Each position is sent in a single UDP packet, unless binary positions are
+// batched, in which case a datagram is sent when the batch is full or its
+// first position has waited for max_delay_
 void UDPPositionClient::sendPosition(const oat::Position2D& current_position) {
 
+    if (binary_) {
+
+        oat_packet_record r;
+        oat::toPacketRecord(current_position, r);
+
+        std::unique_lock<std::mutex> lk(batch_mutex_);
+
+        // Receivers are sent the names of region IDs before they are used,
+        // and periodically in case a dictionary datagram was lost
+        const auto now = Clock::now();
+        if (regions_.add(current_position)
+            || (!regions_.empty() && now >= next_regions_send_))
+            sendRegions(now);
+
+        oat_packet_encode_record(buffer_, num_pending_++, &r);
+
+        if (num_pending_ == batch_) {
+            sendPacket();
+        } else if (num_pending_ == 1) {
+            batch_deadline_ = now + max_delay_;
+            lk.unlock();
+            batch_cv_.notify_one();
+        }
+
+        return;
+    }
+
     rapidjson::Writer < rapidjson::SocketWriteStream
                       < UDPSocket, UDPEndpoint > > udp_writer_ {*udp_stream_};
 
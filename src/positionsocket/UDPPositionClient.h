@@ -20,11 +20,18 @@
 #ifndef OAT_UDPCLIENT_H
 #define	OAT_UDPCLIENT_H
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/ip/udp.hpp>
 
 #include <rapidjson/rapidjson.h>
 
+#include "../../lib/datatypes/PositionPacket.h"
+
+#include "PacketRecord.h"
 #include "SocketWriteStream.h"
 #include "PositionSocket.h"
 
@@ -39,6 +46,7 @@ class UDPPositionClient : public PositionSocket {
     using UDPEndpoint = boost::asio::ip::udp::endpoint;
     using UDPResolver = boost::asio::ip::udp::resolver;
     using SocketWriter = rapidjson::SocketWriteStream<UDPSocket, UDPEndpoint>;
+    using Clock = std::chrono::steady_clock;
 
 public:
     // TODO: What if user requests port less than 1000 without sudo?
@@ -46,6 +54,21 @@ public:
                       const std::string &host,
                       const std::string &port);
 
+    /**
+     * @brief Send partially filled binary batches before closing.
+     */
+    ~UDPPositionClient();
+
+    /**
+     * @brief Send positions using the binary protocol defined in
+     * PositionPacket.h rather than JSON.
+     * @param batch Maximum number of positions per datagram, from 1 to
+     * OAT_PACKET_MAX_RECORDS.
+     * @param max_delay A partially filled batch is sent once its first
+     * position has waited this long.
+     */
+    void useBinary(const size_t batch, const Clock::duration max_delay);
+
 private:
 
     // IO service
@@ -56,9 +79,48 @@ private:
     char buffer_[MAX_LENGTH]; // Buffer is flushed after each position read
 
     UDPSocket socket_;
+    UDPEndpoint endpoint_;
     std::unique_ptr<SocketWriter> udp_stream_;
 
+    // Binary protocol state. Records are encoded directly into buffer_.
+    bool binary_ {false};
+    size_t batch_ {1};
+    size_t num_pending_ {0};
+    uint32_t sequence_ {0};
+
+    // Region IDs sent so far, whose names are sent in separate datagrams
+    oat::RegionDictionary regions_;
+    char region_buffer_[oat::RegionDictionary::MAX_DATAGRAM];
+    Clock::time_point next_regions_send_;
+
+    // Partially filled batches are sent by flush_thread_ when their deadline
+    // expires. batch_mutex_ guards the binary protocol state and buffer_.
+    Clock::duration max_delay_ {0};
+    Clock::time_point batch_deadline_;
+    std::mutex batch_mutex_;
+    std::condition_variable batch_cv_;
+    std::thread flush_thread_;
+    bool running_ {true};
+
     void sendPosition(const oat::Position2D& position) override;
+
+    /**
+     * @brief Send the binary records encoded so far in a single datagram.
+     * Must be called with batch_mutex_ held.
+     */
+    void sendPacket(void);
+
+    /**
+     * @brief Send the region dictionary. Must be called with batch_mutex_
+     * held.
+     * @param now Current time
+     */
+    void sendRegions(const Clock::time_point now);
+
+    /**
+     * @brief Send partially filled batches whose deadline has expired.
+     */
+    void flushLoop(void);
 };
 
 }      /* namespace oat */
@@ -17,53 +17,267 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //******************************************************************************
 
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/ip/udp.hpp>
-#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/steady_timer.hpp>
 
 #include <rapidjson/rapidjson.h>
 
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionPacket.h"
+#include "../../lib/utility/IOFormat.h"
 
+#include "PacketRecord.h"
 #include "SocketWriteStream.h"
 #include "UDPPositionServer.h"
 
 namespace oat {
 
 UDPPositionServer::UDPPositionServer(const std::string &position_source_address,
-                                     const unsigned short port) :
+                                     const unsigned short port,
+                                     const double keepalive_sec) :
   PositionSocket(position_source_address)
 , socket_(io_service_, UDPEndpoint(boost::asio::ip::udp::v4(), port))
-, input_deadline_(io_service_) {
+, expiry_timer_(io_service_)
+, keepalive_(std::chrono::duration_cast<Clock::duration>(
+                 std::chrono::duration<double>(keepalive_sec)))
+{
+    startReceive();
+    startExpiryTimer();
 
-    input_deadline_.expires_at(boost::posix_time::pos_infin);
+    io_thread_ = std::thread([this] { io_service_.run(); });
+}
 
-    udp_stream_.reset(new rapidjson::SocketWriteStream<UDPSocket, UDPEndpoint>(
-            &socket_, endpoint_, tx_buffer_, sizeof(tx_buffer_)));
+UDPPositionServer::~UDPPositionServer() {
 
+    io_service_.stop();
+    if (io_thread_.joinable())
+        io_thread_.join();
 }
 
 void UDPPositionServer::sendPosition(const oat::Position2D& current_position) {
 
-    rapidjson::Writer < rapidjson::SocketWriteStream
-                      < UDPSocket, UDPEndpoint > > udp_writer_ {*udp_stream_};
+    {
+        std::lock_guard<std::mutex> lock(latest_mutex_);
+        latest_ = current_position;
+        have_latest_ = true;
+    }
+
+    // At most one send is queued at a time, so a slow network cannot build
+    // up a backlog. The IO thread always sends the latest position.
+    if (!send_pending_.exchange(true))
+        io_service_.post([this] { serveClients(); });
+}
+
+void UDPPositionServer::startReceive() {
+
+    socket_.async_receive_from(
+        boost::asio::buffer(rx_buffer_, MAX_LENGTH), remote_,
+        [this](const boost::system::error_code &ec, size_t length) {
+
+            if (ec == boost::asio::error::operation_aborted)
+                return;
+
+            // Other errors, e.g. ICMP port unreachable reported for a
+            // client that has gone away, do not affect other clients
+            if (!ec)
+                handleRequest(length);
+
+            startReceive();
+        });
+}
+
+void UDPPositionServer::handleRequest(const size_t length) {
+
+    std::istringstream request(std::string(rx_buffer_, length));
+    const auto now = Clock::now();
+
+    double rate_hz = 0.0;
+    bool binary = false;
+    std::string token;
+
+    while (request >> token) {
+
+        if (token == "unsubscribe") {
+            clients_.erase(remote_);
+            return;
+        } else if (token == "binary") {
+            binary = true;
+        } else if (token == "json") {
+            binary = false;
+        } else {
+            std::istringstream value(token);
+            if (!(value >> rate_hz) || !value.eof()
+                || !std::isfinite(rate_hz) || rate_hz < 0)
+                return; // Malformed request
+        }
+    }
+
+    auto it = clients_.find(remote_);
+    if (it == clients_.end()) {
+
+        if (clients_.size() >= MAX_CLIENTS) {
+            std::cerr << oat::whoWarn(name(), "Client limit reached. Ignoring "
+                                      "request from "
+                                      + remote_.address().to_string() + ".\n");
+            return;
+        }
+
+        it = clients_.emplace(remote_, Client()).first;
+        it->second.next_send = now;
+    }
+
+    auto &client = it->second;
+    client.last_request = now;
+    client.binary = binary;
+    client.period = rate_hz > 0
+        ? std::chrono::duration_cast<Clock::duration>(
+              std::chrono::duration<double>(1.0 / rate_hz))
+        : Clock::duration::zero();
+
+    // Repeat the region dictionary in case an earlier one was lost
+    if (client.binary && !regions_.empty())
+        sendRegions(remote_, client);
+
+    // Answer a new subscription right away
+    if (!client.sent) {
+
+        oat::Position2D position;
+        {
+            std::lock_guard<std::mutex> lock(latest_mutex_);
+            if (!have_latest_)
+                return;
+            position = latest_;
+        }
+
+        noteRegion(position);
+        sendTo(remote_, client, position);
+    }
+}
+
+void UDPPositionServer::startExpiryTimer() {
+
+    expiry_timer_.expires_from_now(
+        std::max(keepalive_ / 2,
+                 std::chrono::duration_cast<Clock::duration>(
+                     std::chrono::milliseconds(100))));
+
+    expiry_timer_.async_wait([this](const boost::system::error_code &ec) {
+
+        if (ec == boost::asio::error::operation_aborted)
+            return;
+
+        const auto now = Clock::now();
+        for (auto it = clients_.begin(); it != clients_.end(); ) {
+            if (now - it->second.last_request > keepalive_)
+                it = clients_.erase(it);
+            else
+                ++it;
+        }
+
+        startExpiryTimer();
+    });
+}
+
+void UDPPositionServer::serveClients() {
+
+    // Positions arriving from here on trigger another send
+    send_pending_ = false;
+
+    oat::Position2D position;
+    {
+        std::lock_guard<std::mutex> lock(latest_mutex_);
+        position = latest_;
+    }
+
+    noteRegion(position);
+
+    const auto now = Clock::now();
+    for (auto &c : clients_) {
+
+        auto &client = c.second;
+
+        // Each position is sent once, and no faster than the client's rate
+        if ((client.sent && client.last_tick == position.sample().count())
+            || now < client.next_send)
+            continue;
+
+        sendTo(c.first, client, position);
+    }
+}
+
+void UDPPositionServer::noteRegion(const oat::Position2D &position) {
+
+    if (!regions_.add(position))
+        return;
+
+    for (auto &c : clients_)
+        if (c.second.binary)
+            sendRegions(c.first, c.second);
+}
+
+void UDPPositionServer::sendRegions(const UDPEndpoint &endpoint,
+                                    Client &client) {
+
+    regions_.encode(tx_buffer_, client.sequence,
+                    [this, &endpoint](const size_t size) {
+                        boost::system::error_code ec;
+                        socket_.send_to(boost::asio::buffer(tx_buffer_, size),
+                                        endpoint, 0, ec);
+                    });
+}
+
+void UDPPositionServer::sendTo(const UDPEndpoint &endpoint,
+                               Client &client,
+                               const oat::Position2D &position) {
+
+    boost::system::error_code ec;
+
+    if (client.binary) {
+
+        oat_packet_header h;
+        h.type = OAT_PACKET_POSITIONS;
+        h.count = 1;
+        h.sequence = client.sequence++;
+        h.send_usec = oat::Sample::monotonicNow().count();
+        oat_packet_encode_header(tx_buffer_, &h);
+
+        oat_packet_record r;
+        oat::toPacketRecord(position, r);
+        oat_packet_encode_record(tx_buffer_, 0, &r);
+
+        socket_.send_to(boost::asio::buffer(tx_buffer_, oat_packet_size(1)),
+                        endpoint, 0, ec);
+
+    } else {
 
-    // Need to receive request from remote client in order to proceed.
-    // TODO: check request message contents?
-    // TODO: A request does not nessesarily result in a full positional datum being sent, but just
-    //       in the current position being serialized and maybe sent if flush is called within the
-    //       the SocktWriteStream.
-    // TODO: This operation needs a timeout to prevent everything from locking up
-    //       the program wants to quit but nobody is sending any requests.
+        // Each position is serialized into a single UDP packet
+        rapidjson::SocketWriteStream<UDPSocket, UDPEndpoint> stream(
+            &socket_, endpoint, tx_buffer_, sizeof(tx_buffer_));
+        rapidjson::Writer < rapidjson::SocketWriteStream
+                          < UDPSocket, UDPEndpoint > > writer {stream};
 
-    /*size_t length = */ socket_.receive_from(
-        boost::asio::buffer(rx_buffer_, MAX_LENGTH), endpoint_);
+        position.Serialize(writer);
 
-    current_position.Serialize(udp_writer_);
+        try {
+            stream.Flush();
+        } catch (const boost::system::system_error &ex) {
+            ec = ex.code();
+        }
+    }
 
-    // Flush the stream after each Serialization call so that each UDP packet
-    // corresponds to a single position value
-    udp_stream_->Flush();
+    // Failed sends are not retried. The client can renew its subscription.
+    const auto now = Clock::now();
+    client.sent = true;
+    client.last_tick = position.sample().count();
+    client.next_send = client.period > Clock::duration::zero()
+        ? std::max(client.next_send + client.period, now)
+        : now;
 }
 
-} /* namespace oat */
\ No newline at end of file
+} /* namespace oat */
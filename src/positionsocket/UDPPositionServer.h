@@ -20,64 +20,142 @@
 #ifndef OAT_UDPSERVER_H
 #define	OAT_UDPSERVER_H
 
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/ip/udp.hpp>
+#include <boost/asio/steady_timer.hpp>
 
-#include <rapidjson/rapidjson.h>
+#include "../../lib/datatypes/Position2D.h"
 
-#include "SocketWriteStream.h"
+#include "PacketRecord.h"
 #include "PositionSocket.h"
 
 namespace oat {
 
-// Forward decl.
-class Position2D;
-
+/**
+ * Asynchronous, multi-client UDP position server. Clients subscribe by
+ * sending a request datagram to the server's port and are then sent the
+ * latest position, at most at the rate they requested, until they
+ * unsubscribe or stop renewing their subscription. Network IO is performed
+ * on a dedicated thread, so the processing pipeline never waits for clients.
+ *
+ * Requests are short ASCII datagrams of whitespace separated tokens:
+ *
+ *  - `[RATE] [json|binary]` subscribes or renews a subscription. RATE is the
+ *    maximum number of positions per second to send (0 or omitted to send
+ *    each new position). Positions are sent as JSON (default) or using the
+ *    binary protocol defined in PositionPacket.h. Binary clients are sent
+ *    the region dictionary in reply to each request and whenever a new
+ *    region is used.
+ *  - `unsubscribe` ends a subscription.
+ */
 class UDPPositionServer : public PositionSocket {
 
     using UDPSocket = boost::asio::ip::udp::socket;
     using UDPEndpoint = boost::asio::ip::udp::endpoint;
-    using UDPResolver = boost::asio::ip::udp::resolver;
-    using DeadlineTimer = boost::asio::deadline_timer;
+    using SteadyTimer = boost::asio::steady_timer;
+    using Clock = std::chrono::steady_clock;
 
 public:
 
     /**
-     *
-     * @param position_source_name
-     * @param port
+     * @brief Bind the server's socket and start its IO thread.
+     * @param position_source_name Position SOURCE to serve
+     * @param port Port on which to accept requests
+     * @param keepalive_sec A client's subscription expires if it does not
+     * renew it within this period.
      */
     UDPPositionServer(const std::string& position_source_name,
-             const unsigned short port);
+                      const unsigned short port,
+                      const double keepalive_sec);
+
+    ~UDPPositionServer();
+
+    // Maximum number of simultaneous subscriptions
+    static constexpr size_t MAX_CLIENTS {64};
 
 private:
 
-    // IO service
+    /**
+     * State of a single subscription. Only accessed by the IO thread.
+     */
+    struct Client {
+        Clock::duration period {0};  //!< Minimum time between sends
+        bool binary {false};
+        Clock::time_point last_request;
+        Clock::time_point next_send;
+        uint64_t last_tick {0};      //!< Sample number of last position sent
+        bool sent {false};           //!< A position has been sent
+        uint32_t sequence {0};       //!< Binary datagram sequence number
+    };
+
+    // IO service and the thread running it
     boost::asio::io_service io_service_;
+    std::thread io_thread_;
 
     // RX/TX buffers
-    static const size_t MAX_LENGTH {65507}; // max udp buffer size
-    char tx_buffer_[MAX_LENGTH]; // Buffer is flushed after each position read
+    static constexpr size_t MAX_LENGTH {65507}; // max udp buffer size
+    char tx_buffer_[MAX_LENGTH];
     char rx_buffer_[MAX_LENGTH];
 
     // UDP communication specs
     UDPSocket socket_;
-    UDPEndpoint endpoint_;
-    DeadlineTimer input_deadline_;
+    UDPEndpoint remote_;
+    SteadyTimer expiry_timer_;
+    const Clock::duration keepalive_;
+
+    // Subscribed clients
+    std::map<UDPEndpoint, Client> clients_;
 
-    // Custom RapidJSON UDP stream and writer
-    std::unique_ptr < rapidjson::SocketWriteStream
-                    < UDPSocket, UDPEndpoint > > udp_stream_;
+    // Region IDs sent to binary clients so far
+    oat::RegionDictionary regions_;
+
+    // Most recent position, handed from the pipeline to the IO thread
+    std::mutex latest_mutex_;
+    oat::Position2D latest_;
+    bool have_latest_ {false};
+
+    // A send to clients has been posted to the IO thread but not yet run
+    std::atomic<bool> send_pending_ {false};
 
     /**
-     *
-     * @param position
-     * @param sample
+     * @brief Store the position and wake the IO thread. Does not block on
+     * the network.
+     * @param position Position to serve.
      */
     void sendPosition(const oat::Position2D& position) override;
 
+    void startReceive(void);
+    void handleRequest(const size_t length);
+    void startExpiryTimer(void);
+
+    /**
+     * @brief Send the latest position to each client that is due for one.
+     */
+    void serveClients(void);
+
+    /**
+     * @brief Note the region of a position that is about to be sent, and
+     * send the region dictionary to binary clients if it is new.
+     */
+    void noteRegion(const oat::Position2D &position);
+
+    /**
+     * @brief Send the region dictionary to a single binary client.
+     */
+    void sendRegions(const UDPEndpoint &endpoint, Client &client);
+
+    /**
+     * @brief Send a position to a single client.
+     */
+    void sendTo(const UDPEndpoint &endpoint, Client &client,
+                const oat::Position2D &position);
 };
 
 }      /* namespace oat */
 #endif /* OAT_UDPSERVER_H */
-
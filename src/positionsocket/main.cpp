@@ -19,6 +19,7 @@
 
 #include "OatConfig.h" // Generated by CMake
 
+#include <chrono>
 #include <csignal>
 #include <unordered_map>
 #include <string>
@@ -32,6 +33,7 @@
 #include "PositionPublisher.h"
 #include "PositionReplier.h"
 #include "UDPPositionClient.h"
+#include "UDPPositionServer.h"
 
 namespace po = boost::program_options;
 
@@ -52,7 +54,12 @@ void printUsage(po::options_description options) {
               << "       endpoint.Several transport/protocol options. The most\n"
               << "       useful are tcp and interprocess (ipc).\n"
               << "  udp: Asynchronous, client-side, unicast user datagram protocol\n"
-              << "       over a traditional BSD-style socket.\n\n"
+              << "       over a traditional BSD-style socket. Positions are sent\n"
+              << "       as JSON, or in binary using --binary.\n"
+              << "  srv: Asynchronous, multi-client user datagram protocol server.\n"
+              << "       Clients subscribe by sending a request datagram and are\n"
+              << "       sent the latest position at their requested rate until\n"
+              << "       they unsubscribe or their subscription expires.\n\n"
               << "ENDPOINT:\n"
               << "Device to send positions to.\n"
               << "  When TYPE is pos or rep, this is specified using a ZMQ-style\n"
@@ -60,7 +67,9 @@ void printUsage(po::options_description options) {
               << "  'tcp://*:5555' or 'ipc://*:5556' specify TCP and interprocess\n"
               << "  communication on ports 5555 or 5556, respectively\n"
               << "  When TYPE is udp, this is specified as '<host> <port>'\n"
-              << "  For instance, '10.0.0.1 5555'.\n\n"
+              << "  For instance, '10.0.0.1 5555'.\n"
+              << "  When TYPE is srv, this is the port on which to accept\n"
+              << "  requests. For instance, '5555'.\n\n"
               << options << "\n";
 }
 
@@ -95,6 +104,10 @@ int main(int argc, char *argv[]) {
     std::string type;
     std::string source;
     std::vector<std::string> endpoint;
+    bool binary = false;
+    int batch = 1;
+    double max_delay_ms = 5.0;
+    double keepalive_sec = 5.0;
     po::options_description visible_options("OPTIONS");
 
     std::unordered_map<std::string, char> type_hash;
@@ -102,6 +115,7 @@ int main(int argc, char *argv[]) {
     type_hash["rep"] = 'b';
     type_hash["udp"] = 'c';
     type_hash["std"] = 'd';
+    type_hash["srv"] = 'e';
 
     try {
 
@@ -109,7 +123,29 @@ int main(int argc, char *argv[]) {
         options.add_options()
                 ("help", "Produce help message.")
                 ("version,v", "Print version information.")
-                //TODO: Serialization protocol (JSON, CBOR, etc)
+                ;
+
+        po::options_description config("CONFIGURATION");
+        config.add_options()
+                ("binary,b",
+                 "For udp TYPE, send positions using Oat's binary position "
+                 "protocol rather than JSON. Each datagram holds a sequence "
+                 "number, a send timestamp, and one or more fixed size, "
+                 "little-endian position records. See "
+                 "lib/datatypes/PositionPacket.h for the format and a C "
+                 "decoder.")
+                ("batch", po::value<int>(&batch),
+                 "For udp TYPE with --binary, the number of positions sent in "
+                 "each datagram, from 1 (default) to 255. Batching reduces "
+                 "per-datagram overhead at the cost of latency.")
+                ("max-delay", po::value<double>(&max_delay_ms),
+                 "For udp TYPE with --batch, the maximum time, in "
+                 "milliseconds, that a position waits for its batch to fill "
+                 "before the batch is sent partially filled (default 5).")
+                ("keepalive", po::value<double>(&keepalive_sec),
+                 "For srv TYPE, seconds after its last request that a client's "
+                 "subscription expires (default 5). Clients must repeat their "
+                 "request within this period to keep receiving positions.")
                 ;
 
         po::options_description hidden("HIDDEN OPTIONS");
@@ -127,10 +163,10 @@ int main(int argc, char *argv[]) {
         positional_options.add("positionsource", 1);
         positional_options.add("endpoint", -1);
 
-        visible_options.add(options);
+        visible_options.add(options).add(config);
 
         po::options_description all_options("ALL OPTIONS");
-        all_options.add(options).add(hidden);
+        all_options.add(options).add(config).add(hidden);
 
         po::variables_map variable_map;
         po::store(po::command_line_parser(argc, argv)
@@ -181,10 +217,59 @@ int main(int argc, char *argv[]) {
                 printUsage(visible_options);
                 std::cerr << oat::Error("udp endpoint must be specified as <host> <port>.\n");
                 return -1;
+            } else if (type == "srv"
+                       && (endpoint.size() != 1
+                           || endpoint[0].find_first_not_of("0123456789") != std::string::npos
+                           || endpoint[0].size() > 5
+                           || std::stoi(endpoint[0]) > 65535)) {
+                printUsage(visible_options);
+                std::cerr << oat::Error("srv endpoint must be specified as <port>.\n");
+                return -1;
             }
         } else if(type != "std") {
             printUsage(visible_options);
             std::cerr << oat::Error("An endpoint must be specified.\n");
+            return -1;
+        }
+
+        binary = variable_map.count("binary") > 0;
+
+        if ((binary || variable_map.count("batch")
+             || variable_map.count("max-delay")) && type != "udp") {
+            printUsage(visible_options);
+            std::cerr << oat::Error("--binary, --batch, and --max-delay apply to the udp TYPE only.\n");
+            return -1;
+        }
+
+        if ((variable_map.count("batch") || variable_map.count("max-delay"))
+            && !binary) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("--batch and --max-delay require --binary.\n");
+            return -1;
+        }
+
+        if (max_delay_ms < 0) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("Maximum batch delay must be non-negative.\n");
+            return -1;
+        }
+
+        if (variable_map.count("keepalive") && type != "srv") {
+            printUsage(visible_options);
+            std::cerr << oat::Error("--keepalive applies to the srv TYPE only.\n");
+            return -1;
+        }
+
+        if (keepalive_sec <= 0) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("Keepalive period must be positive.\n");
+            return -1;
+        }
+
+        if (batch < 1 || batch > 255) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("Batch size must be between 1 and 255.\n");
+            return -1;
         }
 
     } catch (std::exception& e) {
@@ -216,7 +301,12 @@ int main(int argc, char *argv[]) {
             }
             case 'c':
             {
-                socket = std::make_shared<oat::UDPPositionClient>(source, endpoint[0], endpoint[1]);
+                auto udp = std::make_shared<oat::UDPPositionClient>(source, endpoint[0], endpoint[1]);
+                if (binary)
+                    udp->useBinary(static_cast<size_t>(batch),
+                                   std::chrono::microseconds(
+                                       static_cast<int64_t>(max_delay_ms * 1000)));
+                socket = udp;
                 break;
             }
             case 'd':
@@ -224,6 +314,14 @@ int main(int argc, char *argv[]) {
                 socket = std::make_shared<oat::PositionCout>(source);
                 break;
             }
+            case 'e':
+            {
+                socket = std::make_shared<oat::UDPPositionServer>(
+                    source,
+                    static_cast<unsigned short>(std::stoi(endpoint[0])),
+                    keepalive_sec);
+                break;
+            }
             default:
             {
                 printUsage(visible_options);
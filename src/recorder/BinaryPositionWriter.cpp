@@ -0,0 +1,176 @@
+//******************************************************************************
+//* File:   BinaryPositionWriter.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+#include "BinaryPositionWriter.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#include "../../lib/utility/FileFormat.h"
+
+namespace oat {
+
+BinaryPositionWriter::~BinaryPositionWriter()
+{
+    if (fd_ == nullptr)
+        return;
+
+    flushChunk();
+    writeDictionary();
+    fclose(fd_);
+}
+
+void BinaryPositionWriter::initialize(const std::string &source_name,
+                                      const oat::Position2D &p) {
+
+    // Position file
+    fd_ = fopen(path_.c_str(), "wb");
+    if (fd_ == nullptr)
+        throw (std::runtime_error("Could not open " + path_ + " for writing."));
+
+    poslog::FileHeader hdr;
+    std::memset(&hdr, 0, sizeof(hdr));
+    std::memcpy(hdr.magic, poslog::MAGIC, sizeof(hdr.magic));
+    hdr.version = poslog::VERSION;
+    hdr.chunk_size = poslog::CHUNK_SIZE;
+
+    auto fs = p.sample().rate_hz();
+    hdr.sample_rate_hz = std::isfinite(fs) ? fs : -1.0;
+
+    const std::string version = std::string(Oat_VERSION_MAJOR) + "."
+                                + Oat_VERSION_MINOR;
+    std::strncpy(hdr.oat_version, version.c_str(), sizeof(hdr.oat_version) - 1);
+    std::strncpy(hdr.date, oat::createTimeStamp(true).c_str(), sizeof(hdr.date) - 1);
+    std::strncpy(hdr.source, source_name.c_str(), sizeof(hdr.source) - 1);
+
+    fwrite(&hdr, sizeof(hdr), 1, fd_);
+
+    // Chunk columns
+    const size_t n = poslog::CHUNK_SIZE;
+    tick_.resize(n);
+    usec_.resize(n);
+    monotonic_usec_.resize(n);
+    position_.resize(2 * n);
+    velocity_.resize(2 * n);
+    heading_.resize(2 * n);
+    region_.resize(n);
+    flags_.resize(n);
+}
+
+void BinaryPositionWriter::write(void) {
+
+    buffer_.consume([this](const oat::Position2D &p) {
+
+        // File desriptor must be avaiable for writing
+        assert(fd_);
+
+        append(p);
+        if (n_ == poslog::CHUNK_SIZE)
+            flushChunk();
+    });
+}
+
+void BinaryPositionWriter::append(const oat::Position2D &p) {
+
+    const auto &s = p.sample();
+    tick_[n_] = s.count();
+    usec_[n_] = s.microseconds().count();
+    monotonic_usec_[n_] = s.monotonic_microseconds().count();
+
+    position_[2 * n_] = p.position.x;
+    position_[2 * n_ + 1] = p.position.y;
+    velocity_[2 * n_] = p.velocity.x;
+    velocity_[2 * n_ + 1] = p.velocity.y;
+    heading_[2 * n_] = p.heading.x;
+    heading_[2 * n_ + 1] = p.heading.y;
+
+    uint8_t flags = 0;
+    if (p.position_valid) flags |= poslog::POSITION_VALID;
+    if (p.velocity_valid) flags |= poslog::VELOCITY_VALID;
+    if (p.heading_valid) flags |= poslog::HEADING_VALID;
+    if (p.region_valid) flags |= poslog::REGION_VALID;
+    if (p.unit_of_length() == oat::DistanceUnit::WORLD)
+        flags |= poslog::UNIT_WORLD;
+    flags_[n_] = flags;
+
+    region_[n_] = p.region_id;
+    if (p.region_valid && p.region_id < regions_seen_.size())
+        regions_seen_.set(p.region_id);
+
+    n_++;
+}
+
+template <typename T>
+void BinaryPositionWriter::writeColumn(const std::vector<T> &col,
+                                       const size_t n) {
+    fwrite(col.data(), sizeof(T), n, fd_);
+}
+
+void BinaryPositionWriter::flushChunk() {
+
+    if (n_ == 0)
+        return;
+
+    poslog::ChunkHeader hdr {static_cast<uint32_t>(n_), 0};
+    fwrite(&hdr, sizeof(hdr), 1, fd_);
+
+    writeColumn(tick_, n_);
+    writeColumn(usec_, n_);
+    writeColumn(monotonic_usec_, n_);
+    writeColumn(position_, 2 * n_);
+    writeColumn(velocity_, 2 * n_);
+    writeColumn(heading_, 2 * n_);
+    writeColumn(region_, n_);
+    writeColumn(flags_, n_);
+
+    n_ = 0;
+}
+
+void BinaryPositionWriter::writeDictionary() {
+
+    const uint64_t offset = ftell(fd_);
+
+    uint32_t n = regions_seen_.count();
+    fwrite(&n, sizeof(n), 1, fd_);
+
+    for (size_t id = 0; id < regions_seen_.size(); id++) {
+
+        if (!regions_seen_.test(id))
+            continue;
+
+        const uint16_t rid = id;
+        char name[poslog::NAME_SIZE] {};
+        std::strncpy(name,
+                     oat::PositionRegistry::regionName(rid).c_str(),
+                     sizeof(name) - 1);
+
+        fwrite(&rid, sizeof(rid), 1, fd_);
+        fwrite(name, sizeof(name), 1, fd_);
+    }
+
+    // Mark the log as complete by pointing the header at the dictionary
+    fseek(fd_, offsetof(poslog::FileHeader, dictionary_offset), SEEK_SET);
+    fwrite(&offset, sizeof(offset), 1, fd_);
+}
+
+} /* namespace oat */
@@ -0,0 +1,80 @@
+//******************************************************************************
+//* File:   BinaryPositionWriter.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_BINARYPOSITIONWRITER_H
+#define OAT_BINARYPOSITIONWRITER_H
+
+#include "Writer.h"
+
+#include <bitset>
+#include <cstdio>
+#include <vector>
+
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionLog.h"
+
+namespace oat {
+
+/**
+ * Position stream file writer using the binary position log format (see
+ * oat::poslog). Positions are accumulated into columnar chunks, which are
+ * written once they are full.
+ */
+class BinaryPositionWriter : public Writer<oat::Position2D> {
+
+    // Inherit constructor
+    using Writer<oat::Position2D>::Writer;
+
+public:
+
+    ~BinaryPositionWriter();
+
+    void write(void) override;
+
+    void initialize(const std::string &source_name,
+                    const oat::Position2D &p) override;
+
+private:
+
+    FILE * fd_ {nullptr};
+
+    // Columns of the current chunk
+    size_t n_ {0};
+    std::vector<uint64_t> tick_;
+    std::vector<int64_t> usec_;
+    std::vector<int64_t> monotonic_usec_;
+    std::vector<double> position_;
+    std::vector<double> velocity_;
+    std::vector<double> heading_;
+    std::vector<uint16_t> region_;
+    std::vector<uint8_t> flags_;
+
+    // Region IDs that must be written to the dictionary
+    std::bitset<oat::PositionRegistry::MAX_REGIONS> regions_seen_;
+
+    void append(const oat::Position2D &p);
+    void flushChunk(void);
+    void writeDictionary(void);
+
+    template <typename T>
+    void writeColumn(const std::vector<T> &col, const size_t n);
+};
+
+}      /* namespace oat */
+#endif /* OAT_BINARYPOSITIONWRITER_H */
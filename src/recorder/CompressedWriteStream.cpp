@@ -0,0 +1,209 @@
+//******************************************************************************
+//* File:   CompressedWriteStream.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+#include "CompressedWriteStream.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <zlib.h>
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "../../lib/utility/IOFormat.h"
+
+namespace oat {
+
+CompressedWriteStream::CompressedWriteStream(FILE *fd,
+                                             const Codec codec,
+                                             const int level,
+                                             const size_t block_bytes) :
+  fd_(fd)
+, codec_(codec)
+, level_(level)
+, last_submit_(std::chrono::steady_clock::now())
+{
+    assert(block_bytes > 0);
+
+    if (!available(codec_))
+        throw (std::runtime_error("Oat was compiled without support for the "
+                                  "requested compression codec."));
+
+    buffers_[0].resize(block_bytes);
+    buffers_[1].resize(block_bytes);
+
+    if (codec_ != Codec::NONE)
+        thread_ = std::thread([this] { compressLoop(); });
+}
+
+CompressedWriteStream::~CompressedWriteStream()
+{
+    try {
+        Flush();
+    } catch (const std::runtime_error &ex) {
+        std::cerr << oat::Error(ex.what()) << "\n";
+    }
+
+    if (thread_.joinable()) {
+
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            running_ = false;
+        }
+        cv_.notify_all();
+        thread_.join();
+
+        if (!error_.empty())
+            std::cerr << oat::Error(error_) << "\n";
+    }
+}
+
+std::string CompressedWriteStream::extension(const Codec codec) {
+
+    switch (codec) {
+        case Codec::GZIP: return ".gz";
+        case Codec::ZSTD: return ".zst";
+        default: return "";
+    }
+}
+
+bool CompressedWriteStream::available(const Codec codec) {
+
+#ifdef USE_ZSTD
+    const bool zstd = true;
+#else
+    const bool zstd = false;
+#endif
+
+    return codec != Codec::ZSTD || zstd;
+}
+
+void CompressedWriteStream::submit(void) {
+
+    last_submit_ = std::chrono::steady_clock::now();
+
+    if (codec_ == Codec::NONE) {
+        writeBlock(buffers_[active_].data(), fill_);
+        fill_ = 0;
+        return;
+    }
+
+    std::unique_lock<std::mutex> lk(mutex_);
+
+    // Wait for the compression thread to finish with the other buffer
+    cv_.wait(lk, [this] { return !pending_; });
+
+    if (!error_.empty())
+        throw (std::runtime_error(error_));
+
+    pending_ = true;
+    pending_buffer_ = active_;
+    pending_bytes_ = fill_;
+    lk.unlock();
+    cv_.notify_all();
+
+    active_ ^= 1;
+    fill_ = 0;
+}
+
+void CompressedWriteStream::compressLoop(void) {
+
+    std::unique_lock<std::mutex> lk(mutex_);
+
+    while (true) {
+
+        cv_.wait(lk, [this] { return pending_ || !running_; });
+        if (!pending_)
+            break;
+
+        const char *src = buffers_[pending_buffer_].data();
+        const size_t src_bytes = pending_bytes_;
+        lk.unlock();
+
+        std::string err;
+        size_t bytes = 0;
+
+        if (codec_ == Codec::GZIP) {
+
+            // Each block is a complete gzip member
+            z_stream zs;
+            std::memset(&zs, 0, sizeof(zs));
+            const int level = level_ > 0 ? level_ : Z_DEFAULT_COMPRESSION;
+            if (deflateInit2(&zs, level, Z_DEFLATED, 15 + 16, 8,
+                             Z_DEFAULT_STRATEGY) != Z_OK) {
+                err = "Failed to initialize gzip compression.";
+            } else {
+                compressed_.resize(deflateBound(&zs, src_bytes) + 32);
+                zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(src));
+                zs.avail_in = src_bytes;
+                zs.next_out = reinterpret_cast<Bytef *>(compressed_.data());
+                zs.avail_out = compressed_.size();
+                if (deflate(&zs, Z_FINISH) != Z_STREAM_END)
+                    err = "gzip compression failed.";
+                bytes = zs.total_out;
+                deflateEnd(&zs);
+            }
+        }
+#ifdef USE_ZSTD
+        else if (codec_ == Codec::ZSTD) {
+
+            // Each block is a complete zstd frame
+            compressed_.resize(ZSTD_compressBound(src_bytes));
+            const int level = level_ > 0 ? level_ : 3;
+            bytes = ZSTD_compress(compressed_.data(), compressed_.size(),
+                                  src, src_bytes, level);
+            if (ZSTD_isError(bytes))
+                err = std::string("zstd compression failed: ")
+                      + ZSTD_getErrorName(bytes);
+        }
+#endif
+
+        if (err.empty()) {
+            try {
+                writeBlock(compressed_.data(), bytes);
+            } catch (const std::runtime_error &ex) {
+                err = ex.what();
+            }
+        }
+
+        lk.lock();
+        if (!err.empty() && error_.empty())
+            error_ = err;
+        pending_ = false;
+        cv_.notify_all();
+    }
+}
+
+void CompressedWriteStream::writeBlock(const char *data, const size_t bytes) {
+
+    if (fwrite(data, 1, bytes, fd_) != bytes)
+        throw (std::runtime_error("Failed to write compressed block: "
+                                  + std::string(std::strerror(errno))));
+
+    // Make this block a flush point for compressed streams
+    if (codec_ != Codec::NONE)
+        fflush(fd_);
+}
+
+} /* namespace oat */
@@ -0,0 +1,128 @@
+//******************************************************************************
+//* File:   CompressedWriteStream.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_COMPRESSEDWRITESTREAM_H
+#define OAT_COMPRESSEDWRITESTREAM_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace oat {
+
+/**
+ * rapidjson output stream that writes to a file in independently compressed
+ * blocks. Full blocks are compressed and written by a dedicated thread while
+ * the next one is filled. Each block is a complete gzip member or zstd frame,
+ * and the concatenation of these is a valid .gz or .zst file. A crash
+ * therefore loses at most the blocks that have not been written.
+ */
+class CompressedWriteStream {
+
+public:
+
+    typedef char Ch;
+
+    enum class Codec {
+        NONE = 0, //!< Blocks are written uncompressed
+        GZIP,
+        ZSTD
+    };
+
+    /**
+     * @brief Compressed output stream.
+     * @param fd File to write to. Must remain open for the lifetime of this
+     * stream.
+     * @param codec Compression codec
+     * @param level Compression level. 0 for the codec's default.
+     * @param block_bytes Size of each independently compressed block.
+     */
+    CompressedWriteStream(FILE *fd,
+                          const Codec codec,
+                          const int level = 0,
+                          const size_t block_bytes = 1 << 20);
+
+    ~CompressedWriteStream();
+
+    // rapidjson OutputStream concept
+    void Put(Ch c) {
+        buffers_[active_][fill_++] = c;
+        if (fill_ == buffers_[active_].size())
+            submit();
+    }
+
+    /**
+     * @brief Write the current block, even if it is not full.
+     */
+    void Flush() { if (fill_ > 0) submit(); }
+
+    /**
+     * @brief Flush if period has elapsed since the last block was written.
+     * @param period Maximum time between flush points
+     */
+    void flushEvery(const std::chrono::milliseconds period) {
+        if (std::chrono::steady_clock::now() - last_submit_ >= period)
+            Flush();
+    }
+
+    /**
+     * @brief File extension used for files compressed with a codec,
+     * including the leading '.', or an empty string for Codec::NONE.
+     */
+    static std::string extension(const Codec codec);
+
+    /**
+     * @brief Check if support for a codec was compiled in.
+     */
+    static bool available(const Codec codec);
+
+private:
+
+    FILE *fd_;
+    Codec codec_;
+    int level_;
+
+    // Double buffering
+    std::vector<char> buffers_[2];
+    size_t fill_ {0};
+    int active_ {0};
+    std::chrono::steady_clock::time_point last_submit_;
+
+    // Compression thread
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool pending_ {false};
+    int pending_buffer_ {0};
+    size_t pending_bytes_ {0};
+    bool running_ {true};
+    std::string error_;
+    std::vector<char> compressed_;
+
+    void submit(void);
+    void compressLoop(void);
+    void writeBlock(const char *data, const size_t bytes);
+};
+
+}      /* namespace oat */
+#endif /* OAT_COMPRESSEDWRITESTREAM_H */
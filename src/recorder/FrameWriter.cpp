@@ -21,27 +21,109 @@
 
 #include <iostream>
 #include <cassert>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include "../../lib/datatypes/FrameIndex.h"
+#include "../../lib/utility/IOFormat.h"
 
 namespace oat {
 
+FrameWriter::FrameWriter(const std::string &path,
+                         const VideoFormat &format) :
+  Writer<oat::Frame>(path)
+, format_(format)
+{
+    // Nothing
+}
+
+FrameWriter::~FrameWriter()
+{
+    if (index_fd_ != nullptr)
+        fclose(index_fd_);
+}
+
 void FrameWriter::initialize(const std::string &source_name,
                              const oat::Frame &f) {
 
     // Initialize writer using the first frame taken from server
-    int fourcc = cv::VideoWriter::fourcc('H', '2', '6', '4');
+    const auto &c = format_.codec;
+    int fourcc = cv::VideoWriter::fourcc(c[0], c[1], c[2], c[3]);
     video_writer_.open(path_, fourcc, f.sample().rate_hz(), f.size());
+
+    if (!video_writer_.isOpened())
+        throw (std::runtime_error("Could not open video writer for " + path_
+                                  + " using codec " + c + "."));
+
+    // Encoder parameters are only honored by some backends (e.g. OpenCV's
+    // built-in MJPG encoder), so warn rather than fail if they are rejected
+    if (format_.quality >= 0
+        && !video_writer_.set(cv::VIDEOWRITER_PROP_QUALITY, format_.quality))
+        std::cerr << oat::whoWarn(source_name, "Video backend ignored the "
+                                  "quality setting for codec " + c + ".\n");
+
+    if (format_.threads > 0
+        && !video_writer_.set(cv::VIDEOWRITER_PROP_NSTRIPES, format_.threads))
+        std::cerr << oat::whoWarn(source_name, "Video backend ignored the "
+                                  "threads setting for codec " + c + ".\n");
+
+    // Per-frame index
+    const std::string index_path = path_ + ".idx";
+    index_fd_ = fopen(index_path.c_str(), "wb");
+    if (index_fd_ == nullptr)
+        throw (std::runtime_error("Could not open " + index_path + " for writing."));
+
+    auto idx_hdr = oat::frameidx::makeHeader(source_name, f.sample().rate_hz());
+    fwrite(&idx_hdr, sizeof(idx_hdr), 1, index_fd_);
+}
+
+std::vector<std::string> FrameWriter::files(void) const {
+
+    return {path_, path_ + ".idx"};
 }
 
 void FrameWriter::write(void) {
 
-    cv::Mat mat;
-    while (buffer_.pop(mat)) {
+    buffer_.consume([this](const oat::Frame &f) {
 
         // File desriptor must be avaiable for writing
         assert(video_writer_.isOpened());
 
-        video_writer_.write(mat);
-    }
+        auto t0 = std::chrono::steady_clock::now();
+        video_writer_.write(f);
+        std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+
+        // Video encoders do not expose byte offsets, so frames are indexed
+        // by their position in the video
+        const auto &s = f.sample();
+        oat::frameidx::Entry e;
+        std::memset(&e, 0, sizeof(e));
+        e.tick = s.count();
+        e.usec = s.microseconds().count();
+        e.monotonic_usec = s.monotonic_microseconds().count();
+        e.offset = frames_encoded_.load();
+        e.flags = oat::frameidx::FRAME_NUMBER;
+        fwrite(&e, sizeof(e), 1, index_fd_);
+
+        // Only this writer's thread updates these
+        encode_sec_.store(encode_sec_.load() + dt.count());
+        frames_encoded_++;
+    });
+}
+
+std::string FrameWriter::stats(void) const {
+
+    const uint64_t n = frames_encoded_.load();
+    const double sec = encode_sec_.load();
+
+    std::stringstream ss;
+    ss << n << " frames encoded";
+    if (sec > 0)
+        ss << " at " << std::fixed << std::setprecision(1) << n / sec << " fps";
+
+    return ss.str();
 }
 
 } /* namespace oat */
@@ -22,6 +22,10 @@
 
 #include "Writer.h"
 
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <vector>
 #include <opencv2/videoio.hpp>
 
 #include "../../lib/datatypes/Frame.h"
@@ -32,27 +36,57 @@ namespace blf = boost::lockfree;
 // Constants
 static constexpr int FRAME_WRITE_BUFFER_SIZE {1000};
 
+/**
+ * Video encoding parameters.
+ */
+struct VideoFormat {
+
+    // Four character code of the codec, e.g. H264, MJPG, FFV1
+    std::string codec {"H264"};
+
+    // File extension, which determines the container, e.g. avi, mkv
+    std::string container {"avi"};
+
+    // Encoder quality, 0-100. Negative to use the backend default.
+    int quality {-1};
+
+    // Number of encoder threads. 0 to use the backend default.
+    int threads {0};
+};
+
 /**
  * Frame stream video file writer.
  */
 class FrameWriter : public Writer<oat::Frame> {
 
-    // Inherit constructor
-    using Writer<oat::Frame>::Writer;
-
 public:
 
-    ~FrameWriter() { };
+    FrameWriter(const std::string &path,
+                const VideoFormat &format = VideoFormat());
+
+    ~FrameWriter();
 
     void initialize(const std::string &source_name,
                     const oat::Frame &f) override;
 
     void write(void) override;
-    
+
+    std::vector<std::string> files(void) const override;
+
+    std::string stats(void) const override;
+
 private:
 
     cv::VideoWriter video_writer_; 
+    VideoFormat format_;
+
+    // Per-frame index (see oat::frameidx) linking each video frame to its
+    // sample number and time
+    FILE * index_fd_ {nullptr};
 
+    // Encoder throughput
+    std::atomic<uint64_t> frames_encoded_ {0};
+    std::atomic<double> encode_sec_ {0.0};
 };
 }      /* namespace oat */
 #endif /* OAT_FRAMEWRITER_H */
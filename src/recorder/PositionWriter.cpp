@@ -28,9 +28,16 @@ namespace oat {
 
 PositionWriter::~PositionWriter() 
 {
+    if (!file_stream_)
+        return;
+
     json_writer_.EndArray();
     json_writer_.EndObject();
     file_stream_->Flush();
+
+    // Waits for remaining blocks to be compressed and written
+    file_stream_.reset();
+    fclose(fd_);
 }
 
 void PositionWriter::initialize(const std::string &source_name,
@@ -38,11 +45,14 @@ void PositionWriter::initialize(const std::string &source_name,
 
     // Position file 
     fd_ = fopen(path_.c_str(), "wb");
-
-    file_stream_.reset(new rapidjson::FileWriteStream(
-            fd_,
-            position_write_buffer, 
-            sizeof(position_write_buffer)));
+    if (fd_ == nullptr)
+        throw (std::runtime_error("Could not open " + path_ + " for writing."));
+
+    const size_t block_size = codec_ == CompressedWriteStream::Codec::NONE
+                            ? POSITION_WRITE_BUFFER_SIZE
+                            : COMPRESSED_BLOCK_SIZE;
+    file_stream_.reset(
+        new oat::CompressedWriteStream(fd_, codec_, level_, block_size));
     json_writer_.Reset(*file_stream_);
 
     // Main object, end this object before write flush in destructor
@@ -83,8 +93,7 @@ void PositionWriter::initialize(const std::string &source_name,
 
 void PositionWriter::write(void) {
 
-    oat::Position2D p("");
-    while (buffer_.pop(p)) {
+    buffer_.consume([this](const oat::Position2D &p) {
 
         // File desriptor must be avaiable for writing
         assert(fd_);
@@ -94,7 +103,11 @@ void PositionWriter::write(void) {
         //json_writer_.String(oat::createTimeStamp(true).c_str());
         p.Serialize(json_writer_, verbose_file_);
         json_writer_.EndObject();
-    }
+    });
+
+    // Bound the data lost on a crash
+    if (codec_ != CompressedWriteStream::Codec::NONE)
+        file_stream_->flushEvery(COMPRESSED_FLUSH_PERIOD);
 }
     
 } /* namespace oat */
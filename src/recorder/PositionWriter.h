@@ -20,9 +20,9 @@
 #ifndef OAT_POSITIONWRITER_H
 #define OAT_POSITIONWRITER_H
 
+#include "CompressedWriteStream.h"
 #include "Writer.h"
 
-#include <rapidjson/filewritestream.h>
 #include <rapidjson/prettywriter.h>
 
 #include "../../lib/datatypes/Position2D.h"
@@ -32,6 +32,8 @@ namespace blf = boost::lockfree;
 
 // Constants
 static constexpr int POSITION_WRITE_BUFFER_SIZE {65536};
+static constexpr int COMPRESSED_BLOCK_SIZE {1 << 20};
+static constexpr std::chrono::milliseconds COMPRESSED_FLUSH_PERIOD {1000};
 
 /**
  * Position stream file writer.
@@ -52,6 +54,11 @@ public:
 
     // Accessors
     void set_verbose_file(const bool value) { verbose_file_ = value; }
+    void set_compression(const CompressedWriteStream::Codec codec,
+                         const int level) {
+        codec_ = codec;
+        level_ = level;
+    }
 
 private:
 
@@ -66,12 +73,16 @@ private:
     std::chrono::system_clock clock_;
     std::chrono::system_clock::time_point start_;
 
+    // Compression of the position file. Compressed blocks are flushed to
+    // disk at least every COMPRESSED_FLUSH_PERIOD.
+    CompressedWriteStream::Codec codec_ {CompressedWriteStream::Codec::NONE};
+    int level_ {0};
+
     // Position file
     // TODO: Position specialization
     FILE * fd_ {nullptr};
-    char position_write_buffer[POSITION_WRITE_BUFFER_SIZE];
-    std::unique_ptr<rapidjson::FileWriteStream> file_stream_;
-    rapidjson::PrettyWriter<rapidjson::FileWriteStream> json_writer_ {*file_stream_};
+    std::unique_ptr<oat::CompressedWriteStream> file_stream_;
+    rapidjson::PrettyWriter<oat::CompressedWriteStream> json_writer_ {*file_stream_};
 };
 
 }      /* namespace oat */
@@ -0,0 +1,94 @@
+//******************************************************************************
+//* File:   PreTriggerBuffer.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_PRETRIGGERBUFFER_H
+#define OAT_PRETRIGGERBUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "SampleCopy.h"
+
+namespace oat {
+
+/**
+ * Fixed capacity ring of the most recent samples from a SOURCE, used to hold
+ * samples received while recording is off so that they can be written once
+ * it is switched on. All storage is allocated on construction: storing a
+ * sample copies it over the oldest one.
+ */
+template <typename T>
+class PreTriggerBuffer {
+
+public:
+
+    /**
+     * @brief Preallocated ring of samples.
+     * @param capacity Maximum number of samples held.
+     * @param sample_template Sample defining the size of each slot, e.g. the
+     * dimensions and type of a frame.
+     */
+    PreTriggerBuffer(const size_t capacity, const T &sample_template)
+    {
+        slots_.reserve(capacity);
+        for (size_t i = 0; i < capacity; i++)
+            slots_.push_back(deepCopy(sample_template));
+    }
+
+    /**
+     * @brief Store a sample, overwriting the oldest one if the ring is full.
+     * @param sample Sample to store.
+     */
+    void store(const T &sample) {
+
+        if (slots_.empty())
+            return;
+
+        copyInto(sample, slots_[head_]);
+        head_ = (head_ + 1) % slots_.size();
+        if (size_ < slots_.size())
+            size_++;
+    }
+
+    /**
+     * @brief Oldest held sample. The ring must not be empty.
+     */
+    const T &front(void) const {
+        return slots_[(head_ + slots_.size() - size_) % slots_.size()];
+    }
+
+    /**
+     * @brief Discard the oldest held sample. The ring must not be empty.
+     */
+    void pop(void) { size_--; }
+
+    bool empty(void) const { return size_ == 0; }
+    bool full(void) const { return size_ == slots_.size(); }
+    size_t size(void) const { return size_; }
+    size_t capacity(void) const { return slots_.size(); }
+
+private:
+
+    std::vector<T> slots_;
+    size_t head_ {0};
+    size_t size_ {0};
+};
+
+}      /* namespace oat */
+#endif /* OAT_PRETRIGGERBUFFER_H */
@@ -0,0 +1,297 @@
+//******************************************************************************
+//* File:   RawFrameWriter.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+#include "RawFrameWriter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../../lib/datatypes/FrameIndex.h"
+#include "../../lib/utility/FileFormat.h"
+#include "../../lib/utility/IOFormat.h"
+
+namespace oat {
+
+// Size of each staging buffer. Large writes keep the disk streaming.
+static constexpr size_t RAW_BUFFER_BYTES {8 << 20};
+
+// Disk space is reserved this many staging buffers ahead of the data
+static constexpr size_t RAW_PREALLOCATE_BUFFERS {32};
+
+static constexpr char RAW_MAGIC[8] {'O', 'A', 'T', 'R', 'A', 'W', '\0', '\0'};
+static constexpr uint32_t RAW_VERSION {1};
+
+static_assert(sizeof(RawFrameHeader) <= RawFrameWriter::ALIGNMENT,
+              "RawFrameHeader must fit in the first block.");
+
+RawFrameWriter::RawFrameWriter(const std::string &path) :
+  Writer<oat::Frame>(path)
+{
+    std::memset(&header_, 0, sizeof(header_));
+}
+
+RawFrameWriter::~RawFrameWriter()
+{
+    if (fd_ < 0)
+        return;
+
+    // Write the partially filled buffer and wait for the I/O thread to finish
+    try {
+        if (fill_ > 0)
+            submit();
+    } catch (const std::runtime_error &ex) {
+        std::cerr << oat::Error(ex.what()) << "\n";
+    }
+
+    if (io_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lk(io_mutex_);
+            io_running_ = false;
+        }
+        io_cv_.notify_all();
+        io_thread_.join();
+    }
+
+    if (io_errno_ != 0)
+        std::cerr << oat::Error("Raw frame write to " + path_ + " failed: "
+                                + std::strerror(io_errno_) + "\n");
+
+    close(fd_);
+
+    if (index_fd_ != nullptr)
+        fclose(index_fd_);
+
+    free(buffers_[0]);
+    free(buffers_[1]);
+}
+
+void RawFrameWriter::initialize(const std::string &source_name,
+                                const oat::Frame &f) {
+
+    // Frame geometry, from the first frame
+    std::memcpy(header_.magic, RAW_MAGIC, sizeof(header_.magic));
+    header_.version = RAW_VERSION;
+    header_.rows = f.rows;
+    header_.cols = f.cols;
+    header_.type = f.type();
+    header_.frame_bytes = f.total() * f.elemSize();
+    header_.slot_bytes = (header_.frame_bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+    auto fs = f.sample().rate_hz();
+    header_.sample_rate_hz = std::isfinite(fs) ? fs : -1.0;
+
+    const std::string version = std::string(Oat_VERSION_MAJOR) + "."
+                                + Oat_VERSION_MINOR;
+    std::strncpy(header_.oat_version, version.c_str(), sizeof(header_.oat_version) - 1);
+    std::strncpy(header_.date, oat::createTimeStamp(true).c_str(), sizeof(header_.date) - 1);
+    std::strncpy(header_.source, source_name.c_str(), sizeof(header_.source) - 1);
+
+    // Bypass the page cache if the file system allows it
+    fd_ = open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    direct_io_ = fd_ >= 0;
+    if (fd_ < 0 && errno == EINVAL)
+        fd_ = open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0)
+        throw (std::runtime_error("Could not open " + path_ + " for writing: "
+                                  + std::strerror(errno)));
+
+    // Aligned staging buffers holding a whole number of frame slots
+    const size_t slots = std::max<size_t>(1, RAW_BUFFER_BYTES / header_.slot_bytes);
+    buffer_bytes_ = slots * header_.slot_bytes;
+    for (auto &b : buffers_) {
+        if (posix_memalign(reinterpret_cast<void **>(&b), ALIGNMENT, buffer_bytes_) != 0)
+            throw (std::bad_alloc());
+        std::memset(b, 0, buffer_bytes_);
+    }
+
+    // Header occupies the first block
+    std::memcpy(buffers_[0], &header_, sizeof(header_));
+    const int err = writeBuffer(buffers_[0], ALIGNMENT, 0);
+    if (err != 0)
+        throw (std::runtime_error("Could not write to " + path_ + ": "
+                                  + std::strerror(err)));
+    std::memset(buffers_[0], 0, ALIGNMENT);
+    buffer_offset_ = ALIGNMENT;
+    preallocate(buffer_offset_);
+
+    // Per-frame index
+    const std::string index_path = path_ + ".idx";
+    index_fd_ = fopen(index_path.c_str(), "wb");
+    if (index_fd_ == nullptr)
+        throw (std::runtime_error("Could not open " + index_path + " for writing."));
+
+    auto idx_hdr = oat::frameidx::makeHeader(source_name, header_.sample_rate_hz);
+    fwrite(&idx_hdr, sizeof(idx_hdr), 1, index_fd_);
+
+    io_thread_ = std::thread([this] { ioLoop(); });
+}
+
+std::vector<std::string> RawFrameWriter::files(void) const {
+
+    return {path_, path_ + ".idx"};
+}
+
+void RawFrameWriter::write(void) {
+
+    buffer_.consume([this](const oat::Frame &f) {
+
+        // File desriptor must be avaiable for writing
+        assert(fd_ >= 0);
+
+        append(f);
+    });
+}
+
+void RawFrameWriter::append(const oat::Frame &f) {
+
+    if (f.rows != header_.rows || f.cols != header_.cols || f.type() != header_.type)
+        throw (std::runtime_error("Frame size or type changed during raw recording."));
+
+    // Copy pixels into the next slot
+    char *dst = buffers_[active_] + fill_;
+    if (f.isContinuous()) {
+        std::memcpy(dst, f.data, header_.frame_bytes);
+    } else {
+        const size_t row_bytes = f.cols * f.elemSize();
+        for (int r = 0; r < f.rows; r++)
+            std::memcpy(dst + r * row_bytes, f.ptr(r), row_bytes);
+    }
+
+    // Index entry
+    const auto &s = f.sample();
+    oat::frameidx::Entry e;
+    std::memset(&e, 0, sizeof(e));
+    e.tick = s.count();
+    e.usec = s.microseconds().count();
+    e.monotonic_usec = s.monotonic_microseconds().count();
+    e.offset = buffer_offset_ + fill_;
+    e.flags = oat::frameidx::KEYFRAME;
+    fwrite(&e, sizeof(e), 1, index_fd_);
+
+    fill_ += header_.slot_bytes;
+    if (fill_ == buffer_bytes_)
+        submit();
+}
+
+void RawFrameWriter::submit(void) {
+
+    std::unique_lock<std::mutex> lk(io_mutex_);
+
+    // Wait for the I/O thread to finish with the other buffer
+    io_cv_.wait(lk, [this] { return !io_pending_; });
+
+    if (io_errno_ != 0)
+        throw (std::runtime_error("Raw frame write to " + path_ + " failed: "
+                                  + std::strerror(io_errno_)));
+
+    io_pending_ = true;
+    io_buffer_ = active_;
+    io_bytes_ = fill_;
+    io_offset_ = buffer_offset_;
+    lk.unlock();
+    io_cv_.notify_all();
+
+    // Fill the other buffer while this one is written
+    active_ ^= 1;
+    buffer_offset_ += fill_;
+    fill_ = 0;
+}
+
+void RawFrameWriter::ioLoop(void) {
+
+    std::unique_lock<std::mutex> lk(io_mutex_);
+
+    for (;;) {
+
+        io_cv_.wait(lk, [this] { return io_pending_ || !io_running_; });
+        if (!io_pending_)
+            break;
+
+        const char *data = buffers_[io_buffer_];
+        const size_t bytes = io_bytes_;
+        const uint64_t offset = io_offset_;
+        lk.unlock();
+
+        const int err = writeBuffer(data, bytes, offset);
+        if (err == 0)
+            preallocate(offset + bytes);
+
+        lk.lock();
+        io_pending_ = false;
+        if (err != 0)
+            io_errno_ = err;
+        io_cv_.notify_all();
+    }
+}
+
+int RawFrameWriter::writeBuffer(const char *data, size_t bytes, uint64_t offset) {
+
+    while (bytes > 0) {
+
+        const ssize_t n = pwrite(fd_, data, bytes, offset);
+        if (n < 0) {
+
+            if (errno == EINTR)
+                continue;
+
+            // Some file systems accept O_DIRECT at open() but not at
+            // write(). Fall back to buffered I/O.
+            if (errno == EINVAL && direct_io_) {
+                direct_io_ = false;
+                fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) & ~O_DIRECT);
+                continue;
+            }
+
+            return errno;
+        }
+
+        data += n;
+        bytes -= n;
+        offset += n;
+    }
+
+    return 0;
+}
+
+void RawFrameWriter::preallocate(const uint64_t written) {
+
+    // Keep between half and all of the preallocation window reserved ahead
+    // of the data
+    const uint64_t window = RAW_PREALLOCATE_BUFFERS * buffer_bytes_;
+    if (written + window / 2 <= allocated_bytes_)
+        return;
+
+    // Reserve space without changing the file size. Not all file systems
+    // support this, in which case it is skipped.
+    const uint64_t end = written + window;
+    fallocate(fd_, FALLOC_FL_KEEP_SIZE, allocated_bytes_, end - allocated_bytes_);
+    allocated_bytes_ = end;
+}
+
+} /* namespace oat */
@@ -0,0 +1,118 @@
+//******************************************************************************
+//* File:   RawFrameWriter.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_RAWFRAMEWRITER_H
+#define OAT_RAWFRAMEWRITER_H
+
+#include "Writer.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../lib/datatypes/Frame.h"
+
+namespace oat {
+
+/**
+ * Header of a raw frame recording. Frames follow the header, each in a slot
+ * of slot_bytes bytes starting at a multiple of RawFrameWriter::ALIGNMENT.
+ * Values are stored in host byte order.
+ */
+struct RawFrameHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t rows;
+    int32_t cols;
+    int32_t type;            //!< OpenCV matrix type, e.g. CV_8UC3
+    uint64_t frame_bytes;    //!< Bytes of pixel data per frame
+    uint64_t slot_bytes;     //!< Bytes between consecutive frames
+    double sample_rate_hz;
+    char oat_version[64];
+    char date[32];
+    char source[100];
+    char padding[4];
+};
+
+/**
+ * Frame stream writer that stores uncompressed frames, bypassing the page
+ * cache where possible, so that recording bandwidth is limited by the disk
+ * rather than by an encoder. Frames are copied into one of two large,
+ * aligned staging buffers. Full buffers are written by a dedicated I/O
+ * thread while the other is filled. A per-frame index (see oat::frameidx)
+ * is written alongside the recording.
+ */
+class RawFrameWriter : public Writer<oat::Frame> {
+
+public:
+
+    static constexpr size_t ALIGNMENT {4096};
+
+    RawFrameWriter(const std::string &path);
+    ~RawFrameWriter();
+
+    void initialize(const std::string &source_name,
+                    const oat::Frame &f) override;
+
+    void write(void) override;
+
+    std::vector<std::string> files(void) const override;
+
+private:
+
+    // Recording and index files
+    int fd_ {-1};
+    bool direct_io_ {false};
+    FILE * index_fd_ {nullptr};
+
+    // Frame geometry
+    RawFrameHeader header_;
+
+    // Double buffering
+    char * buffers_[2] {nullptr, nullptr};
+    size_t buffer_bytes_ {0};
+    size_t fill_ {0};
+    int active_ {0};
+    uint64_t buffer_offset_ {0}; //!< File offset of the active buffer
+
+    // I/O thread
+    std::thread io_thread_;
+    std::mutex io_mutex_;
+    std::condition_variable io_cv_;
+    bool io_pending_ {false};
+    size_t io_bytes_ {0};
+    uint64_t io_offset_ {0};
+    int io_buffer_ {0};
+    uint64_t allocated_bytes_ {0};
+    bool io_running_ {true};
+    int io_errno_ {0};
+
+    void append(const oat::Frame &f);
+    void submit(void);
+    void ioLoop(void);
+    int writeBuffer(const char *data, size_t bytes, uint64_t offset);
+    void preallocate(const uint64_t written);
+};
+
+}      /* namespace oat */
+#endif /* OAT_RAWFRAMEWRITER_H */
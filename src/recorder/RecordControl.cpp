@@ -53,6 +53,7 @@ int controlRecorder(std::istream &in,
     cmd_map["pause"] = 'p';
     cmd_map["new"] = 'n';
     cmd_map["ping"] = 'i';
+    cmd_map["stats"] = 't';
 
     // User control loop
     std::string cmd;
@@ -113,6 +114,12 @@ int controlRecorder(std::istream &in,
                 out << "Ping received." << std::endl;
                 break;
             }
+            case 't' :
+            {
+                recorder.printStats(out);
+                out << std::flush;
+                break;
+            }
             default :
             {
                 out << "Invalid command \'" << cmd << "\'" << std::endl;
@@ -37,6 +37,8 @@ const char interactive_record_control_usage_string[] =
     "            without creating a new file.\n"
     " new        Start a new file using folder location and file name\n"
     "            options as provided in command line arguements.\n"
+    " stats      Print the number of frames encoded and the achieved\n"
+    "            encoding frame rate of each frame stream.\n"
     " quit       Exit the program.\n";
 
 const char remote_record_control_usage_string[] =
@@ -17,21 +17,30 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //******************************************************************************
 
+#include "OatConfig.h" // Generated by CMake
+
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <chrono>
+#include <fstream>
 #include <iomanip>
 #include <iterator>
 #include <mutex>
+#include <sstream>
 #include <string.h>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <sys/stat.h>
+#include <cpptoml.h>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
 
 #include "../../lib/utility/FileFormat.h"
 #include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/TOMLSanitize.h"
 #include "../../lib/utility/make_unique.h"
 #include "../../lib/shmemdf/SharedFrameHeader.h"
 
@@ -96,9 +105,6 @@ Recorder::Recorder(const std::vector<std::string> &position_source_addresses,
     }
 
     name_ +="]";
-
-    // Start the recording tread
-    writer_thread_ = std::thread( [this] { writeLoop(); } );
 }
 
 Recorder::~Recorder() {
@@ -109,11 +115,157 @@ Recorder::~Recorder() {
     // look at a video before the recorder destructs because it will be
     // incomplete! Same with the position file.
 
-    // TODO: Join writer thread
-    // Set running to false to trigger thread join
-    running_ = false;
-    writer_condition_variable_.notify_one();
-    writer_thread_.join();
+    // A segment that was opened in advance but never used is removed
+    if (next_segment_.valid()) {
+        try {
+            closeSegment(next_segment_.get(), true);
+        } catch (...) {
+            // Failed to open, so there is nothing to remove
+        }
+    }
+
+    if (segment_) {
+
+        // Hand over any samples still held from before recording started
+        if (record_on_ && !initialization_required_) {
+            while (flushPreTrigger())
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        // Set running to false to trigger writer thread joins
+        segment_->running = false;
+        for (auto &t : segment_->threads)
+            t.join();
+
+        printStats(std::cout);
+        closeSegment(std::move(segment_), false);
+
+        auto &r = segment_records_.back();
+        r.last_sample = last_sample_;
+        r.closed = true;
+    }
+
+    for (auto &f : closing_segments_)
+        f.wait();
+
+    if (!manifest_path_.empty())
+        writeManifest();
+}
+
+void Recorder::configure(const std::string &config_file,
+                         const std::string &config_key) {
+
+    // Available options
+    std::vector<std::string> options {"video"};
+    std::vector<std::string> video_options {"codec",
+                                            "container",
+                                            "quality",
+                                            "threads"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Video encoding
+        oat::config::Table video_config;
+        if (oat::config::getTable(this_config, "video", video_config)) {
+
+            oat::config::checkKeys(video_options, video_config);
+
+            const std::string video_key = config_key + ".video";
+
+            std::string codec;
+            if (oat::config::getValue(video_config, "codec", codec)) {
+                if (codec.size() != 4)
+                    throw (std::runtime_error(oat::configValueError(
+                        "codec", video_key, config_file,
+                        "must be a four character code, e.g. 'H264' or 'MJPG'.")));
+                video_format_.codec = codec;
+            }
+
+            std::string container;
+            if (oat::config::getValue(video_config, "container", container)) {
+                if (container.empty() || container.find('/') != std::string::npos)
+                    throw (std::runtime_error(oat::configValueError(
+                        "container", video_key, config_file,
+                        "must be a file extension, e.g. 'avi' or 'mkv'.")));
+                if (container[0] == '.')
+                    container.erase(0, 1);
+                video_format_.container = container;
+            }
+
+            int64_t quality;
+            if (oat::config::getValue(video_config, "quality", quality,
+                                      static_cast<int64_t>(0),
+                                      static_cast<int64_t>(100)))
+                video_format_.quality = quality;
+
+            int64_t threads;
+            if (oat::config::getValue(video_config, "threads", threads,
+                                      static_cast<int64_t>(0)))
+                video_format_.threads = threads;
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+void Recorder::printStats(std::ostream &out) const {
+
+    // Segments are swapped by the recording thread
+    std::lock_guard<std::mutex> lock(segment_mutex_);
+    if (!segment_)
+        return;
+
+    auto queue = [](const oat::QueueStats &s) {
+        return "queue " + std::to_string(s.depth) + "/"
+               + std::to_string(s.capacity) + ", high-water "
+               + std::to_string(s.high_water) + ", "
+               + std::to_string(s.drops) + " dropped";
+    };
+
+    for (fvec_size_t i = 0; i < segment_->frame_writers.size(); i++) {
+
+        const auto &w = segment_->frame_writers[i];
+        auto stats = w->stats();
+        if (!stats.empty())
+            stats += ", ";
+        out << oat::whoMessage(name_, frame_sources_[i].name + ": " + stats
+                               + queue(w->queueStats()) + ".\n");
+    }
+
+    for (pvec_size_t i = 0; i < segment_->position_writers.size(); i++) {
+
+        const auto &w = segment_->position_writers[i];
+        out << oat::whoMessage(name_, position_sources_[i].name + ": "
+                               + queue(w->queueStats()) + ".\n");
+    }
+}
+
+void Recorder::warnDrop(const std::string &source_name,
+                        const oat::QueueStats &stats) const {
+
+    // Only the first drop of each writer is reported. The total is available
+    // from printStats.
+    if (stats.drops != 1)
+        return;
+
+    std::cerr << oat::whoWarn(name_, source_name + ": record buffer overrun. "
+                              "Samples are being dropped. You can:\n"
+                              " - decrease the sample rate\n"
+                              " - increase --queue-depth\n"
+                              " - use multiple recorders on multiple disks\n"
+                              " - or, get a faster hard disk\n");
 }
 
 void Recorder::connectToNodes() {
@@ -142,6 +294,126 @@ void Recorder::connectToNodes() {
     if (!oat::checkSamplePeriods(all_ts, sample_rate_hz_)) {
         std::cerr << oat::Warn(oat::inconsistentSampleRateWarning(sample_rate_hz_));
     }
+
+    if (pre_trigger_sec_ > 0)
+        allocatePreTrigger();
+}
+
+void Recorder::allocatePreTrigger() {
+
+    if (sample_rate_hz_ <= 0)
+        throw (std::runtime_error("A pre-trigger buffer requires SOURCEs "
+                                  "with a known sample rate."));
+
+    const size_t capacity =
+        static_cast<size_t>(std::ceil(pre_trigger_sec_ * sample_rate_hz_));
+
+    size_t bytes = 0;
+
+    for (auto &fs : frame_sources_) {
+
+        // Each slot is allocated with the size and type of the SOURCE's frames
+        auto f = fs.source->retrieve();
+        oat::Frame slot(cv::Mat(f.rows, f.cols, f.type()));
+        frame_rings_.emplace_back(capacity, slot);
+        bytes += capacity * f.total() * f.elemSize();
+    }
+
+    for (auto &ps : position_sources_) {
+        position_rings_.emplace_back(capacity, *ps.source->retrieve());
+        bytes += capacity * sizeof(oat::Position2D);
+    }
+
+    std::cout << oat::whoMessage(name_,
+                 "Pre-trigger buffer holds " + std::to_string(capacity)
+                 + " samples per SOURCE ("
+                 + std::to_string(bytes / (1024 * 1024)) + " MiB).\n");
+}
+
+bool Recorder::flushPreTrigger() {
+
+    bool held = false;
+
+    // Held samples are handed over only as fast as the writers' queues have
+    // room for them, so starting a recording neither stalls acquisition nor
+    // requires queues that can take a full ring at once. Samples read in the
+    // meantime are held behind them (see pushSample).
+    for (fvec_size_t i = 0; i < frame_rings_.size(); i++) {
+        auto &ring = frame_rings_[i];
+        auto &writer = segment_->frame_writers[i];
+        while (!ring.empty() && writer->tryPush(ring.front())) {
+            if (i == 0)
+                noteSample(ring.front().sample().count());
+            ring.pop();
+        }
+        held |= !ring.empty();
+    }
+
+    for (pvec_size_t i = 0; i < position_rings_.size(); i++) {
+        auto &ring = position_rings_[i];
+        auto &writer = segment_->position_writers[i];
+        const bool first_source = i == 0 && frame_rings_.empty();
+        while (!ring.empty() && writer->tryPush(ring.front())) {
+            if (first_source)
+                noteSample(ring.front().sample().count());
+            ring.pop();
+        }
+        held |= !ring.empty();
+    }
+
+    return held;
+}
+
+bool Recorder::holdingPreTrigger() const {
+
+    for (const auto &r : frame_rings_)
+        if (!r.empty())
+            return true;
+
+    for (const auto &r : position_rings_)
+        if (!r.empty())
+            return true;
+
+    return false;
+}
+
+template <typename T, typename W>
+void Recorder::pushSample(oat::PreTriggerBuffer<T> *ring, W &writer,
+                          const T &sample, const std::string &name,
+                          const bool first_source) {
+
+    // Held samples are still being handed over, so this one is held behind
+    // them. If the ring is full, its oldest sample is pushed now or dropped.
+    if (ring != nullptr && !ring->empty()) {
+
+        if (ring->full()) {
+            if (first_source)
+                noteSample(ring->front().sample().count());
+            if (!writer.push(ring->front()))
+                warnDrop(name, writer.queueStats());
+            ring->pop();
+        }
+
+        ring->store(sample);
+        return;
+    }
+
+    if (first_source)
+        noteSample(sample.sample().count());
+    if (!writer.push(sample))
+        warnDrop(name, writer.queueStats());
+}
+
+void Recorder::noteSample(const uint64_t count) {
+
+    last_sample_ = count;
+    segment_->num_samples++;
+
+    auto &r = segment_records_.back();
+    if (!r.started) {
+        r.first_sample = count;
+        r.started = true;
+    }
 }
 
 bool Recorder::writeStreams() {
@@ -151,82 +423,378 @@ bool Recorder::writeStreams() {
         initialization_required_ = false;
     }
 
-    // Read frames
-    for (fvec_size_t i = 0; i !=  frame_sources_.size(); i++) {
+    // Writers exist only after initialization
+    const bool record = record_on_ && !initialization_required_;
 
-         // START CRITICAL SECTION //
-        ////////////////////////////
-        source_eof_ |= (frame_sources_[i].source->wait() == oat::NodeState::END);
+    // Files are swapped between samples so that the segments of every
+    // SOURCE begin with the same sample. SOURCEs' held samples are handed
+    // over at different rates, so this waits until all have been.
+    if (record && !holdingPreTrigger() && segmentFull())
+        rotateSegment();
 
-        // Push newest frame into write queue
-        if (record_on_)
-            frame_writers_[i]->push(frame_sources_[i].source->clone());
+    // Samples held while recording was off are written before new ones
+    if (record)
+        flushPreTrigger();
 
-        frame_sources_[i].source->post();
-        ////////////////////////////
-        //  END CRITICAL SECTION  //
+    pending_sources_.clear();
+    for (size_t i = 0; i != frame_sources_.size() + position_sources_.size(); i++)
+        pending_sources_.push_back(i);
+
+    // Read SOURCEs in the order in which they become ready so that a slow
+    // upstream component does not delay releasing the others
+    while (!pending_sources_.empty()) {
+
+        auto it = std::remove_if(pending_sources_.begin(),
+                                 pending_sources_.end(),
+                                 [this, record](const size_t idx) {
+                                     return readSource(idx, false, record);
+                                 });
+
+        if (it != pending_sources_.end()) {
+            pending_sources_.erase(it, pending_sources_.end());
+            continue;
+        }
+
+        // Nothing was ready, so wait briefly on the first pending SOURCE
+        // before polling all of them again
+        if (readSource(pending_sources_.front(), true, record))
+            pending_sources_.erase(pending_sources_.begin());
     }
 
-    // Read positions
-    for (pvec_size_t i = 0; i !=  position_sources_.size(); i++) {
+    return source_eof_;
+}
+
+bool Recorder::readSource(const size_t idx, const bool block, const bool record) {
+
+    oat::NodeState state;
+
+    if (idx < frame_sources_.size()) {
+
+        auto &source = frame_sources_[idx].source;
 
         // START CRITICAL SECTION //
         ////////////////////////////
-        source_eof_ |= (position_sources_[i].source->wait() == oat::NodeState::END);
+        if (block ? !source->tryWait(state, oat::msec_t(1))
+                  : !source->tryWait(state))
+            return false;
+
+        source_eof_ |= (state == oat::NodeState::END);
+
+        // Copy newest frame into write queue, or hold it in case recording
+        // is started
+        if (record) {
+            pushSample(frame_rings_.empty() ? nullptr : &frame_rings_[idx],
+                       *segment_->frame_writers[idx],
+                       source->retrieve(),
+                       frame_sources_[idx].name,
+                       idx == 0);
+        } else if (!frame_rings_.empty())
+            frame_rings_[idx].store(source->retrieve());
+
+        source->post();
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
 
-        // Push newest position into write queue
-        if (record_on_)
-            position_writers_[i]->push(position_sources_[i].source->clone());
+    } else {
 
-        position_sources_[i].source->post();
+        const size_t i = idx - frame_sources_.size();
+        auto &source = position_sources_[i].source;
+
+        // START CRITICAL SECTION //
+        ////////////////////////////
+        if (block ? !source->tryWait(state, oat::msec_t(1))
+                  : !source->tryWait(state))
+            return false;
+
+        source_eof_ |= (state == oat::NodeState::END);
+
+        // Copy newest position into write queue, or hold it in case
+        // recording is started
+        if (record) {
+            pushSample(position_rings_.empty() ? nullptr : &position_rings_[i],
+                       *segment_->position_writers[i],
+                       *source->retrieve(),
+                       position_sources_[i].name,
+                       idx == 0);
+        } else if (!position_rings_.empty())
+            position_rings_[i].store(*source->retrieve());
+
+        source->post();
         ////////////////////////////
         //  END CRITICAL SECTION  //
     }
 
-    // Notify the writer thread that there are new queued samples
-    writer_condition_variable_.notify_one();
+    return true;
+}
 
-    return source_eof_;
+template <typename W>
+void Recorder::writeLoop(W &writer, const std::atomic<bool> &running) {
+
+    while (running) {
+        writer.waitForData(std::chrono::milliseconds(10));
+        writer.write();
+    }
+
+    // Flush samples that were pushed before the recorder stopped
+    writer.write();
 }
 
-void Recorder::writeLoop() {
+// TODO: clone()'s below are not thread safe
+void Recorder::initializeRecording() {
+
+    if (segment_sec_ > 0 && sample_rate_hz_ <= 0)
+        throw (std::runtime_error("Segmenting by duration requires SOURCEs "
+                                  "with a known sample rate."));
+
+    timestamp_ = oat::createTimeStamp();
+
+    // Writers are initialized using these samples, including those of
+    // segments opened later on other threads
+    for (auto &p : position_sources_)
+        position_templates_.push_back(p.source->clone());
+
+    for (auto &s : frame_sources_)
+        frame_templates_.push_back(s.source->clone());
+
+    size_t bytes = 0;
+    for (fvec_size_t i = 0; i < frame_templates_.size(); i++) {
+        const auto &f = frame_templates_[i];
+        bytes += frameQueueDepth(i) * f.total() * f.elemSize();
+    }
+
+    if (bytes > 0)
+        std::cout << oat::whoMessage(name_,
+                     "Frame queues preallocated ("
+                     + std::to_string(bytes / (1024 * 1024)) + " MiB"
+                     + (segmented() ? " per segment" : "") + ").\n");
 
-    while (running_) {
+    auto segment = createSegment(0);
+    segment_records_.push_back({0, 0, 0, false, false, segment->files()});
 
-        std::unique_lock<std::mutex> lk(writer_mutex_);
-        writer_condition_variable_.wait_for(lk, std::chrono::milliseconds(10));
+    {
+        std::lock_guard<std::mutex> lock(segment_mutex_);
+        segment_ = std::move(segment);
+    }
 
-        //std::cout << "Dummy write.\n";
-        for (auto &w: frame_writers_)
-            w->write();
+    if (segmented()) {
 
-        for (auto &w: position_writers_)
-            w->write();
+        manifest_path_ = generateFileName(timestamp_, "manifest", ".json");
+        writeManifest();
+
+        // Open the next segment ahead of time so that it can be swapped in
+        // without delay
+        next_segment_ = std::async(std::launch::async,
+                                   &Recorder::createSegment, this, 1);
     }
 }
 
-// TODO: clone()'s below are not thread safe
-void Recorder::initializeRecording() {
+std::unique_ptr<Recorder::Segment>
+Recorder::createSegment(const size_t index) const {
+
+    auto segment = std::make_unique<Segment>();
+    segment->index = index;
 
-    std::string timestamp = oat::createTimeStamp();
+    const int seg = segmented() ? static_cast<int>(index) : -1;
 
     // Create a writer for each position source
-    for (auto &p : position_sources_) {
+    for (pvec_size_t i = 0; i < position_sources_.size(); i++) {
+
+        const auto &name = position_sources_[i].name;
+        auto &writers = segment->position_writers;
+
+        if (binary_file_) {
+            std::string file_path = generateFileName(timestamp_, name, ".oatpos", seg);
+            writers.push_back(std::make_unique<oat::BinaryPositionWriter>(file_path));
+        } else {
+            std::string file_path = generateFileName(
+                timestamp_, name,
+                ".json" + oat::CompressedWriteStream::extension(compression_),
+                seg);
+            auto writer = std::make_unique<oat::PositionWriter>(file_path);
+            // TODO: Hack.
+            writer->set_verbose_file(verbose_file_);
+            writer->set_compression(compression_, compression_level_);
+            writers.push_back(std::move(writer));
+        }
 
-        std::string file_path = generateFileName(timestamp, p.name, ".json");
-        position_writers_.push_back(std::make_unique<oat::PositionWriter>(file_path));
-        position_writers_.back()->initialize(p.name, p.source->clone());
-        // TODO: Hack.
-        position_writers_.back()->set_verbose_file(verbose_file_);
+        writers.back()->initialize(name, position_templates_[i]);
+        writers.back()->reserve(SAMPLE_BUFFER_SIZE, position_templates_[i]);
     }
 
     // Create a writer for each frame source
-    for (auto &s : frame_sources_) {
+    for (fvec_size_t i = 0; i < frame_sources_.size(); i++) {
+
+        const auto &name = frame_sources_[i].name;
+        auto &writers = segment->frame_writers;
+
+        if (raw_frames_) {
+            std::string file_path = generateFileName(timestamp_, name, ".oatraw", seg);
+            writers.push_back(std::make_unique<oat::RawFrameWriter>(file_path));
+        } else {
+            std::string file_path = generateFileName(
+                timestamp_, name, "." + video_format_.container, seg);
+            writers.push_back(
+                std::make_unique<oat::FrameWriter>(file_path, video_format_));
+        }
+
+        writers.back()->initialize(name, frame_templates_[i]);
+        writers.back()->reserve(frameQueueDepth(i), frame_templates_[i]);
+    }
+
+    // Start a thread for each writer
+    const auto running = &segment->running;
+
+    for (auto &w : segment->frame_writers) {
+        auto writer = w.get();
+        segment->threads.emplace_back([writer, running] { writeLoop(*writer, *running); });
+    }
+
+    for (auto &w : segment->position_writers) {
+        auto writer = w.get();
+        segment->threads.emplace_back([writer, running] { writeLoop(*writer, *running); });
+    }
+
+    return segment;
+}
+
+void Recorder::closeSegment(std::unique_ptr<Segment> segment,
+                            const bool discard) {
+
+    auto files = segment->files();
 
-        std::string file_path = generateFileName(timestamp, s.name, ".avi");
-        frame_writers_.push_back(std::make_unique<oat::FrameWriter>(file_path));
-        frame_writers_.back()->initialize(s.name, s.source->clone());
+    // Joins writer threads, which flush their writers, and then closes files
+    segment.reset();
+
+    if (discard) {
+        for (auto &f : files)
+            std::remove(f.c_str());
+    }
+}
+
+size_t Recorder::frameQueueDepth(const fvec_size_t idx) const {
+
+    if (queue_depth_ > 0)
+        return queue_depth_;
+
+    const auto &f = frame_templates_[idx];
+    const size_t frame_bytes = std::max(f.total() * f.elemSize(),
+                                        static_cast<size_t>(1));
+
+    // Enough frames to ride out encoder stalls, but no more than fit in the
+    // memory budget
+    return std::min(SAMPLE_BUFFER_SIZE,
+                    std::max(FRAME_BUFFER_BYTES / frame_bytes,
+                             static_cast<size_t>(16)));
+}
+
+bool Recorder::segmentFull() {
+
+    const uint64_t n = segment_->num_samples;
+
+    if (segment_sec_ > 0
+        && n >= static_cast<uint64_t>(std::ceil(segment_sec_ * sample_rate_hz_)))
+        return true;
+
+    // File sizes are checked about once per second since this requires a
+    // system call per file
+    const uint64_t check_period =
+        std::max(static_cast<uint64_t>(sample_rate_hz_), static_cast<uint64_t>(1));
+
+    if (segment_bytes_ > 0 && n > 0 && n % check_period == 0) {
+
+        for (auto &f : segment_->files()) {
+            struct stat st;
+            if (stat(f.c_str(), &st) == 0
+                && static_cast<uint64_t>(st.st_size) >= segment_bytes_)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+void Recorder::rotateSegment() {
+
+    // Waits if the next segment is still being opened
+    auto next = next_segment_.get();
+
+    auto &r = segment_records_.back();
+    r.last_sample = last_sample_;
+    r.closed = true;
+    segment_records_.push_back({next->index, 0, 0, false, false, next->files()});
+
+    {
+        std::lock_guard<std::mutex> lock(segment_mutex_);
+        std::swap(segment_, next);
+    }
+
+    // Flushing and closing the finished segment's files can take a while,
+    // e.g. if a video encoder is behind, so do it in the background
+    closing_segments_.push_back(
+        std::async(std::launch::async, closeSegment, std::move(next), false));
+
+    closing_segments_.erase(
+        std::remove_if(closing_segments_.begin(),
+                       closing_segments_.end(),
+                       [](const std::future<void> &f) {
+                           return f.wait_for(std::chrono::seconds(0))
+                                  == std::future_status::ready;
+                       }),
+        closing_segments_.end());
+
+    next_segment_ = std::async(std::launch::async,
+                               &Recorder::createSegment, this,
+                               segment_->index + 1);
+
+    writeManifest();
+}
+
+void Recorder::writeManifest() const {
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+
+    writer.StartObject();
+
+    writer.String("oat_version");
+    writer.String(Oat_VERSION_MAJOR "." Oat_VERSION_MINOR);
+
+    writer.String("segments");
+    writer.StartArray();
+    for (auto &r : segment_records_) {
+
+        writer.StartObject();
+
+        writer.String("index");
+        writer.Uint64(r.index);
+
+        // Sample numbers are null until known
+        writer.String("first_sample");
+        if (r.started)
+            writer.Uint64(r.first_sample);
+        else
+            writer.Null();
+
+        writer.String("last_sample");
+        if (r.closed && r.started)
+            writer.Uint64(r.last_sample);
+        else
+            writer.Null();
+
+        writer.String("files");
+        writer.StartArray();
+        for (auto &f : r.files)
+            writer.String(f.c_str());
+        writer.EndArray();
+
+        writer.EndObject();
     }
+    writer.EndArray();
+
+    writer.EndObject();
+
+    std::ofstream out(manifest_path_, std::ios::trunc);
+    out << buffer.GetString() << "\n";
 }
 
 /**
@@ -235,12 +803,19 @@ void Recorder::initializeRecording() {
  */
 std::string Recorder::generateFileName(const std::string timestamp, 
                                        const std::string &source_name,
-                                       const std::string &extension) {
+                                       const std::string &extension,
+                                       const int segment) const {
 
     std::string base_fid = source_name;
     if (!file_name_.empty())
         base_fid += "_" + file_name_;
 
+    if (segment >= 0) {
+        std::stringstream ss;
+        ss << "_" << std::setw(4) << std::setfill('0') << segment;
+        base_fid += ss.str();
+    }
+
     std::string full_path;
     int err = oat::createSavePath(full_path,
             save_path_,
@@ -20,13 +20,20 @@
 #ifndef OAT_RECORDER_H
 #define OAT_RECORDER_H
 
+#include "BinaryPositionWriter.h"
 #include "FrameWriter.h"
 #include "PositionWriter.h"
+#include "PreTriggerBuffer.h"
+#include "RawFrameWriter.h"
 
 #include <atomic>
-#include <condition_variable>
+#include <future>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 #include <boost/any.hpp>
 
 #include "../../lib/shmemdf/Helpers.h"
@@ -69,6 +76,14 @@ public:
 
     ~Recorder();
 
+    /**
+     * @brief Configure recorder parameters.
+     * @param config_file configuration file path
+     * @param config_key configuration key
+     */
+    void configure(const std::string &config_file,
+                   const std::string &config_key);
+
     /**
      * Recorder SOURCEs must be able to connect to a NODEs from
      * which to receive positions and frames.
@@ -95,6 +110,13 @@ public:
      */
     std::string name(void) { return name_; }
 
+    /**
+     * @brief Print the throughput of each frame writer, e.g. the achieved
+     * encoding frame rate.
+     * @param out Output stream
+     */
+    void printStats(std::ostream &out) const;
+
     // Accessors
     bool record_on(void) const { return record_on_; }
     void set_record_on(const bool value) { record_on_ = value; }
@@ -104,16 +126,78 @@ public:
     void set_prepend_timestamp(const bool value) { prepend_timestamp_ = value; }
     void set_allow_overwrite(const bool value) { allow_overwrite_ = value; } 
     void set_verbose_file(const bool value) { verbose_file_ = value; };
+    void set_binary_file(const bool value) { binary_file_ = value; };
+    void set_compression(const oat::CompressedWriteStream::Codec codec,
+                         const int level) {
+        compression_ = codec;
+        compression_level_ = level;
+    };
+    void set_raw_frames(const bool value) { raw_frames_ = value; };
+    void set_pre_trigger_sec(const double value) { pre_trigger_sec_ = value; };
+    void set_segment_sec(const double value) { segment_sec_ = value; };
+    void set_segment_bytes(const uint64_t value) { segment_bytes_ = value; };
+    void set_queue_depth(const size_t value) { queue_depth_ = value; };
 
 private:
 
+    /**
+     * Writers for one file of each SOURCE, and their threads.
+     */
+    struct Segment {
+
+        // Index of the segment within the recording
+        size_t index {0};
+
+        // File writers
+        std::vector< std::unique_ptr
+                   < oat::Writer<oat::Position2D> > > position_writers;
+        std::vector< std::unique_ptr
+                   < oat::Writer<oat::Frame> > > frame_writers;
+
+        // File-writer threads, one per writer
+        std::vector<std::thread> threads;
+
+        // Segment in running state (i.e. writer threads should remain
+        // responsive for new samples)
+        std::atomic<bool> running {true};
+
+        // Number of samples per SOURCE pushed to the writers
+        uint64_t num_samples {0};
+
+        ~Segment() {
+            running = false;
+            for (auto &t : threads)
+                if (t.joinable())
+                    t.join();
+        }
+
+        std::vector<std::string> files(void) const {
+            std::vector<std::string> f;
+            for (auto &w : frame_writers)
+                for (auto &p : w->files())
+                    f.push_back(p);
+            for (auto &w : position_writers)
+                for (auto &p : w->files())
+                    f.push_back(p);
+            return f;
+        }
+    };
+
+    /**
+     * Entry of the segment manifest.
+     */
+    struct SegmentRecord {
+        size_t index;
+        uint64_t first_sample;
+        uint64_t last_sample;
+        bool started;   //!< first_sample is known
+        bool closed;    //!< last_sample is known
+        std::vector<std::string> files;
+    };
+
     // Name of this recorder
     std::string name_;
 
-    // Recorder in running state (i.e. all threads should remain responsive
-    // for new data coming down the pipeline)
-    std::atomic<bool> running_ {true};
-
     // Recording gate can be toggled on and off interactively from other
     // threads and processes
     std::atomic<bool> record_on_ {true};
@@ -140,26 +224,189 @@ private:
     // write pos_xy when pos_ok = false?
     bool verbose_file_ {true};
 
+    // Determines if positions are written using the binary position log
+    // format rather than JSON
+    bool binary_file_ {false};
+
+    // Compression of JSON position files
+    oat::CompressedWriteStream::Codec compression_
+        {oat::CompressedWriteStream::Codec::NONE};
+    int compression_level_ {0};
+
+    // Determines if frames are written uncompressed using RawFrameWriter
+    // rather than encoded to a video file
+    bool raw_frames_ {false};
+
+    // Duration of the samples held while recording is off, which are written
+    // when recording starts. 0 to disable.
+    double pre_trigger_sec_ {0.0};
+
+    // Maximum duration of each file. 0 for no limit.
+    double segment_sec_ {0.0};
+
+    // Approximate maximum size of each file in bytes. 0 for no limit.
+    uint64_t segment_bytes_ {0};
+
+    // Number of frames each frame writer's queue can hold. 0 to size queues
+    // using FRAME_BUFFER_BYTES.
+    size_t queue_depth_ {0};
+
+    // Video codec, container, and encoder parameters
+    oat::VideoFormat video_format_;
+
     // Files must be initialized before first write
     bool initialization_required_ {true};
 
     // Source end of file flag
     bool source_eof_ {false};
 
-    // Executed by writer_thread_
-    void writeLoop(void);
+    /**
+     * Write samples pushed to a writer until the recorder stops. Executed by
+     * a dedicated thread for each writer so that a slow writer, e.g. a video
+     * encoder, does not delay the others.
+     * @param writer Writer to service
+     */
+    template <typename W>
+    static void writeLoop(W &writer, const std::atomic<bool> &running);
+
+    /**
+     * @brief Create and initialize writers for a segment, and start their
+     * threads. Thread safe.
+     * @param index Segment index. Appended to file names if the recording
+     * is segmented.
+     * @return Segment ready to accept samples.
+     */
+    std::unique_ptr<Segment> createSegment(const size_t index) const;
+
+    /**
+     * @brief Stop a segment's threads, flushing its writers, and close its
+     * files.
+     * @param segment Segment to close.
+     * @param discard If true, delete the segment's files, e.g. if it was
+     * never used.
+     */
+    static void closeSegment(std::unique_ptr<Segment> segment,
+                             const bool discard);
+
+    /**
+     * @brief Determine if the current segment is complete.
+     * @return True if the next sample should be written to a new segment.
+     */
+    bool segmentFull(void);
+
+    /**
+     * @brief Swap in the next, pre-opened segment, close the current one in
+     * the background, and begin opening the one after.
+     */
+    void rotateSegment(void);
+
+    /**
+     * @brief Write the list of segments and their files to the manifest.
+     */
+    void writeManifest(void) const;
+
+    /**
+     * Read a token from a SOURCE and push it to its writer.
+     * @param idx SOURCE index. Frame SOURCEs come first, followed by
+     * position SOURCEs.
+     * @param block If true, wait up to a millisecond for the token to become
+     * available. Otherwise, return immediately if it is not.
+     * @param record If true, push the token to its writer.
+     * @return True if a token was read.
+     */
+    bool readSource(const size_t idx, const bool block, const bool record);
+
+    /**
+     * @brief Allocate a pre-trigger buffer for each SOURCE, sized using the
+     * sample rate and the size of each SOURCE's samples. SOURCEs must be
+     * connected.
+     */
+    void allocatePreTrigger(void);
+
+    /**
+     * @brief Push the samples held in the pre-trigger buffers to their
+     * writers, oldest first, for as long as the writers' queues have room.
+     * @return True if samples are still held.
+     */
+    bool flushPreTrigger(void);
+
+    /**
+     * @brief True if any pre-trigger buffer holds samples that have not been
+     * pushed to its writer.
+     */
+    bool holdingPreTrigger(void) const;
+
+    /**
+     * @brief Push a sample read while recording to its writer. While the
+     * SOURCE's pre-trigger buffer is being emptied, the sample is held in it,
+     * behind older samples, instead.
+     * @param ring The SOURCE's pre-trigger buffer, or nullptr if there is
+     * none.
+     * @param writer The SOURCE's writer.
+     * @param sample Sample to push.
+     * @param name SOURCE name, for warnings.
+     * @param first_source True if this is the first SOURCE.
+     */
+    template <typename T, typename W>
+    void pushSample(oat::PreTriggerBuffer<T> *ring, W &writer,
+                    const T &sample, const std::string &name,
+                    const bool first_source);
+
+    /**
+     * @brief Record the sample number of a sample read from the first
+     * SOURCE for the segment manifest.
+     * @param count Sample number
+     */
+    void noteSample(const uint64_t count);
+
+    bool segmented(void) const { return segment_sec_ > 0 || segment_bytes_ > 0; }
+
+    /**
+     * @brief Number of frames held by the queue of a frame SOURCE's writer.
+     * @param idx Frame SOURCE index.
+     */
+    size_t frameQueueDepth(const fvec_size_t idx) const;
+
+    /**
+     * @brief Warn the first time a writer's queue overruns and a sample is
+     * dropped.
+     * @param source_name Name of the writer's SOURCE.
+     * @param stats Occupancy of the writer's queue.
+     */
+    void warnDrop(const std::string &source_name,
+                  const oat::QueueStats &stats) const;
 
     // TODO: Somehow make list of generic Writers
-    // File writers
-    std::vector< std::unique_ptr
-               < oat::PositionWriter > > position_writers_;
-    std::vector< std::unique_ptr
-               < oat::FrameWriter > > frame_writers_;
+    // Segment receiving samples. Guarded by segment_mutex_ when swapped.
+    std::unique_ptr<Segment> segment_;
+    mutable std::mutex segment_mutex_;
+
+    // Segment being opened in the background, swapped in on rotation
+    std::future<std::unique_ptr<Segment>> next_segment_;
+
+    // Segments being closed in the background
+    std::vector<std::future<void>> closing_segments_;
+
+    // Segments written so far, and the file listing them
+    std::vector<SegmentRecord> segment_records_;
+    std::string manifest_path_;
+
+    // Sample number of the last sample read from the first SOURCE
+    uint64_t last_sample_ {0};
+
+    // Start time of the recording, shared by the names of all of its files
+    std::string timestamp_;
+
+    // Samples used to initialize writers
+    std::vector<oat::Frame> frame_templates_;
+    std::vector<oat::Position2D> position_templates_;
+
+    // Pre-trigger buffers, one per SOURCE, in the same order as the SOURCEs
+    std::vector< oat::PreTriggerBuffer<oat::Frame> > frame_rings_;
+    std::vector< oat::PreTriggerBuffer<oat::Position2D> > position_rings_;
 
-    // File-writer threading
-    std::thread writer_thread_;
-    std::mutex writer_mutex_;
-    std::condition_variable writer_condition_variable_;
+    // SOURCEs that have not been read during the current call to writeStreams
+    std::vector<size_t> pending_sources_;
 
     // Frame sources
     oat::NamedSourceList<oat::SharedFrameHeader> frame_sources_;
@@ -169,7 +416,8 @@ private:
 
     std::string generateFileName(const std::string timestamp, 
                                  const std::string &source_name,
-                                 const std::string &extension); 
+                                 const std::string &extension,
+                                 const int segment = -1) const; 
 };
 
 }      /* namespace oat */
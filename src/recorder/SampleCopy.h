@@ -0,0 +1,49 @@
+//******************************************************************************
+//* File:   SampleCopy.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_SAMPLECOPY_H
+#define OAT_SAMPLECOPY_H
+
+#include "../../lib/datatypes/Frame.h"
+
+namespace oat {
+
+/**
+ * @brief Copy a sample such that the copy does not share storage with the
+ * original.
+ */
+template <typename T>
+T deepCopy(const T &sample) { return sample; }
+
+inline oat::Frame deepCopy(const oat::Frame &frame) { return frame.clone(); }
+
+/**
+ * @brief Copy a sample into preallocated storage.
+ */
+template <typename T>
+void copyInto(const T &sample, T &slot) { slot = sample; }
+
+inline void copyInto(const oat::Frame &frame, oat::Frame &slot) {
+
+    // Does not allocate if slot has frame's size and type
+    frame.copyTo(slot);
+}
+
+}      /* namespace oat */
+#endif /* OAT_SAMPLECOPY_H */
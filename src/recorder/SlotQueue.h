@@ -0,0 +1,169 @@
+//******************************************************************************
+//* File:   SlotQueue.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_SLOTQUEUE_H
+#define OAT_SLOTQUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <boost/lockfree/spsc_queue.hpp>
+
+#include "SampleCopy.h"
+
+namespace oat {
+
+/**
+ * Occupancy of a SlotQueue.
+ */
+struct QueueStats {
+    size_t capacity {0};    //!< Number of slots
+    size_t depth {0};       //!< Slots currently holding samples
+    size_t high_water {0};  //!< Maximum depth reached
+    uint64_t drops {0};     //!< Samples discarded because the queue was full
+};
+
+/**
+ * Single-producer, single-consumer queue of samples backed by a pool of
+ * preallocated slots. Pushing a sample copies it into a free slot, e.g. a
+ * frame is copied straight out of shared memory, so no allocations are made
+ * once the pool exists. Slots are returned to the pool after the consumer
+ * has processed them. Indices of free and filled slots are passed between the
+ * two threads using lock-free queues.
+ */
+template <typename T>
+class SlotQueue {
+
+    using IndexQueue = boost::lockfree::spsc_queue<size_t>;
+
+public:
+
+    /**
+     * @brief Allocate the slot pool. Must be called before the queue is used
+     * and not concurrently with push or consume.
+     * @param capacity Number of slots.
+     * @param sample_template Sample defining the size of each slot, e.g. the
+     * dimensions and type of a frame.
+     */
+    void allocate(const size_t capacity, const T &sample_template) {
+
+        slots_.clear();
+        slots_.reserve(capacity);
+        for (size_t i = 0; i < capacity; i++)
+            slots_.push_back(deepCopy(sample_template));
+
+        free_.reset(new IndexQueue(std::max(capacity, static_cast<size_t>(1))));
+        filled_.reset(new IndexQueue(std::max(capacity, static_cast<size_t>(1))));
+        for (size_t i = 0; i < capacity; i++)
+            free_->push(i);
+
+        depth_ = 0;
+        high_water_ = 0;
+        drops_ = 0;
+    }
+
+    /**
+     * @brief Copy a sample into a free slot and queue it. Producer only.
+     * @return False if there are no free slots, in which case the sample is
+     * counted as dropped.
+     */
+    bool push(const T &sample) {
+
+        if (tryPush(sample))
+            return true;
+
+        drops_++;
+        return false;
+    }
+
+    /**
+     * @brief Copy a sample into a free slot and queue it. Producer only.
+     * @return False if there are no free slots. The sample is not counted as
+     * dropped, e.g. because the caller will retry.
+     */
+    bool tryPush(const T &sample) {
+
+        size_t i;
+        if (!free_ || !free_->pop(i))
+            return false;
+
+        copyInto(sample, slots_[i]);
+        filled_->push(i);
+
+        const size_t d = ++depth_;
+        if (d > high_water_.load(std::memory_order_relaxed))
+            high_water_.store(d, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    /**
+     * @brief Pass each queued sample, oldest first, to a callback and return
+     * its slot to the pool. Consumer only. The slot is reused once the
+     * callback returns, so the callback must copy any sample it needs to
+     * keep.
+     * @param f Callback taking a const T &.
+     * @return Number of samples consumed.
+     */
+    template <typename F>
+    size_t consume(F f) {
+
+        if (!filled_)
+            return 0;
+
+        size_t n = 0;
+        size_t i;
+        while (filled_->pop(i)) {
+            f(static_cast<const T &>(slots_[i]));
+            free_->push(i);
+            depth_--;
+            n++;
+        }
+
+        return n;
+    }
+
+    size_t depth(void) const { return depth_.load(); }
+
+    QueueStats stats(void) const {
+        QueueStats s;
+        s.capacity = slots_.size();
+        s.depth = depth_.load();
+        s.high_water = high_water_.load();
+        s.drops = drops_.load();
+        return s;
+    }
+
+private:
+
+    std::vector<T> slots_;
+    std::unique_ptr<IndexQueue> free_;
+    std::unique_ptr<IndexQueue> filled_;
+
+    // Occupancy, readable from any thread
+    std::atomic<size_t> depth_ {0};
+    std::atomic<size_t> high_water_ {0};
+    std::atomic<uint64_t> drops_ {0};
+};
+
+}      /* namespace oat */
+#endif /* OAT_SLOTQUEUE_H */
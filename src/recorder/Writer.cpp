@@ -77,7 +77,7 @@ void Writer<oat::Position2D>::initialize(
 
 void Writer<oat::Position2D>::write(void) {
 
-   oat::Position2D p("");
+   oat::Position2D p;
    while (buffer_.pop(p)) {
 
        // File desriptor must be avaiable for writing
@@ -20,9 +20,11 @@
 #ifndef OAT_WRITER_H
 #define OAT_WRITER_H
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <string>
-//#include <chrono>
-#include <boost/lockfree/spsc_queue.hpp>
+#include <vector>
 #include <opencv2/videoio.hpp>
 #include <rapidjson/filewritestream.h>
 #include <rapidjson/prettywriter.h>
@@ -31,10 +33,16 @@
 #include "../../lib/datatypes/Frame.h"
 #include "../../lib/datatypes/Position2D.h"
 
+#include "SlotQueue.h"
+
 namespace oat {
-namespace blf = boost::lockfree;
 
-static constexpr int SAMPLE_BUFFER_SIZE {1000};
+// Maximum number of samples held by each writer's queue
+static constexpr size_t SAMPLE_BUFFER_SIZE {1000};
+
+// Default memory budget of each frame writer's queue, whose slots are
+// allocated up front
+static constexpr size_t FRAME_BUFFER_BYTES {256 * 1024 * 1024};
 
 /**
  * Generic, abstract file writer for a single data source
@@ -42,9 +50,6 @@ static constexpr int SAMPLE_BUFFER_SIZE {1000};
 template <typename T>
 class Writer {
 
-using SPSCBuffer =
-    boost::lockfree::spsc_queue<T, blf::capacity<SAMPLE_BUFFER_SIZE>>;
-
 public:
 
     Writer(const std::string &path) :
@@ -54,6 +59,8 @@ public:
             throw (std::runtime_error("Write permission denied for " + path_));
     }
 
+    virtual ~Writer() { }
+
     /**
      * @brief Create and initialize recording file(s). Must be called
      * before writeStreams.
@@ -61,22 +68,73 @@ public:
     virtual void initialize(const std::string &source_name,
                             const T &sample_template) = 0;
 
+    /**
+     * @brief Allocate the slots of the internal sample buffer. Must be called
+     * before samples are pushed.
+     * @param capacity Number of samples the buffer can hold.
+     * @param sample_template Sample defining the size of each slot.
+     */
+    void reserve(const size_t capacity, const T &sample_template) {
+        buffer_.allocate(capacity, sample_template);
+    }
+
     /**
      * @brief Flush internal sample buffer to file.
      */
     virtual void write(void) = 0;
 
     /**
-     * @brief Push a sample onto the internal, lock-free, thread-safe buffer
-     * @return False if there is an overflow condition. True otherwise.
+     * @brief Files written by this writer.
+     */
+    virtual std::vector<std::string> files(void) const { return {path_}; }
+
+    /**
+     * @brief Throughput of this writer in human readable form.
+     * @return Report, or an empty string if this writer does not track its
+     * throughput.
+     */
+    virtual std::string stats(void) const { return ""; }
+
+    /**
+     * @brief Occupancy of the internal sample buffer. Thread safe.
+     */
+    oat::QueueStats queueStats(void) const { return buffer_.stats(); }
+
+    /**
+     * @brief Copy a sample into the internal, lock-free, thread-safe buffer.
+     * @return False if there is an overflow condition, in which case the
+     * sample is dropped. True otherwise.
+     */
+    bool push(const T &sample) {
+        if (!buffer_.push(sample))
+            return false;
+
+        data_ready_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Copy a sample into the internal buffer if it has room.
+     * @return False if the buffer is full, in which case the sample is not
+     * counted as dropped so that the caller can retry. True otherwise.
      */
-    void push(const T &sample) {
-        if (!buffer_.push(sample)) {
-            throw (std::runtime_error("Record buffer overrun. You can:\n"
-                                      " - decrease the sample rate\n"
-                                      " - use multiple recorders on multiple disks\n"
-                                      " - or, get a faster hard disk"));
-        }
+    bool tryPush(const T &sample) {
+        if (!buffer_.tryPush(sample))
+            return false;
+
+        data_ready_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Block the writing thread until samples have been pushed or the
+     * timeout expires.
+     * @param timeout Maximum time to wait
+     */
+    void waitForData(const std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lk(data_mutex_);
+        data_ready_.wait_for(lk, timeout,
+                             [this] { return buffer_.depth() > 0; });
     }
 
 protected:
@@ -89,7 +147,13 @@ protected:
     /** 
      * @brief Lock-free, thread-safe buffer which is flushed to file with each call to write. 
      */
-    SPSCBuffer buffer_;
+    oat::SlotQueue<T> buffer_;
+
+    /**
+     * @brief Signals the writing thread that samples have been pushed.
+     */
+    std::mutex data_mutex_;
+    std::condition_variable data_ready_;
 };
 
 }      /* namespace oat */
@@ -30,6 +30,7 @@
 #include <zmq.hpp>
 #include <boost/iostreams/stream.hpp>
 #include <boost/program_options.hpp>
+#include <cpptoml.h>
 
 #include "../../lib/utility/ZMQStream.h"
 #include "../../lib/utility/IOFormat.h"
@@ -49,6 +50,15 @@ std::string save_path;
 bool allow_overwrite = false;
 bool prepend_timestamp = false;
 bool concise_file = false;
+bool binary_file = false;
+std::string compression;
+int compression_level = 0;
+bool raw_frames = false;
+double pre_trigger_sec = 0.0;
+double segment_sec = 0.0;
+double segment_mb = 0.0;
+int queue_depth = 0;
+std::vector<std::string> config_fk;
 
 // ZMQ stream
 using zmq_istream_t = boost::iostreams::stream<oat::zmq_istream>;
@@ -149,6 +159,49 @@ int main(int argc, char *argv[]) {
                  "means that position objects will be of variable size depending on the "
                  "validity on whether a position was detected or not, potentially "
                  "complicating file parsing.")
+                ("binary-file,b",
+                 "If set, positions will be saved in Oat's compact binary "
+                 "position log format (.oatpos) rather than JSON. Use "
+                 "oat-convert to convert binary logs to JSON or CSV.")
+                ("compress", po::value<std::string>(&compression),
+                 "Compress JSON position files as they are written using "
+                 "'gzip' or 'zstd'. Compression is performed in blocks on a "
+                 "separate thread. Each block is flushed to disk on "
+                 "completion, or after at most one second, so a crash loses "
+                 "at most the most recent block.")
+                ("compress-level", po::value<int>(&compression_level),
+                 "Compression level. 1-9 for gzip (default 6), 1-19 for zstd "
+                 "(default 3).")
+                ("raw-frames,r",
+                 "If set, frames will be saved uncompressed (.oatraw) using "
+                 "direct, unbuffered disk writes rather than encoded to a video "
+                 "file. This removes the encoder as a bottleneck at the cost of "
+                 "disk space. A per-frame index (.oatraw.idx) is written "
+                 "alongside each recording.")
+                ("pre-trigger", po::value<double>(&pre_trigger_sec),
+                 "Seconds of frames and positions to hold in memory while "
+                 "recording is paused. These are written to file when "
+                 "recording is started, before live samples, so that the "
+                 "period preceding a start command is not lost. Memory is "
+                 "allocated once, on connection to the SOURCES.")
+                ("segment-duration", po::value<double>(&segment_sec),
+                 "Split each stream into files of at most this many seconds. "
+                 "The next files are opened in advance and swapped in between "
+                 "samples, so no samples are lost. A manifest listing the "
+                 "files and the samples they contain is saved alongside them.")
+                ("segment-size", po::value<double>(&segment_mb),
+                 "Split each stream into files of approximately this many "
+                 "megabytes. Can be combined with --segment-duration, in which "
+                 "case a new file is started when either limit is reached.")
+                ("queue-depth", po::value<int>(&queue_depth),
+                 "Number of frames each frame SOURCE's writer can hold while "
+                 "waiting to be written to disk. Memory for these is "
+                 "allocated when recording starts. If a writer falls further "
+                 "behind, frames are dropped. Defaults to as many frames as fit "
+                 "in 256 MiB, up to 1000.")
+                ("config", po::value<std::vector<std::string> >()->multitoken(),
+                 "Configuration file/key pair, e.g. 'config.toml recorder'. "
+                 "Video encoding is configured in the 'video' sub-table.")
                 ("interactive", "Start recorder with interactive controls enabled.")
                 ("rpc-endpoint", po::value<std::string>(&rpc_endpoint),
                  "Yield interactive control of the recorder to a remote ZMQ REQ "
@@ -244,6 +297,48 @@ int main(int argc, char *argv[]) {
         if (variable_map.count("concise-file"))
             concise_file = true;
 
+        if (variable_map.count("binary-file"))
+            binary_file = true;
+
+        if (variable_map.count("raw-frames"))
+            raw_frames = true;
+
+        if (!compression.empty() && compression != "gzip" && compression != "zstd") {
+            printUsage(std::cout, all_options);
+            std::cerr << oat::Error("Compression must be 'gzip' or 'zstd'.\n");
+            return -1;
+        }
+
+        if (pre_trigger_sec < 0) {
+            printUsage(std::cout, all_options);
+            std::cerr << oat::Error("Pre-trigger duration must be positive.\n");
+            return -1;
+        }
+
+        if (segment_sec < 0 || segment_mb < 0) {
+            printUsage(std::cout, all_options);
+            std::cerr << oat::Error("Segment duration and size must be positive.\n");
+            return -1;
+        }
+
+        if (variable_map.count("queue-depth") && queue_depth < 1) {
+            printUsage(std::cout, all_options);
+            std::cerr << oat::Error("Queue depth must be at least 1.\n");
+            return -1;
+        }
+
+        // Check for configuration file and key
+        if (!variable_map["config"].empty()) {
+
+            config_fk = variable_map["config"].as<std::vector<std::string> >();
+
+            if (config_fk.size() != 2) {
+                printUsage(std::cout, all_options);
+                std::cerr << oat::Error("Configuration must be supplied as file key pair.\n");
+                return -1;
+            }
+        }
+
     } catch (std::exception& e) {
         std::cerr << oat::Error(e.what()) << "\n";
         return -1;
@@ -301,6 +396,22 @@ int main(int argc, char *argv[]) {
             recorder->set_prepend_timestamp(prepend_timestamp);
             recorder->set_allow_overwrite(allow_overwrite);
             recorder->set_verbose_file(!concise_file);
+            recorder->set_binary_file(binary_file);
+            if (compression == "gzip")
+                recorder->set_compression(oat::CompressedWriteStream::Codec::GZIP,
+                                          compression_level);
+            else if (compression == "zstd")
+                recorder->set_compression(oat::CompressedWriteStream::Codec::ZSTD,
+                                          compression_level);
+            recorder->set_raw_frames(raw_frames);
+            recorder->set_pre_trigger_sec(pre_trigger_sec);
+            recorder->set_segment_sec(segment_sec);
+            recorder->set_segment_bytes(static_cast<uint64_t>(segment_mb * 1e6));
+            recorder->set_queue_depth(static_cast<size_t>(queue_depth));
+
+            // Process configuration file if provided
+            if (!config_fk.empty())
+                recorder->configure(config_fk[0], config_fk[1]);
 
             switch (control_mode)
             {
@@ -367,6 +478,11 @@ int main(int argc, char *argv[]) {
         std::cout << oat::whoMessage(name, "Exiting.\n");
         return 0;
 
+    } catch (const cpptoml::parse_exception &ex) {
+        std::cerr << oat::whoError(name,
+                     "Failed to parse configuration file " + config_fk[0] + "\n")
+                  << oat::whoError(name, ex.what())
+                  << "\n";
     } catch (const std::runtime_error &ex) {
         std::cerr << oat::whoError(name, ex.what()) << "\n";
     } catch (const cv::Exception &ex) {
@@ -0,0 +1,306 @@
+//******************************************************************************
+//* File:   Triangulator.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cpptoml.h>
+
+#include <opencv2/core.hpp>
+
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/TOMLSanitize.h"
+#include "../../lib/utility/make_unique.h"
+
+#include "Triangulator.h"
+
+namespace oat {
+
+Triangulator::Triangulator(
+                        const std::vector<std::string> &position_source_addresses,
+                        const std::string &position_sink_address) :
+  name_("triangulate[" + position_source_addresses[0] + "...->" + position_sink_address + "]")
+, position_sink_address_(position_sink_address)
+{
+    for (auto &addr : position_source_addresses) {
+
+        positions_.push_back(oat::Position2D());
+        position_sources_.push_back(
+            oat::NamedSource<oat::Position2D>(
+                addr,
+                std::make_unique<oat::Source<oat::Position2D>>()
+            )
+        );
+    }
+}
+
+void Triangulator::configure(const std::string &config_file,
+                             const std::string &config_key) {
+
+    // Available options
+    std::vector<std::string> options {"cameras",
+                                      "projection",
+                                      "max_error"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Number of cameras
+        int64_t cameras;
+        if (oat::config::getValue(this_config, "cameras", cameras, (int64_t)2))
+            num_cameras_ = cameras;
+
+        if (position_sources_.size() % num_cameras_ != 0)
+            throw (std::runtime_error(oat::configValueError(
+                "cameras", config_key, config_file,
+                "must evenly divide the number of SOURCES.")));
+
+        num_targets_ = position_sources_.size() / num_cameras_;
+
+        // Projection matrices, row-major, one after the other
+        oat::config::Array proj_array;
+        oat::config::getArray(this_config, "projection", proj_array,
+                              12 * num_cameras_, true);
+
+        auto proj_vec = proj_array->array_of<double>();
+        projections_.resize(num_cameras_);
+        for (size_t c = 0; c < num_cameras_; c++)
+            for (int k = 0; k < 12; k++)
+                projections_[c](k / 4, k % 4) = proj_vec[12 * c + k]->get();
+
+        // Reprojection error gate
+        oat::config::getValue(this_config, "max_error", max_error_px_, 0.0);
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+std::vector<std::string> Triangulator::sink_addresses() const {
+
+    if (num_targets_ == 1)
+        return {position_sink_address_};
+
+    std::vector<std::string> addrs;
+    for (size_t i = 0; i < num_targets_; i++)
+        addrs.push_back(position_sink_address_ + "_" + std::to_string(i));
+
+    return addrs;
+}
+
+void Triangulator::connectToNodes() {
+
+    if (projections_.size() != num_cameras_)
+        throw (std::runtime_error("Camera projection matrices must be "
+                                  "provided via a configuration file.\n"));
+
+    // Establish our slot in each node
+    for (auto &ps : position_sources_)
+        ps.source->touch(ps.name);
+
+    // Examine sample period of sources to make sure they are the same
+    double sample_rate_hz;
+    std::vector<double> all_ts;
+
+    // Wait for sychronous start with sink when it binds the node
+    for (auto &ps : position_sources_) {
+        ps.source->connect();
+        all_ts.push_back(ps.source->retrieve()->sample().period_sec().count());
+    }
+
+    if (!oat::checkSamplePeriods(all_ts, sample_rate_hz)) {
+        std::cerr << oat::Warn(oat::inconsistentSampleRateWarning(sample_rate_hz));
+    }
+
+    // Bind a sink node for each target
+    for (const auto &addr : sink_addresses()) {
+
+        outputs_.push_back(oat::Position3D());
+        outputs_.back().set_unit_of_length(oat::DistanceUnit::WORLD);
+        position_sinks_.push_back(std::make_unique<oat::Sink<oat::Position3D>>());
+        position_sinks_.back()->bind(addr);
+        shared_positions_.push_back(position_sinks_.back()->retrieve());
+    }
+}
+
+bool Triangulator::readSource(const size_t idx) {
+
+    auto &source = position_sources_[idx].source;
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+    if (source->wait() == oat::NodeState::END)
+        return true;
+
+    positions_[idx] = source->clone();
+
+    source->post();
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    return false;
+}
+
+bool Triangulator::readMatched() {
+
+    for (size_t i = 0; i != position_sources_.size(); i++)
+        if (readSource(i))
+            return true;
+
+    // Advance SOURCES that are behind the newest sample until all agree
+    for (;;) {
+
+        uint64_t newest = 0;
+        for (const auto &p : positions_)
+            newest = std::max(newest, p.sample().count());
+
+        bool matched = true;
+        for (size_t i = 0; i != positions_.size(); i++) {
+            while (positions_[i].sample().count() < newest) {
+                matched = false;
+                if (readSource(i))
+                    return true;
+            }
+        }
+
+        if (matched)
+            return false;
+    }
+}
+
+bool Triangulator::process() {
+
+    if (readMatched())
+        return true;
+
+    triangulate();
+
+    for (size_t i = 0; i != position_sinks_.size(); i++) {
+
+        // START CRITICAL SECTION //
+        ////////////////////////////
+
+        // Wait for sources to read
+        position_sinks_[i]->wait();
+
+        *shared_positions_[i] = outputs_[i];
+
+        // Tell sources there is new data
+        position_sinks_[i]->post();
+
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+    }
+
+    // Sink was not at END state
+    return false;
+}
+
+void Triangulator::triangulate() {
+
+    for (size_t t = 0; t < num_targets_; t++) {
+
+        auto &out = outputs_[t];
+        out.sample() = positions_[t].sample();
+        out.position_valid = false;
+
+        // Linear least-squares triangulation: each camera that sees the
+        // target contributes two rows, a, to the system a . [X 1] = 0, which
+        // are accumulated directly into 3x3 normal equations.
+        cv::Matx33d normal = cv::Matx33d::zeros();
+        cv::Vec3d rhs(0, 0, 0);
+        size_t n = 0;
+
+        for (size_t c = 0; c < num_cameras_; c++) {
+
+            const auto &pos = positions_[c * num_targets_ + t];
+            if (!pos.position_valid)
+                continue;
+
+            if (pos.unit_of_length() != oat::DistanceUnit::PIXELS)
+                throw (std::runtime_error("SOURCE positions must be in pixels "
+                                          "to be triangulated.\n"));
+
+            const auto &P = projections_[c];
+            const double uv[2] {pos.position.x, pos.position.y};
+            for (int r = 0; r < 2; r++) {
+
+                cv::Vec3d b;
+                for (int k = 0; k < 3; k++)
+                    b[k] = uv[r] * P(2, k) - P(r, k);
+                const double d = uv[r] * P(2, 3) - P(r, 3);
+
+                normal += b * b.t();
+                rhs -= b * d;
+            }
+
+            n++;
+        }
+
+        if (n < 2)
+            continue;
+
+        cv::Vec3d X;
+        if (!cv::solve(normal, rhs, X, cv::DECOMP_CHOLESKY))
+            continue;
+
+        // Reprojection error, which also rejects points behind a camera
+        double err2 = 0.0;
+        bool in_front = true;
+        for (size_t c = 0; c < num_cameras_; c++) {
+
+            const auto &pos = positions_[c * num_targets_ + t];
+            if (!pos.position_valid)
+                continue;
+
+            const cv::Vec3d x = projections_[c] * cv::Vec4d(X[0], X[1], X[2], 1.0);
+            if (x[2] <= 0.0) {
+                in_front = false;
+                break;
+            }
+
+            const double du = x[0] / x[2] - pos.position.x;
+            const double dv = x[1] / x[2] - pos.position.y;
+            err2 += du * du + dv * dv;
+        }
+
+        if (!in_front)
+            continue;
+
+        if (max_error_px_ > 0.0 && std::sqrt(err2 / n) > max_error_px_)
+            continue;
+
+        out.position = oat::Point3D(X[0], X[1], X[2]);
+        out.position_valid = true;
+    }
+}
+
+} /* namespace oat */
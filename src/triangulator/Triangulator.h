@@ -0,0 +1,128 @@
+//******************************************************************************
+//* File:   Triangulator.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_TRIANGULATOR_H
+#define	OAT_TRIANGULATOR_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/core/matx.hpp>
+
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/Position3D.h"
+#include "../../lib/shmemdf/Helpers.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+namespace oat {
+
+/**
+ * Multi-camera triangulator. Receives 2D pixel positions of one or more
+ * targets from two or more calibrated cameras, matches them by sample
+ * number, and publishes the 3D position of each target.
+ */
+class Triangulator {
+
+public:
+
+    using Projection = cv::Matx34d;
+
+    /**
+     * Multi-camera triangulator.
+     * @param position_source_addresses Position SOURCE addresses, grouped by
+     * camera: all targets seen by camera 0, then all targets seen by camera 1,
+     * and so on.
+     * @param position_sink_address SINK address. If there is more than one
+     * target, the position of target i is published to
+     * <position_sink_address>_<i>.
+     */
+    Triangulator(const std::vector<std::string> &position_source_addresses,
+                 const std::string &position_sink_address);
+
+    /**
+     * Connect to position SOURCEs and bind a SINK for each target.
+     */
+    void connectToNodes(void);
+
+    /**
+     * Obtain a matched set of positions from all SOURCEs, triangulate each
+     * target, and publish the results.
+     * @return SOURCE end-of-stream signal. If true, this component should exit.
+     */
+    bool process(void);
+
+    /**
+     * Configure triangulator parameters.
+     * @param config_file configuration file path
+     * @param config_key configuration key
+     */
+    void configure(const std::string &config_file,
+                   const std::string &config_key);
+
+    // Accessors
+    std::string name(void) const { return name_; }
+    std::vector<std::string> sink_addresses(void) const;
+
+private:
+
+    // Triangulator name
+    const std::string name_;
+
+    // 2D position SOURCEs, camera-major
+    std::vector<oat::Position2D> positions_;
+    oat::NamedSourceList<oat::Position2D> position_sources_;
+
+    // 3D position SINKs, one per target
+    const std::string position_sink_address_;
+    std::vector<oat::Position3D> outputs_;
+    std::vector<oat::Position3D *> shared_positions_;
+    std::vector<std::unique_ptr<oat::Sink<oat::Position3D>>> position_sinks_;
+
+    // Camera calibration
+    size_t num_cameras_ {2};
+    size_t num_targets_ {1};
+    std::vector<Projection> projections_;
+
+    // Maximum RMS reprojection error, in pixels, of a valid position
+    double max_error_px_ {0.0};
+
+    /**
+     * Read positions from all SOURCEs, re-reading SOURCEs that lag behind
+     * until all sample numbers agree.
+     * @return True if any SOURCE reached end-of-stream.
+     */
+    bool readMatched(void);
+
+    /**
+     * Read the next position from a SOURCE.
+     * @param idx SOURCE index
+     * @return True if the SOURCE reached end-of-stream.
+     */
+    bool readSource(const size_t idx);
+
+    /**
+     * Triangulate all targets from the current SOURCE positions.
+     */
+    void triangulate(void);
+};
+
+}      /* namespace oat */
+#endif	/* OAT_TRIANGULATOR_H */
@@ -0,0 +1,231 @@
+//******************************************************************************
+//* File:   main.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>
+#include <boost/interprocess/exceptions.hpp>
+#include <cpptoml.h>
+
+#include "../../lib/utility/IOFormat.h"
+
+#include "Triangulator.h"
+
+namespace po = boost::program_options;
+
+volatile sig_atomic_t quit = 0;
+volatile sig_atomic_t source_eof = 0;
+
+void printUsage(po::options_description options) {
+    std::cout << "Usage: triangulate [INFO]\n"
+              << "   or: triangulate SOURCES SINK CONFIGURATION\n"
+              << "Triangulate 3D positions from 2D positions produced by two or\n"
+              << "more calibrated cameras. Publish 3D positions to SINK.\n\n"
+              << "SOURCES:\n"
+              << "  User-supplied position source names, grouped by camera\n"
+              << "  (e.g. cam0_pos cam1_pos, or cam0_pos_0 cam0_pos_1 cam1_pos_0\n"
+              << "  cam1_pos_1 for two targets).\n\n"
+              << "SINK:\n"
+              << "  User-supplied position sink name (e.g. pos3d). If there is more\n"
+              << "  than one target, the position of target i is published to SINK_i.\n\n"
+              << options << "\n";
+}
+
+// Signal handler to ensure shared resources are cleaned on exit due to ctrl-c
+void sigHandler(int) {
+    quit = 1;
+}
+
+// Processing loop
+void run(const std::shared_ptr<oat::Triangulator>& triangulator) {
+
+    try {
+
+        triangulator->connectToNodes();
+
+        while (!quit && !source_eof) {
+            source_eof = triangulator->process();
+        }
+
+    } catch (const boost::interprocess::interprocess_exception &ex) {
+
+        // Error code 1 indicates a SIGNINT during a call to wait(), which
+        // is normal behavior
+        if (ex.get_error_code() != 1)
+            throw;
+    }
+}
+
+int main(int argc, char *argv[]) {
+
+    std::signal(SIGINT, sigHandler);
+
+    std::vector<std::string> sources;
+    std::string sink;
+    std::vector<std::string> config_fk;
+    po::options_description visible_options("OPTIONS");
+
+    try {
+
+        po::options_description options("INFO");
+        options.add_options()
+                ("help", "Produce help message.")
+                ("version,v", "Print version information.")
+                ;
+
+        po::options_description config("CONFIGURATION");
+        config.add_options()
+                ("config,c", po::value<std::vector<std::string> >()->multitoken(),
+                "Configuration file/key pair.")
+                ;
+        po::options_description hidden("HIDDEN OPTIONS");
+        hidden.add_options()
+                ("sources", po::value< std::vector<std::string> >(),
+                "The names the SOURCES supplying the Position2D objects to be triangulated.")
+                ("sink", po::value<std::string>(&sink),
+                "The name of the SINK to which Position3D objects will be published.")
+                ;
+
+        po::positional_options_description positional_options;
+        positional_options.add("sources", -1); // If not overridden by explicit --sink, last positional argument is sink.
+
+        po::options_description all_options("OPTIONS");
+        all_options.add(options).add(config).add(hidden);
+
+        visible_options.add(options).add(config);
+
+        po::variables_map variable_map;
+        po::store(po::command_line_parser(argc, argv)
+                .options(all_options)
+                .positional(positional_options)
+                .run(),
+                variable_map);
+        po::notify(variable_map);
+
+        // Use the parsed options
+        if (variable_map.count("help")) {
+            printUsage(visible_options);
+            return 0;
+        }
+
+        if (variable_map.count("version")) {
+            std::cout << "Oat Triangulator version "
+                      << Oat_VERSION_MAJOR
+                      << "."
+                      << Oat_VERSION_MINOR
+                      << "\n";
+            std::cout << "Written by Jonathan P. Newman in the MWL@MIT.\n";
+            std::cout << "Licensed under the GPL3.0.\n";
+            return 0;
+        }
+
+        if (!variable_map.count("sources")) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("At least two SOURCES and a SINK must be specified.\n");
+            return -1;
+        }
+
+        sources = variable_map["sources"].as< std::vector<std::string> >();
+        if (sources.size() < 3) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("At least two SOURCES and a SINK must be specified.\n");
+            return -1;
+        }
+
+        if (!variable_map.count("sink")) {
+
+            // If not overridden by explicit --sink, last positional argument is the sink.
+            sink = sources.back();
+            sources.pop_back();
+        }
+
+        if (variable_map["config"].empty()) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("A configuration file/key pair specifying "
+                                    "camera projection matrices must be supplied.\n");
+            return -1;
+        }
+
+        config_fk = variable_map["config"].as<std::vector<std::string> >();
+
+        if (config_fk.size() != 2) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("Configuration must be supplied as file key pair.\n");
+            return -1;
+        }
+
+    } catch (std::exception& e) {
+        std::cerr << oat::Error(e.what()) << "\n";
+        return -1;
+    } catch (...) {
+        std::cerr << oat::Error("Exception of unknown type.\n");
+        return -1;
+    }
+
+    // Create component
+    auto triangulator = std::make_shared<oat::Triangulator>(sources, sink);
+
+    // The business
+    try {
+
+        triangulator->configure(config_fk[0], config_fk[1]);
+
+        // Tell user
+        std::cout << oat::whoMessage(triangulator->name(), "Listening to sources ");
+        for (auto s : sources)
+            std::cout << oat::sourceText(s) << " ";
+        std::cout << ".\n"
+                << oat::whoMessage(triangulator->name(), "Steaming to sinks ");
+        for (auto s : triangulator->sink_addresses())
+            std::cout << oat::sinkText(s) << " ";
+        std::cout << ".\n"
+                << oat::whoMessage(triangulator->name(),
+                "Press CTRL+C to exit.\n");
+
+        // Infinite loop until ctrl-c or server end-of-stream signal
+        run(triangulator);
+
+        // Tell user
+        std::cout << oat::whoMessage(triangulator->name(), "Exiting.\n");
+
+        // Exit
+        return 0;
+
+    } catch (const cpptoml::parse_exception &ex) {
+        std::cerr << oat::whoError(triangulator->name(),
+                     "Failed to parse configuration file " + config_fk[0] + "\n")
+                  << oat::whoError(triangulator->name(), ex.what()) << "\n";
+    } catch (const std::runtime_error &ex) {
+        std::cerr << oat::whoError(triangulator->name(), ex.what()) << "\n";
+    } catch (const cv::Exception &ex) {
+        std::cerr << oat::whoError(triangulator->name(), ex.what()) << "\n";
+    } catch (const boost::interprocess::interprocess_exception &ex) {
+        std::cerr << oat::whoError(triangulator->name(), ex.what()) << "\n";
+    } catch (...) {
+        std::cerr << oat::whoError(triangulator->name(), "Unknown exception.\n");
+    }
+
+    // Exit failure
+    return -1;
+}
@@ -0,0 +1,103 @@
+//******************************************************************************
+//* File:   assignment-bench.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+// Microbenchmark of the data association step of the oat-posifilt
+// multi-target tracker. Each iteration solves an N x N assignment between
+// tracks and jittered detections of those tracks, presented in random order,
+// using both the gated nearest neighbor and Hungarian methods.
+//
+// Usage: assignment-bench [NUM_TARGETS] [NUM_STEPS]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "../../src/positionfilter/Assignment.h"
+
+int main(int argc, char *argv[]) {
+
+    const int n = argc > 1 ? std::atoi(argv[1]) : 16;
+    const int num_steps = argc > 2 ? std::atoi(argv[2]) : 100000;
+    const double gate = 9.21;
+
+    // Generate cost matrices. Detection j is a noisy measurement of track
+    // perm[j], and tracks are spread out relative to the noise.
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> place(0.0, 100.0);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::vector<std::vector<double>> costs(64);
+    std::vector<std::vector<int>> truth(costs.size());
+
+    for (size_t k = 0; k < costs.size(); k++) {
+
+        std::vector<double> tx(n), ty(n);
+        for (int i = 0; i < n; i++) {
+            tx[i] = place(gen);
+            ty[i] = place(gen);
+        }
+
+        std::vector<int> perm(n);
+        std::iota(perm.begin(), perm.end(), 0);
+        std::shuffle(perm.begin(), perm.end(), gen);
+
+        costs[k].resize(n * n);
+        truth[k].resize(n);
+        for (int j = 0; j < n; j++) {
+            const double zx = tx[perm[j]] + noise(gen);
+            const double zy = ty[perm[j]] + noise(gen);
+            truth[k][perm[j]] = j;
+            for (int i = 0; i < n; i++) {
+                const double dx = zx - tx[i], dy = zy - ty[i];
+                costs[k][i * n + j] = dx * dx + dy * dy;
+            }
+        }
+    }
+
+    oat::Assignment assignment;
+    std::vector<int> row_to_col;
+    using ns = std::chrono::duration<double, std::nano>;
+
+    for (auto method : {oat::Assignment::Method::GREEDY,
+                        oat::Assignment::Method::HUNGARIAN}) {
+
+        int correct = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int s = 0; s < num_steps; s++) {
+            const size_t k = s % costs.size();
+            assignment.solve(costs[k], n, n, gate, method, row_to_col);
+            correct += std::equal(row_to_col.begin(), row_to_col.end(),
+                                  truth[k].begin());
+        }
+        auto time = std::chrono::steady_clock::now() - start;
+
+        std::cout << (method == oat::Assignment::Method::GREEDY ?
+                      "Nearest:   " : "Hungarian: ")
+                  << ns(time).count() / num_steps << " ns/step, "
+                  << 100.0 * correct / num_steps << "% fully matched\n";
+    }
+
+    std::cout << "Targets:   " << n << "\n"
+              << "Steps:     " << num_steps << "\n";
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+//******************************************************************************
+//* File:   kalman-bench.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+// Microbenchmark comparing the fixed-size KalmanEngine used by oat-posifilt
+// to the cv::KalmanFilter based implementation it replaced. Both filters are
+// fed the same noisy, randomly accelerating trajectory with a constant time
+// step so that their estimates can also be compared.
+//
+// Usage: kalman-bench [NUM_STEPS]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <opencv2/video/tracking.hpp>
+
+#include "../../src/positionfilter/KalmanEngine.h"
+
+using Engine = oat::KalmanEngine<4, 2>;
+
+static constexpr double DT {0.02};
+static constexpr double SIG_ACCEL {200.0};
+static constexpr double SIG_NOISE {10.0};
+
+void setModel(Engine::StateCov &F, Engine::StateCov &Q,
+              Engine::Observation &H, Engine::MeasurementCov &R) {
+
+    const double var = SIG_ACCEL * SIG_ACCEL;
+    const double dt2 = DT * DT;
+
+    F = Engine::StateCov::eye();
+    F(0, 1) = DT;
+    F(2, 3) = DT;
+
+    Q = Engine::StateCov::zeros();
+    Q(0, 0) = Q(2, 2) = var * dt2 * dt2 / 4.0;
+    Q(0, 1) = Q(1, 0) = Q(2, 3) = Q(3, 2) = var * dt2 * DT / 2.0;
+    Q(1, 1) = Q(3, 3) = var * dt2;
+
+    H = Engine::Observation::zeros();
+    H(0, 0) = 1.0;
+    H(1, 2) = 1.0;
+
+    R = Engine::MeasurementCov::eye() * (SIG_NOISE * SIG_NOISE);
+}
+
+int main(int argc, char *argv[]) {
+
+    const int num_steps = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+    // Generate measurements
+    std::mt19937 gen(1);
+    std::normal_distribution<double> accel(0.0, SIG_ACCEL);
+    std::normal_distribution<double> noise(0.0, SIG_NOISE);
+    std::vector<cv::Point2d> meas(num_steps);
+    cv::Point2d pos(0, 0), vel(0, 0);
+    for (auto &m : meas) {
+        cv::Point2d a(accel(gen), accel(gen));
+        pos += vel * DT + a * (0.5 * DT * DT);
+        vel += a * DT;
+        m = pos + cv::Point2d(noise(gen), noise(gen));
+    }
+
+    Engine::StateCov F, Q;
+    Engine::Observation H;
+    Engine::MeasurementCov R;
+    setModel(F, Q, H, R);
+
+    // cv::KalmanFilter
+    cv::KalmanFilter cv_kf(4, 2, 0, CV_64F);
+    cv::Mat(F).copyTo(cv_kf.transitionMatrix);
+    cv::Mat(Q).copyTo(cv_kf.processNoiseCov);
+    cv::Mat(H).copyTo(cv_kf.measurementMatrix);
+    cv::Mat(R).copyTo(cv_kf.measurementNoiseCov);
+    cv::setIdentity(cv_kf.errorCovPost, 1000.0);
+    cv_kf.statePost = cv::Mat(Engine::State(meas[0].x, 0, meas[0].y, 0)).clone();
+
+    cv::Mat_<double> cv_meas(2, 1);
+    std::vector<cv::Point2d> cv_out(num_steps);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_steps; i++) {
+
+        // Model matrices are static, as they were in the old posifilt
+        cv_meas(0) = meas[i].x;
+        cv_meas(1) = meas[i].y;
+        cv_kf.predict();
+        const cv::Mat &s = cv_kf.correct(cv_meas);
+        cv_out[i] = cv::Point2d(s.at<double>(0), s.at<double>(2));
+    }
+    auto cv_time = std::chrono::steady_clock::now() - start;
+
+    // KalmanEngine
+    Engine kf;
+    kf.initialize(Engine::State(meas[0].x, 0, meas[0].y, 0),
+                  Engine::StateCov::eye() * 1000.0);
+    std::vector<cv::Point2d> engine_out(num_steps);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_steps; i++) {
+
+        // Model matrices are rebuilt on each step, as they are in posifilt
+        setModel(F, Q, H, R);
+
+        kf.predict(F, Q);
+        const Engine::State &s
+            = kf.correct(Engine::Measurement(meas[i].x, meas[i].y), H, R);
+        engine_out[i] = cv::Point2d(s(0), s(2));
+    }
+    auto engine_time = std::chrono::steady_clock::now() - start;
+
+    double max_diff = 0.0;
+    for (int i = 0; i < num_steps; i++)
+        max_diff = std::max(max_diff, cv::norm(cv_out[i] - engine_out[i]));
+
+    using ns = std::chrono::duration<double, std::nano>;
+    const double cv_ns = ns(cv_time).count() / num_steps;
+    const double engine_ns = ns(engine_time).count() / num_steps;
+
+    std::cout << "Steps:             " << num_steps << "\n"
+              << "cv::KalmanFilter:  " << cv_ns << " ns/step\n"
+              << "oat::KalmanEngine: " << engine_ns << " ns/step\n"
+              << "Speedup:           " << cv_ns / engine_ns << "x\n"
+              << "Max estimate diff: " << max_diff << "\n";
+
+    return 0;
+}
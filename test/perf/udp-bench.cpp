@@ -0,0 +1,293 @@
+//******************************************************************************
+//* File:   udp-bench.cpp   
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+// Loopback benchmark comparing the JSON and binary UDP position protocols of
+// oat-posisock. A sender thread serializes positions the same way
+// UDPPositionClient does and a receiver thread decodes them, as a stimulus
+// controller would, and reads a few fields of each. Two runs are made per
+// protocol:
+//
+//  1. Throughput: positions are sent as fast as possible. Reports decoded
+//     positions per second and the fraction lost.
+//  2. Latency: positions are sent at a fixed rate. Reports the time from
+//     handing a position to the sender to having decoded it, which includes
+//     serialization, the loopback socket, parsing, and, for batched binary
+//     datagrams, the wait for the batch to fill.
+//
+// Usage: udp-bench [NUM_POSITIONS] [BATCH]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+#include <rapidjson/document.h>
+#include <rapidjson/writer.h>
+
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionPacket.h"
+#include "../../src/positionsocket/PacketRecord.h"
+#include "../../src/positionsocket/SocketWriteStream.h"
+
+using UDP = boost::asio::ip::udp;
+using Clock = std::chrono::steady_clock;
+using SocketWriter = rapidjson::SocketWriteStream<UDP::socket, UDP::endpoint>;
+
+static constexpr size_t MAX_LENGTH {65507};
+static constexpr double LATENCY_RATE_HZ {5000.0};
+
+struct Result {
+    size_t received {0};
+    double seconds {0.0};
+    std::vector<double> latency_usec;
+};
+
+int64_t nowNsec() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Send positions to the receiver, using JSON if batch is 0 and the binary
+ * protocol otherwise. If rate_hz is 0, send as fast as possible.
+ */
+void send(std::vector<oat::Position2D> &positions,
+          std::vector<std::atomic<int64_t>> &handoff_nsec,
+          const UDP::endpoint &to, const size_t batch, const double rate_hz) {
+
+    boost::asio::io_service io_service;
+    UDP::socket socket(io_service, UDP::endpoint(UDP::v4(), 0));
+
+    std::vector<char> buffer(MAX_LENGTH);
+    SocketWriter stream(&socket, to, buffer.data(), buffer.size());
+
+    size_t pending = 0;
+    uint32_t sequence = 0;
+    auto next = Clock::now();
+
+    for (size_t i = 0; i < positions.size(); i++) {
+
+        if (rate_hz > 0) {
+            next += std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(1.0 / rate_hz));
+            while (Clock::now() < next) { }
+        }
+
+        auto &p = positions[i];
+        handoff_nsec[i].store(nowNsec(), std::memory_order_relaxed);
+        p.sample().stampMonotonic();
+
+        if (batch == 0) {
+
+            rapidjson::Writer<SocketWriter> writer {stream};
+            p.Serialize(writer);
+            stream.Flush();
+
+        } else {
+
+            oat_packet_record r;
+            oat::toPacketRecord(p, r);
+            oat_packet_encode_record(buffer.data(), pending++, &r);
+
+            if (pending == batch || i == positions.size() - 1) {
+                oat_packet_header h;
+                h.type = OAT_PACKET_POSITIONS;
+                h.count = static_cast<uint8_t>(pending);
+                h.sequence = sequence++;
+                h.send_usec = oat::Sample::monotonicNow().count();
+                oat_packet_encode_header(buffer.data(), &h);
+                socket.send_to(boost::asio::buffer(buffer.data(),
+                                                   oat_packet_size(pending)),
+                               to);
+                pending = 0;
+            }
+        }
+    }
+
+    // Let the receiver drain its socket, then tell it to stop. A single
+    // byte is neither valid JSON nor a binary datagram.
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    const char end = 0;
+    for (int i = 0; i < 3; i++)
+        socket.send_to(boost::asio::buffer(&end, 1), to);
+}
+
+/**
+ * Decode positions until the sender's end marker arrives.
+ */
+void receive(UDP::socket &socket, const size_t batch,
+             const std::vector<std::atomic<int64_t>> &handoff_nsec,
+             const bool measure_latency, Result &result) {
+
+    std::vector<char> buffer(MAX_LENGTH + 1);
+    double checksum = 0.0;
+    Clock::time_point first, last;
+
+    auto note = [&](const uint64_t tick) {
+        const auto t = Clock::now();
+        if (result.received++ == 0)
+            first = t;
+        last = t;
+        if (measure_latency && tick >= 1 && tick <= handoff_nsec.size()) {
+            const int64_t sent = handoff_nsec[tick - 1].load(std::memory_order_relaxed);
+            result.latency_usec.push_back((nowNsec() - sent) / 1000.0);
+        }
+    };
+
+    for (;;) {
+
+        const size_t len = socket.receive(boost::asio::buffer(buffer.data(),
+                                                              MAX_LENGTH));
+        if (len == 1)
+            break;
+
+        if (batch == 0) {
+
+            buffer[len] = '\0';
+            rapidjson::Document d;
+            d.Parse(buffer.data());
+            if (d.HasParseError() || !d.IsObject())
+                continue;
+
+            if (d["pos_ok"].GetBool())
+                checksum += d["pos_xy"][0u].GetDouble() + d["pos_xy"][1u].GetDouble();
+            note(d["tick"].GetUint64());
+
+        } else {
+
+            oat_packet_header h;
+            if (oat_packet_decode_header(buffer.data(), len, &h) != 0)
+                continue;
+
+            for (size_t i = 0; i < h.count; i++) {
+                oat_packet_record r;
+                oat_packet_decode_record(buffer.data(), i, &r);
+                if (r.flags & OAT_PACKET_POSITION_VALID)
+                    checksum += r.position[0] + r.position[1];
+                note(r.tick);
+            }
+        }
+    }
+
+    result.seconds = std::chrono::duration<double>(last - first).count();
+
+    // Keep the decoded fields from being optimized away
+    if (checksum == 0.123456789)
+        std::cerr << "";
+}
+
+Result run(std::vector<oat::Position2D> &positions, const size_t batch,
+           const double rate_hz) {
+
+    boost::asio::io_service io_service;
+    UDP::socket socket(io_service, UDP::endpoint(
+        boost::asio::ip::address_v4::loopback(), 0));
+    socket.set_option(boost::asio::socket_base::receive_buffer_size(8 << 20));
+
+    std::vector<std::atomic<int64_t>> handoff_nsec(positions.size());
+
+    Result result;
+    std::thread receiver([&] {
+        receive(socket, batch, handoff_nsec, rate_hz > 0, result);
+    });
+
+    send(positions, handoff_nsec, socket.local_endpoint(), batch, rate_hz);
+    receiver.join();
+
+    return result;
+}
+
+double percentile(std::vector<double> v, const double p) {
+    if (v.empty())
+        return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[static_cast<size_t>(p * (v.size() - 1))];
+}
+
+int main(int argc, char *argv[]) {
+
+    const size_t num_positions = argc > 1 ? std::atoi(argv[1]) : 200000;
+    const size_t batch = argc > 2 ? std::atoi(argv[2]) : 16;
+
+    if (batch < 1 || batch > OAT_PACKET_MAX_RECORDS) {
+        std::cerr << "BATCH must be between 1 and " << OAT_PACKET_MAX_RECORDS << "\n";
+        return -1;
+    }
+
+    // Random walk with valid position, velocity and heading
+    std::mt19937 gen(1);
+    std::normal_distribution<double> step(0.0, 2.0);
+    std::vector<oat::Position2D> positions(num_positions);
+    oat::Sample sample(1.0 / LATENCY_RATE_HZ);
+    double x = 320, y = 240;
+    for (auto &p : positions) {
+        const double dx = step(gen), dy = step(gen);
+        x += dx;
+        y += dy;
+        sample.incrementCount();
+        p.sample() = sample;
+        p.position = oat::Point2D(x, y);
+        p.velocity = oat::Velocity2D(dx * 30, dy * 30);
+        p.heading = oat::UnitVector2D(1, 0);
+        p.position_valid = p.velocity_valid = p.heading_valid = true;
+    }
+
+    // Latency runs are paced, so use fewer positions
+    std::vector<oat::Position2D> paced(
+        positions.begin(),
+        positions.begin() + std::min(num_positions, static_cast<size_t>(20000)));
+
+    struct Mode { std::string name; size_t batch; };
+    std::vector<Mode> modes {{"json", 0},
+                             {"binary", 1},
+                             {"binary x" + std::to_string(batch), batch}};
+
+    std::cout << "Positions:  " << num_positions << " (throughput), "
+              << paced.size() << " at " << LATENCY_RATE_HZ << " Hz (latency)\n\n"
+              << std::left << std::setw(14) << "Protocol"
+              << std::right << std::setw(14) << "positions/s"
+              << std::setw(10) << "lost %"
+              << std::setw(14) << "median usec"
+              << std::setw(12) << "p99 usec" << "\n";
+
+    for (auto &m : modes) {
+
+        auto t = run(positions, m.batch, 0.0);
+        auto l = run(paced, m.batch, LATENCY_RATE_HZ);
+
+        const double rate = t.seconds > 0 ? t.received / t.seconds : 0.0;
+        const double lost = 100.0 * (1.0 - static_cast<double>(t.received)
+                                           / num_positions);
+
+        std::cout << std::left << std::setw(14) << m.name << std::right
+                  << std::fixed << std::setprecision(0) << std::setw(14) << rate
+                  << std::setprecision(2) << std::setw(10) << lost
+                  << std::setprecision(1)
+                  << std::setw(14) << percentile(l.latency_usec, 0.5)
+                  << std::setw(12) << percentile(l.latency_usec, 0.99) << "\n";
+    }
+
+    return 0;
+}
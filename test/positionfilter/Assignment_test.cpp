@@ -0,0 +1,234 @@
+//******************************************************************************
+//* File:   Assignment_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <random>
+#include <vector>
+
+#include "../../src/positionfilter/Assignment.h"
+
+namespace {
+
+using Method = oat::Assignment::Method;
+
+/**
+ * Exhaustively find the best assignment: the largest number of pairs within
+ * the gate and, among those, the smallest total cost.
+ */
+void bruteForce(const std::vector<double> &cost, const int rows,
+                const int cols, const double gate, const int r,
+                std::vector<bool> &col_used, const int num, const double total,
+                int &best_num, double &best_total) {
+
+    if (r == rows) {
+        if (num > best_num || (num == best_num && total < best_total)) {
+            best_num = num;
+            best_total = total;
+        }
+        return;
+    }
+
+    // Row r unassigned
+    bruteForce(cost, rows, cols, gate, r + 1, col_used, num, total,
+               best_num, best_total);
+
+    for (int c = 0; c < cols; c++) {
+        if (col_used[c] || cost[r * cols + c] > gate)
+            continue;
+        col_used[c] = true;
+        bruteForce(cost, rows, cols, gate, r + 1, col_used, num + 1,
+                   total + cost[r * cols + c], best_num, best_total);
+        col_used[c] = false;
+    }
+}
+
+/**
+ * Check that an assignment is one-to-one and respects the gate, and return
+ * the number of assigned pairs and their total cost.
+ */
+void score(const std::vector<double> &cost, const int rows, const int cols,
+           const double gate, const std::vector<int> &row_to_col,
+           int &num, double &total) {
+
+    REQUIRE (row_to_col.size() == static_cast<size_t>(rows));
+
+    std::vector<bool> col_used(cols, false);
+    num = 0;
+    total = 0.0;
+    for (int r = 0; r < rows; r++) {
+        const int c = row_to_col[r];
+        if (c < 0)
+            continue;
+        REQUIRE (c < cols);
+        REQUIRE (!col_used[c]);
+        REQUIRE (cost[r * cols + c] <= gate);
+        col_used[c] = true;
+        num++;
+        total += cost[r * cols + c];
+    }
+}
+
+} // namespace
+
+SCENARIO ("The Hungarian method finds the minimum cost assignment.", "[Assignment]") {
+
+    GIVEN ("An assignment solver.") {
+
+        oat::Assignment assignment;
+        std::vector<int> row_to_col;
+
+        WHEN ("A square cost matrix for which greedy assignment is not optimal is solved.") {
+
+            const std::vector<double> cost {4, 1, 3,
+                                            2, 0, 5,
+                                            3, 2, 2};
+
+            THEN ("The Hungarian method finds the optimum.") {
+
+                assignment.solve(cost, 3, 3, 100, Method::HUNGARIAN, row_to_col);
+                REQUIRE (row_to_col == std::vector<int>({1, 0, 2}));
+            }
+
+            THEN ("The greedy method takes the cheapest pair first.") {
+
+                assignment.solve(cost, 3, 3, 100, Method::GREEDY, row_to_col);
+                REQUIRE (row_to_col == std::vector<int>({0, 1, 2}));
+            }
+        }
+
+        WHEN ("A cost matrix with more columns than rows is solved.") {
+
+            const std::vector<double> cost {10, 1, 5,
+                                             2, 8, 1};
+
+            assignment.solve(cost, 2, 3, 100, Method::HUNGARIAN, row_to_col);
+
+            THEN ("Every row is assigned to its optimal column.") {
+                REQUIRE (row_to_col == std::vector<int>({1, 2}));
+            }
+        }
+
+        WHEN ("A cost matrix with more rows than columns is solved.") {
+
+            const std::vector<double> cost {5, 1,
+                                            1, 5,
+                                            0, 3};
+
+            assignment.solve(cost, 3, 2, 100, Method::HUNGARIAN, row_to_col);
+
+            THEN ("The optimal rows are assigned and the rest are not.") {
+                REQUIRE (row_to_col == std::vector<int>({1, -1, 0}));
+            }
+        }
+
+        WHEN ("The optimum uses a pair that greedy assignment would gate out.") {
+
+            const std::vector<double> cost {1.0, 2.0,
+                                            1.5, 100};
+
+            THEN ("The Hungarian method assigns both rows.") {
+
+                assignment.solve(cost, 2, 2, 10, Method::HUNGARIAN, row_to_col);
+                REQUIRE (row_to_col == std::vector<int>({1, 0}));
+            }
+
+            THEN ("The greedy method leaves a row unassigned.") {
+
+                assignment.solve(cost, 2, 2, 10, Method::GREEDY, row_to_col);
+                REQUIRE (row_to_col == std::vector<int>({0, -1}));
+            }
+        }
+
+        WHEN ("Only one column is within the gate.") {
+
+            const std::vector<double> cost {1, 100,
+                                            2, 100};
+
+            assignment.solve(cost, 2, 2, 10, Method::HUNGARIAN, row_to_col);
+
+            THEN ("Only the cheapest row is assigned.") {
+                REQUIRE (row_to_col == std::vector<int>({0, -1}));
+            }
+        }
+
+        WHEN ("Every pair is outside the gate.") {
+
+            const std::vector<double> cost {20, 30, 40,
+                                            50, 60, 70};
+
+            THEN ("No row is assigned by either method.") {
+
+                assignment.solve(cost, 2, 3, 10, Method::HUNGARIAN, row_to_col);
+                REQUIRE (row_to_col == std::vector<int>({-1, -1}));
+
+                assignment.solve(cost, 2, 3, 10, Method::GREEDY, row_to_col);
+                REQUIRE (row_to_col == std::vector<int>({-1, -1}));
+            }
+        }
+
+        WHEN ("There are no columns.") {
+
+            const std::vector<double> cost;
+            assignment.solve(cost, 3, 0, 10, Method::HUNGARIAN, row_to_col);
+
+            THEN ("No row is assigned.") {
+                REQUIRE (row_to_col == std::vector<int>({-1, -1, -1}));
+            }
+        }
+    }
+}
+
+SCENARIO ("The Hungarian method matches exhaustive search.", "[Assignment]") {
+
+    GIVEN ("Random, partially gated cost matrices of up to 6 x 6.") {
+
+        oat::Assignment assignment;
+        std::vector<int> row_to_col;
+        std::mt19937 gen(1);
+        std::uniform_int_distribution<int> size(1, 6);
+        std::uniform_real_distribution<double> value(0.0, 20.0);
+        const double gate = 12.0;
+
+        for (int trial = 0; trial < 500; trial++) {
+
+            const int rows = size(gen);
+            const int cols = size(gen);
+            std::vector<double> cost(rows * cols);
+            for (auto &c : cost)
+                c = value(gen);
+
+            assignment.solve(cost, rows, cols, gate, Method::HUNGARIAN, row_to_col);
+
+            int num;
+            double total;
+            score(cost, rows, cols, gate, row_to_col, num, total);
+
+            int best_num = -1;
+            double best_total = 0.0;
+            std::vector<bool> col_used(cols, false);
+            bruteForce(cost, rows, cols, gate, 0, col_used, 0, 0.0,
+                       best_num, best_total);
+
+            REQUIRE (num == best_num);
+            REQUIRE (total == Approx(best_total));
+        }
+    }
+}
@@ -0,0 +1,160 @@
+//******************************************************************************
+//* File:   Homography2D_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include "../../lib/datatypes/Homography2D.h"
+
+namespace {
+
+const double H[9] {2.0, 0.1, 5.0,
+                   -0.2, 1.5, -3.0,
+                   0.001, 0.002, 1.0};
+
+oat::Position2D makePosition(const double x, const double y) {
+
+    oat::Position2D p;
+    p.position = cv::Point2d(x, y);
+    p.position_valid = true;
+    p.velocity = cv::Point2d(y, -x);
+    p.velocity_valid = true;
+    p.heading = cv::Point2d(0.6, 0.8);
+    p.heading_valid = true;
+    return p;
+}
+
+} // namespace
+
+SCENARIO ("Homographies can be applied without a position registry.", "[Homography2D]") {
+
+    GIVEN ("An unregistered homography") {
+
+        oat::Homography2D h {cv::Matx33d(H)};
+
+        THEN ("Transformed positions are in world units and refer to ID 0") {
+
+            oat::Position2D p = makePosition(10, 20);
+            h.apply(p);
+            REQUIRE(p.unit_of_length() == oat::DistanceUnit::WORLD);
+            REQUIRE(p.homography_id() == 0);
+        }
+    }
+
+    GIVEN ("A homography with a registered ID") {
+
+        oat::Homography2D h(cv::Matx33d(H), 7);
+
+        THEN ("Transformed positions refer to that ID") {
+
+            oat::Position2D p = makePosition(10, 20);
+            h.apply(p);
+            REQUIRE(p.homography_id() == 7);
+        }
+    }
+}
+
+SCENARIO ("Batch transforms match single transforms.", "[Homography2D]") {
+
+    GIVEN ("A homography and a batch of positions") {
+
+        oat::Homography2D h(cv::Matx33d(H), 3);
+
+        std::vector<oat::Position2D> batch;
+        for (int i = 0; i < 50; i++)
+            batch.push_back(makePosition(i * 7.0, 100.0 - i * 3.0));
+
+        // Invalid fields are left untouched
+        batch[5].position_valid = false;
+        batch[6].velocity_valid = false;
+        batch[7].heading_valid = false;
+
+        std::vector<oat::Position2D> single = batch;
+        for (auto &p : single)
+            h.apply(p);
+
+        WHEN ("the batch is transformed") {
+
+            h.apply(batch);
+
+            THEN ("Each position equals its single transform") {
+
+                for (size_t i = 0; i < batch.size(); i++) {
+                    REQUIRE(batch[i].position.x == single[i].position.x);
+                    REQUIRE(batch[i].position.y == single[i].position.y);
+                    REQUIRE(batch[i].velocity.x == single[i].velocity.x);
+                    REQUIRE(batch[i].velocity.y == single[i].velocity.y);
+                    REQUIRE(batch[i].heading.x == single[i].heading.x);
+                    REQUIRE(batch[i].heading.y == single[i].heading.y);
+                    REQUIRE(batch[i].homography_id() == 3);
+                }
+
+                REQUIRE(batch[5].position.x == 35.0);
+                REQUIRE(batch[5].position.y == 85.0);
+            }
+
+            THEN ("Headings remain unit vectors") {
+
+                for (const auto &p : batch) {
+                    if (p.heading_valid) {
+                        const double n = std::sqrt(p.heading.x * p.heading.x
+                                                   + p.heading.y * p.heading.y);
+                        REQUIRE(n == Approx(1.0));
+                    }
+                }
+            }
+        }
+
+        WHEN ("the batch's points are transformed in place") {
+
+            std::vector<oat::Point2D> points;
+            for (const auto &p : batch)
+                points.push_back(p.position);
+
+            h.applyPoints(points.data(), points.data(), points.size());
+
+            THEN ("Each point equals the corresponding position transform") {
+
+                for (size_t i = 0; i < points.size(); i++) {
+                    if (i == 5)
+                        continue;
+                    REQUIRE(points[i].x == single[i].position.x);
+                    REQUIRE(points[i].y == single[i].position.y);
+                }
+            }
+        }
+    }
+
+    GIVEN ("The identity homography") {
+
+        oat::Homography2D h;
+        std::vector<oat::Position2D> batch {makePosition(1, 2), makePosition(-3, 4)};
+        h.apply(batch.data(), batch.size());
+
+        THEN ("Positions are unchanged") {
+            REQUIRE(batch[0].position.x == 1.0);
+            REQUIRE(batch[0].position.y == 2.0);
+            REQUIRE(batch[1].velocity.x == 4.0);
+            REQUIRE(batch[1].velocity.y == 3.0);
+        }
+    }
+}
@@ -211,5 +211,37 @@ SCENARIO ("Connected sources can retrieve shared objects to mutate them.", "[Sou
     }
 }
 
+SCENARIO ("A timed tryWait() returns when the sink posts or the timeout expires.", "[Source]") {
+
+    GIVEN ("A bound Sink<int> and a connected Source<int> with common node address") {
+
+        oat::Sink<int> sink;
+        oat::Source<int> source;
+        oat::NodeState state;
+
+        sink.bind(node_addr);
+        source.touch(node_addr);
+        source.connect();
+
+        WHEN ("The sink has not posted a sample") {
+
+            THEN ("tryWait() times out") {
+                REQUIRE_FALSE( source.tryWait(state, oat::msec_t(10)) );
+            }
+        }
+
+        WHEN ("The sink posts a sample") {
+
+            sink.wait();
+            sink.post();
+
+            THEN ("tryWait() succeeds and the source must post()") {
+                REQUIRE( source.tryWait(state, oat::msec_t(10)) );
+                REQUIRE( state == oat::NodeState::SINK_BOUND );
+                source.post();
+            }
+        }
+    }
+}
 
 // TODO: specialization tests
@@ -522,3 +522,42 @@ SCENARIO ("Sources attaching or detaching during source or sink wait() periods "
         }
     }
 }
+
+SCENARIO ("A Source's tryWait() must respect the Sink's lock without "
+          "blocking.", "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A bound sink and a connected source") {
+
+        oat::Sink<int> sink;
+        oat::Source<int> source;
+        oat::NodeState state;
+
+        sink.bind(node_addr);
+        source.touch(node_addr);
+        source.connect();
+
+        WHEN ("The sink has entered but not exited the critical section") {
+
+            sink.wait();
+
+            THEN ("The source's tryWait() shall return false") {
+                REQUIRE_FALSE(source.tryWait(state));
+                REQUIRE_THROWS(source.post());
+            }
+        }
+
+        WHEN ("The sink has entered and exited the critical section") {
+
+            sink.wait();
+            /* Critical */
+            sink.post();
+
+            THEN ("The source's tryWait() shall return true and require a post()") {
+                REQUIRE(source.tryWait(state));
+                REQUIRE(state == oat::NodeState::SINK_BOUND);
+                REQUIRE_THROWS(source.tryWait(state));
+                REQUIRE_NOTHROW(source.post());
+            }
+        }
+    }
+}